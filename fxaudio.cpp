@@ -0,0 +1,312 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Audio analysis (see fxaudio.h)
+*/
+
+#include "fxaudio.h"
+#include "fxresources.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FXAUDIO_X86
+#include <immintrin.h>
+#endif
+
+#define ONSET_SENSITIVITY 1.5f      // deviations over the mean
+#define ONSET_MINFLUX 0.05f         // ignore onsets in near silence
+#define ONSET_GAP 3                 // updates between onsets (~70ms)
+#define BAND_LOWEST 40.0f
+
+FXAudioAnalyser* FXAudioAnalyser::Acquire() {
+    return FXResourceRegistry::Acquire<FXAudioAnalyser>("FXAudioAnalyser", []{ return new FXAudioAnalyser(); }, [](FXAudioAnalyser* a){ delete a; });
+}
+
+void FXAudioAnalyser::Release(FXAudioAnalyser* analyser) {
+    FXResourceRegistry::Release(analyser);
+}
+
+FXAudioAnalyser::FXAudioAnalyser() {
+    memset(&result, 0, sizeof(result));
+    result.lastUpdateTime = -1;
+    cached = false;
+    memset(previous, 0, sizeof(previous));
+    fluxCount = 0;
+    sinceOnset = ONSET_GAP;
+
+    for (int i = 0; i < FXAUDIO_FFTSIZE; i++) window[i] = 0.5f - 0.5f * cos(2.0 * M_PI * i / (FXAUDIO_FFTSIZE - 1));
+    for (int i = 0; i < FXAUDIO_BINS; i++) {
+        cosTable[i] = cos(2.0 * M_PI * i / FXAUDIO_FFTSIZE);
+        sinTable[i] = -sin(2.0 * M_PI * i / FXAUDIO_FFTSIZE);
+    }
+    int bits = 0;
+    while ((1 << bits) < FXAUDIO_FFTSIZE) bits++;
+    for (int i = 0; i < FXAUDIO_FFTSIZE; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        bitReverse[i] = (uint16_t)r;
+    }
+
+    SetPath(FXAUDIO_AUTO);
+    SetSampleRate(44100);
+}
+
+FXAudioAnalyser::~FXAudioAnalyser() {
+}
+
+void FXAudioAnalyser::SetSampleRate(float hz) {
+    sampleRate = hz;
+    // log spaced from BAND_LOWEST to nyquist, at least one bin each
+    float nyquist = hz * 0.5f;
+    bandStart[0] = 1;
+    for (int b = 1; b <= FXAUDIO_BANDS; b++) {
+        float f = BAND_LOWEST * pow(nyquist / BAND_LOWEST, (float)b / FXAUDIO_BANDS);
+        int bin = (int)(f * FXAUDIO_FFTSIZE / hz + 0.5f);
+        if (bin <= bandStart[b - 1]) bin = bandStart[b - 1] + 1;
+        if (bin > FXAUDIO_BINS) bin = FXAUDIO_BINS;
+        bandStart[b] = bin;
+    }
+    bandStart[FXAUDIO_BANDS] = FXAUDIO_BINS;
+    cached = false;
+}
+
+void FXAudioAnalyser::SetPath(FXAUDIOPATH p) {
+    FXAUDIOPATH best = FXAUDIO_SCALAR;
+#ifdef FXAUDIO_X86
+#ifdef __SSE2__
+    best = FXAUDIO_SSE2;
+#endif
+    if (__builtin_cpu_supports("avx2")) best = FXAUDIO_AVX2;
+#endif
+    path = (p == FXAUDIO_AUTO || p > best) ? best : p;
+    cached = false;
+}
+
+const char* FXAudioAnalyser::PathName(FXAUDIOPATH p) {
+    switch (p) {
+        case FXAUDIO_SCALAR: return "scalar";
+        case FXAUDIO_SSE2: return "sse2";
+        case FXAUDIO_AVX2: return "avx2";
+        default: return "auto";
+    }
+}
+
+//----------------------------------------------------------------------------
+
+static void ConvertScalar(const int16_t* in, int frames, const float* window, float* mono, float sumSq[3], float peak[3]) {
+    const float scale = 1.0f / 32768.0f;
+    for (int i = 0; i < frames; i++) {
+        float l = in[i * 2] * scale;
+        float r = in[i * 2 + 1] * scale;
+        float m = (l + r) * 0.5f;
+        sumSq[0] += l * l;
+        sumSq[1] += r * r;
+        sumSq[2] += m * m;
+        peak[0] = max(peak[0], fabsf(l));
+        peak[1] = max(peak[1], fabsf(r));
+        peak[2] = max(peak[2], fabsf(m));
+        mono[i] = m * window[i];
+    }
+}
+
+#if defined(FXAUDIO_X86) && defined(__SSE2__)
+static float HorizontalSum(__m128 v) {
+    __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+static float HorizontalMax(__m128 v) {
+    __m128 s = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+// 4 stereo frames per step, left is the low half of each 32 bit lane
+static int ConvertSSE2(const int16_t* in, int frames, const float* window, float* mono, float sumSq[3], float peak[3]) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 sl = _mm_setzero_ps(), sr = _mm_setzero_ps(), sm = _mm_setzero_ps();
+    __m128 pl = _mm_setzero_ps(), pr = _mm_setzero_ps(), pm = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i * 2));
+        __m128 l = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)), scale);
+        __m128 r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(v, 16)), scale);
+        __m128 m = _mm_mul_ps(_mm_add_ps(l, r), half);
+        sl = _mm_add_ps(sl, _mm_mul_ps(l, l));
+        sr = _mm_add_ps(sr, _mm_mul_ps(r, r));
+        sm = _mm_add_ps(sm, _mm_mul_ps(m, m));
+        pl = _mm_max_ps(pl, _mm_andnot_ps(sign, l));
+        pr = _mm_max_ps(pr, _mm_andnot_ps(sign, r));
+        pm = _mm_max_ps(pm, _mm_andnot_ps(sign, m));
+        _mm_storeu_ps(mono + i, _mm_mul_ps(m, _mm_loadu_ps(window + i)));
+    }
+    sumSq[0] += HorizontalSum(sl);
+    sumSq[1] += HorizontalSum(sr);
+    sumSq[2] += HorizontalSum(sm);
+    peak[0] = max(peak[0], HorizontalMax(pl));
+    peak[1] = max(peak[1], HorizontalMax(pr));
+    peak[2] = max(peak[2], HorizontalMax(pm));
+    return i;
+}
+#endif
+
+#ifdef FXAUDIO_X86
+// 8 stereo frames per step, only called when the CPU has AVX2
+__attribute__((target("avx2")))
+static int ConvertAVX2(const int16_t* in, int frames, const float* window, float* mono, float sumSq[3], float peak[3]) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 sl = _mm256_setzero_ps(), sr = _mm256_setzero_ps(), sm = _mm256_setzero_ps();
+    __m256 pl = _mm256_setzero_ps(), pr = _mm256_setzero_ps(), pm = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i * 2));
+        __m256 l = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16)), scale);
+        __m256 r = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(v, 16)), scale);
+        __m256 m = _mm256_mul_ps(_mm256_add_ps(l, r), half);
+        sl = _mm256_add_ps(sl, _mm256_mul_ps(l, l));
+        sr = _mm256_add_ps(sr, _mm256_mul_ps(r, r));
+        sm = _mm256_add_ps(sm, _mm256_mul_ps(m, m));
+        pl = _mm256_max_ps(pl, _mm256_andnot_ps(sign, l));
+        pr = _mm256_max_ps(pr, _mm256_andnot_ps(sign, r));
+        pm = _mm256_max_ps(pm, _mm256_andnot_ps(sign, m));
+        _mm256_storeu_ps(mono + i, _mm256_mul_ps(m, _mm256_loadu_ps(window + i)));
+    }
+    float s[8], p[8];
+    __m256 acc[3] = {sl, sr, sm};
+    __m256 pk[3] = {pl, pr, pm};
+    for (int c = 0; c < 3; c++) {
+        _mm256_storeu_ps(s, acc[c]);
+        _mm256_storeu_ps(p, pk[c]);
+        for (int k = 0; k < 8; k++) {
+            sumSq[c] += s[k];
+            peak[c] = max(peak[c], p[k]);
+        }
+    }
+    return i;
+}
+#endif
+
+void FXAudioAnalyser::Convert(FXAUDIOPATH p, const int16_t* in, int frames, const float* window, float* mono, float sumSq[3], float peak[3]) {
+    for (int c = 0; c < 3; c++) sumSq[c] = peak[c] = 0;
+    int done = 0;
+#ifdef FXAUDIO_X86
+    if (p == FXAUDIO_AVX2) done = ConvertAVX2(in, frames, window, mono, sumSq, peak);
+#ifdef __SSE2__
+    else if (p == FXAUDIO_SSE2) done = ConvertSSE2(in, frames, window, mono, sumSq, peak);
+#endif
+#endif
+    // whatever is left over (or everything on the scalar path)
+    ConvertScalar(in + done * 2, frames - done, window + done, mono + done, sumSq, peak);
+}
+
+//----------------------------------------------------------------------------
+
+// radix 2 in place over re/im, tables from the constructor
+void FXAudioAnalyser::FFT() {
+    for (int i = 0; i < FXAUDIO_FFTSIZE; i++) {
+        int j = bitReverse[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int size = 2; size <= FXAUDIO_FFTSIZE; size <<= 1) {
+        int half = size >> 1;
+        int step = FXAUDIO_FFTSIZE / size;
+        for (int start = 0; start < FXAUDIO_FFTSIZE; start += size) {
+            float* ar = re + start;
+            float* ai = im + start;
+            float* br = ar + half;
+            float* bi = ai + half;
+            for (int k = 0; k < half; k++) {
+                float wr = cosTable[k * step];
+                float wi = sinTable[k * step];
+                float tr = br[k] * wr - bi[k] * wi;
+                float ti = br[k] * wi + bi[k] * wr;
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] += tr;
+                ai[k] += ti;
+            }
+        }
+    }
+}
+
+// flux against the mean + deviation of the last second of flux
+void FXAudioAnalyser::Onset() {
+    float mean = 0, var = 0;
+    int n = min(fluxCount, FXAUDIO_FLUXHISTORY);
+    for (int i = 0; i < n; i++) mean += fluxHistory[i];
+    if (n) mean /= n;
+    for (int i = 0; i < n; i++) var += (fluxHistory[i] - mean) * (fluxHistory[i] - mean);
+    if (n) var /= n;
+
+    result.fluxThreshold = max(mean + ONSET_SENSITIVITY * sqrtf(var), ONSET_MINFLUX);
+    result.onset = n >= 8 && sinceOnset >= ONSET_GAP && result.flux > result.fluxThreshold;
+    result.onsetStrength = result.onset ? result.flux / result.fluxThreshold : 0;
+    sinceOnset = result.onset ? 0 : sinceOnset + 1;
+
+    fluxHistory[fluxCount % FXAUDIO_FLUXHISTORY] = result.flux;
+    fluxCount++;
+}
+
+const FXAUDIOANALYSIS& FXAudioAnalyser::Analyse(const FXAUDIODETAILS& audio) {
+    if (cached && audio.lastUpdateTime == result.lastUpdateTime) return result;
+    cached = true;
+    result.lastUpdateTime = audio.lastUpdateTime;
+
+    int frames = min(audio.bytes / 4, FXAUDIO_FFTSIZE);
+    if (!audio.active || !audio.dataBuffer || frames <= 0) {
+        // silence, also lets the flux history settle
+        result.valid = false;
+        result.frames = 0;
+        memset(result.rms, 0, sizeof(result.rms));
+        memset(result.peak, 0, sizeof(result.peak));
+        memset(result.spectrum, 0, sizeof(result.spectrum));
+        memset(result.bandEnergy, 0, sizeof(result.bandEnergy));
+        memset(previous, 0, sizeof(previous));
+        result.flux = 0;
+        result.onset = false;
+        result.onsetStrength = 0;
+        return result;
+    }
+
+    // short buffers are zero padded, the window only covers a full buffer
+    float sumSq[3];
+    Convert(path, (const int16_t*)audio.dataBuffer, frames, window, re, sumSq, result.peak);
+    if (frames < FXAUDIO_FFTSIZE) memset(re + frames, 0, (FXAUDIO_FFTSIZE - frames) * sizeof(float));
+    memset(im, 0, sizeof(im));
+    for (int c = 0; c < 3; c++) result.rms[c] = sqrtf(sumSq[c] / frames);
+
+    FFT();
+
+    // window sum is N/2, so 4/N puts a full scale sine at ~1.0
+    const float norm = 4.0f / FXAUDIO_FFTSIZE;
+    float flux = 0;
+    for (int k = 0; k < FXAUDIO_BINS; k++) {
+        float m = sqrtf(re[k] * re[k] + im[k] * im[k]) * norm;
+        float d = m - previous[k];
+        flux += d > 0 ? d : 0;
+        previous[k] = m;
+        result.spectrum[k] = m;
+    }
+    for (int b = 0; b < FXAUDIO_BANDS; b++) {
+        float e = 0;
+        for (int k = bandStart[b]; k < bandStart[b + 1]; k++) e += result.spectrum[k] * result.spectrum[k];
+        result.bandEnergy[b] = e;
+    }
+
+    result.valid = true;
+    result.frames = frames;
+    result.flux = flux;
+    result.updates++;
+    Onset();
+    return result;
+}
@@ -0,0 +1,98 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Audio analysis
+
+    Turns the host's FXAUDIODETAILS buffer (interleaved int16 L/R, up to 1024 frames) into
+    something a FXPT_AUDIO plugin can use:
+
+        rms/peak        left, right and mono, 0-1
+        spectrum        Hann windowed 1024 point FFT, magnitude per bin (a full scale sine ~1.0)
+        bandEnergy      sum of squared magnitudes in FXAUDIO_BANDS log spaced bands (40Hz up)
+        flux            spectral flux, how much the spectrum grew since the last update
+        onset           flux over an adaptive threshold (mean + deviation of the last second)
+
+    One analyser per process (Acquire/Release), every instance sees the same audio so the result
+    is cached on lastUpdateTime, the first consumer in a frame pays for it and the rest get the
+    cached copy. The int16 > float conversion (with the window and rms/peak) runs AVX2 or SSE2
+    when the CPU has it, otherwise plain C.
+
+    The sample rate isn't in FXAUDIODETAILS, 44.1k is assumed (SetSampleRate if it isn't),
+    it only moves the band edges.
+*/
+
+#ifndef FXAUDIO_H
+#define FXAUDIO_H
+
+#include <stdint.h>
+
+#include "fxpluginstructures.h"
+
+#define FXAUDIO_FFTSIZE 1024
+#define FXAUDIO_BINS (FXAUDIO_FFTSIZE / 2)
+#define FXAUDIO_BANDS 8
+#define FXAUDIO_FLUXHISTORY 43      // about a second of updates at 1024 frames / 44.1k
+
+enum FXAUDIOPATH {FXAUDIO_AUTO = 0, FXAUDIO_SCALAR, FXAUDIO_SSE2, FXAUDIO_AVX2};
+
+struct FXAUDIOANALYSIS {
+    bool valid;                     // false when there is no audio (inactive or empty buffer)
+    double lastUpdateTime;          // FXAUDIODETAILS::lastUpdateTime this was made from
+    long updates;                   // analyses done so far (not cache hits)
+    int frames;                     // stereo frames in the buffer
+    float rms[3];                   // left, right, mono
+    float peak[3];
+    float spectrum[FXAUDIO_BINS];
+    float bandEnergy[FXAUDIO_BANDS];
+    float flux;
+    float fluxThreshold;
+    bool onset;
+    float onsetStrength;            // flux / threshold when onset, else 0
+};
+
+class FXAudioAnalyser
+{
+    public:
+        // one analyser per process, shared between instances
+        static FXAudioAnalyser* Acquire();
+        static void Release(FXAudioAnalyser* analyser);
+
+        // cached until lastUpdateTime changes
+        const FXAUDIOANALYSIS& Analyse(const FXAUDIODETAILS& audio);
+        const FXAUDIOANALYSIS& Last() { return result; }
+
+        void SetSampleRate(float hz);
+        void SetPath(FXAUDIOPATH p);        // mainly for fxbench, AUTO picks the best the CPU has
+        FXAUDIOPATH Path() { return path; }
+        static const char* PathName(FXAUDIOPATH p);
+
+        // int16 L/R > windowed mono, returns the sums of squares and peaks (left, right, mono)
+        static void Convert(FXAUDIOPATH p, const int16_t* in, int frames, const float* window, float* mono, float sumSq[3], float peak[3]);
+    protected:
+    private:
+        FXAudioAnalyser();
+        virtual ~FXAudioAnalyser();
+
+        FXAUDIOPATH path;
+        float sampleRate;
+        FXAUDIOANALYSIS result;
+        bool cached;
+
+        float window[FXAUDIO_FFTSIZE];
+        float cosTable[FXAUDIO_BINS];
+        float sinTable[FXAUDIO_BINS];
+        uint16_t bitReverse[FXAUDIO_FFTSIZE];
+        int bandStart[FXAUDIO_BANDS + 1];
+        float re[FXAUDIO_FFTSIZE];
+        float im[FXAUDIO_FFTSIZE];
+        float previous[FXAUDIO_BINS];
+        float fluxHistory[FXAUDIO_FLUXHISTORY];
+        int fluxCount;
+        int sinceOnset;
+
+        void FFT();
+        void Onset();
+};
+
+#endif // FXAUDIO_H
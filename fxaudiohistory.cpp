@@ -0,0 +1,121 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Audio history textures (see fxaudiohistory.h)
+*/
+
+#include "fxaudiohistory.h"
+
+#include <string.h>
+
+#define SPECTRUM_BYTES (FXAUDIO_BINS * sizeof(float))
+#define WAVEFORM_BYTES (FXAUDIO_FFTSIZE * 2 * sizeof(float))
+
+FXAudioHistory::FXAudioHistory() {
+    rows = 0;
+    head = -1;
+    pushed = 0;
+    lastUpdateTime = -1;
+    spectrum = waveform = 0;
+    for (int i = 0; i < FXAUDIOHISTORY_PBOS; i++) pbos[i] = 0;
+    nextPBO = 0;
+}
+
+FXAudioHistory::~FXAudioHistory() {
+    // empty, GL objects are released in Deinit while the context is still current
+}
+
+void FXAudioHistory::Init(int r) {
+    Deinit();
+    rows = max(r, 2);
+}
+
+void FXAudioHistory::Deinit() {
+    if (spectrum) glDeleteTextures(1, &spectrum);
+    if (waveform) glDeleteTextures(1, &waveform);
+    if (pbos[0]) glDeleteBuffers(FXAUDIOHISTORY_PBOS, pbos);
+    spectrum = waveform = 0;
+    for (int i = 0; i < FXAUDIOHISTORY_PBOS; i++) pbos[i] = 0;
+    head = -1;
+    pushed = 0;
+    lastUpdateTime = -1;
+}
+
+// each texture only ever goes on the unit ApplyAudioHistory samples it from, through gl if there is one
+void FXAudioHistory::Bind(int unit, GLuint texture, FXGLState* gl) {
+    if (gl) {
+        gl->ActiveTexture(GL_TEXTURE0 + unit);
+        gl->BindTexture2D(texture);
+    }else {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+// starts out silent, T repeats so the shader can count back past row 0
+GLuint FXAudioHistory::CreateTexture(int unit, GLint format, GLenum layout, int width, int channels, FXGLState* gl) {
+    vector<float> zero(width * rows * channels, 0.0f);
+    GLuint t;
+    glGenTextures(1, &t);
+    Bind(unit, t, gl);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, rows, 0, layout, GL_FLOAT, &zero[0]);
+    return t;
+}
+
+bool FXAudioHistory::CreateObjects(FXGLState* gl) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    spectrum = CreateTexture(FXAUDIOHISTORY_SPECTRUM_UNIT, GL_R32F, GL_RED, FXAUDIO_BINS, 1, gl);
+    waveform = CreateTexture(FXAUDIOHISTORY_WAVEFORM_UNIT, GL_RG32F, GL_RG, FXAUDIO_FFTSIZE, 2, gl);
+    if (gl) gl->ActiveTexture(GL_TEXTURE0);
+    else glActiveTexture(GL_TEXTURE0);
+
+    glGenBuffers(FXAUDIOHISTORY_PBOS, pbos);
+    for (int i = 0; i < FXAUDIOHISTORY_PBOS; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, SPECTRUM_BYTES + WAVEFORM_BYTES, 0, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return spectrum && waveform && pbos[0];
+}
+
+bool FXAudioHistory::Update(const FXAUDIOANALYSIS& analysis, const FXAUDIODETAILS& audio, FXGLState* gl) {
+    if (!rows || !analysis.valid || analysis.lastUpdateTime == lastUpdateTime) return false;
+    if (!spectrum && !CreateObjects(gl)) return false;
+    lastUpdateTime = analysis.lastUpdateTime;
+
+    // one row of each into the next pbo, the driver can still be reading the previous ones
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPBO]);
+    nextPBO = (nextPBO + 1) % FXAUDIOHISTORY_PBOS;
+    float* p = (float*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, SPECTRUM_BYTES + WAVEFORM_BYTES,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!p) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    memcpy(p, analysis.spectrum, SPECTRUM_BYTES);
+    float* w = p + FXAUDIO_BINS;
+    const int16_t* in = (const int16_t*)audio.dataBuffer;
+    int samples = analysis.frames * 2;
+    for (int i = 0; i < samples; i++) w[i] = in[i] * (1.0f / 32768.0f);
+    if (samples < FXAUDIO_FFTSIZE * 2) memset(w + samples, 0, (FXAUDIO_FFTSIZE * 2 - samples) * sizeof(float));
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    head = (head + 1) % rows;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    Bind(FXAUDIOHISTORY_SPECTRUM_UNIT, spectrum, gl);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, head, FXAUDIO_BINS, 1, GL_RED, GL_FLOAT, (GLvoid*)0);
+    Bind(FXAUDIOHISTORY_WAVEFORM_UNIT, waveform, gl);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, head, FXAUDIO_FFTSIZE, 1, GL_RG, GL_FLOAT, (GLvoid*)SPECTRUM_BYTES);
+    if (gl) gl->ActiveTexture(GL_TEXTURE0);
+    else glActiveTexture(GL_TEXTURE0);
+
+    // MUST unbind, else the host's next texture upload reads from our buffer
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pushed++;
+    return true;
+}
@@ -0,0 +1,80 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Audio history textures
+
+    The last n audio updates as two textures a shader can sample, rows are time:
+        spectrum    FXAUDIO_BINS wide, R32F magnitudes (see fxaudio.h)
+        waveform    FXAUDIO_FFTSIZE wide, RG32F left/right samples -1..1
+
+    Each new update is written into one row of a PBO and copied in with glTexSubImage2D, the
+    rows are a ring so nothing is ever shifted, the shader gets the newest row (head) as a
+    uniform and counts back from it (T wraps with GL_REPEAT). Memory is fixed at Init, however
+    long it runs.
+
+    usage (see CreateAudioHistoryParams/ApplyAudioHistory in pluginprivateobject.cpp):
+        InitPlugin:     audioHistory.Init(256); CreateAudioHistoryParams(id);
+                        and FXAUDIOHISTORY_GLSL in the frag shader text
+        Update:         audioHistory.Update(AudioAnalysis(), fx->audioData, gl);
+        Process:        ApplyAudioHistory(); before uniforms.Apply()
+    shader:
+        float level = fxSpectrum(bin, age);     // bin 0-1 (0 to nyquist), age 0 newest .. 1 oldest
+        vec2 lr = fxWaveform(x, age);
+*/
+
+#ifndef FXAUDIOHISTORY_H
+#define FXAUDIOHISTORY_H
+
+#include "fxpluginstructures.h"
+#include "fxaudio.h"
+#include "fxglstate.h"
+
+#define FXAUDIOHISTORY_PBOS 3
+#define FXAUDIOHISTORY_SPECTRUM_UNIT 14     // texture units ApplyAudioHistory binds to (clear of the mixer's 0-9)
+#define FXAUDIOHISTORY_WAVEFORM_UNIT 15
+
+// fxAudioHistory[0] = v of the newest row, [1] = v span from newest to oldest
+#define FXAUDIOHISTORY_GLSL \
+    "uniform sampler2D fxAudioSpectrum;\n" \
+    "uniform sampler2D fxAudioWaveform;\n" \
+    "uniform float fxAudioHistory[2];\n" \
+    "float fxSpectrum(float bin, float age) { return texture2D(fxAudioSpectrum, vec2(bin, fxAudioHistory[0] - age * fxAudioHistory[1])).r; }\n" \
+    "vec2 fxWaveform(float x, float age) { return texture2D(fxAudioWaveform, vec2(x, fxAudioHistory[0] - age * fxAudioHistory[1])).rg; }\n"
+
+class FXAudioHistory
+{
+    public:
+        FXAudioHistory();
+        virtual ~FXAudioHistory();
+
+        // just the size, the GL objects are made on the first Update
+        void Init(int rows);
+        void Deinit();
+
+        // streams the block in if it's a new update (call from Update/Process, needs the context),
+        // the textures are left on their own units, gl is told about the binds
+        bool Update(const FXAUDIOANALYSIS& analysis, const FXAUDIODETAILS& audio, FXGLState* gl = 0);
+
+        GLuint SpectrumTexture() { return spectrum; }
+        GLuint WaveformTexture() { return waveform; }
+        int Rows() { return rows; }
+        long Pushed() { return pushed; }
+        float Head() { return rows ? (head + 0.5f) / rows : 0; }
+        float Span() { return rows ? (float)(rows - 1) / rows : 0; }
+    protected:
+    private:
+        int rows;
+        int head;                   // row written last
+        long pushed;
+        double lastUpdateTime;
+        GLuint spectrum, waveform;
+        GLuint pbos[FXAUDIOHISTORY_PBOS];
+        int nextPBO;
+
+        bool CreateObjects(FXGLState* gl);
+        GLuint CreateTexture(int unit, GLint format, GLenum layout, int width, int channels, FXGLState* gl);
+        void Bind(int unit, GLuint texture, FXGLState* gl);
+};
+
+#endif // FXAUDIOHISTORY_H
@@ -0,0 +1,62 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Beat clock (see fxbeatclock.h)
+*/
+
+#include "fxbeatclock.h"
+
+#define LOOP_LENGTH ((double)FXBEAT_BARLENGTH * FXBEAT_LOOPBARS)
+
+const int FXBeatClock::lengths[FXBEAT_DIVISIONS] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+const double FXBeatClock::inverseLengths[FXBEAT_DIVISIONS] = {
+    1.0 / 16, 1.0 / 32, 1.0 / 64, 1.0 / 128, 1.0 / 256, 1.0 / 512, 1.0 / 1024, 1.0 / 2048, 1.0 / 4096
+};
+const char* const FXBeatClock::labels[FXBEAT_DIVISIONS] = {"1/16", "1/8", "1/4", "1/2", "1", "2", "4", "8", "16"};
+
+FXBeatClock::FXBeatClock() {
+    bpm = prevbpm = 0;
+    Reset();
+}
+
+void FXBeatClock::Reset() {
+    synced = false;
+    position = 0;
+    bpmChanged = false;
+    hits = 0;
+    for (int d = 0; d < FXBEAT_DIVISIONS; d++) {
+        count[d] = 0;
+        phase[d] = 0;
+        timeToNext[d] = 0;
+    }
+}
+
+void FXBeatClock::Tick(const FXOBJECT* fx) {
+    double pos = fmod((fx->bar % FXBEAT_LOOPBARS) * (double)FXBEAT_BARLENGTH + fx->hemidemisemiQuaverCount, LOOP_LENGTH);
+    if (pos < 0) pos += LOOP_LENGTH;
+
+    bpm = fx->bpm;
+    bpmChanged = synced && bpm != prevbpm;
+    prevbpm = bpm;
+
+    // going back more than half the loop is the bar 63 > 0 wrap, less is the host relocating
+    double delta = pos - position;
+    if (delta < -LOOP_LENGTH * 0.5) delta += LOOP_LENGTH;
+    bool forward = synced && delta > 0;
+
+    double perSecond = bpm * (64.0 / 60.0);
+    hits = 0;
+    for (int d = 0; d < FXBEAT_DIVISIONS; d++) {
+        long c = (long)(pos * inverseLengths[d]);
+        if (forward && c != count[d]) hits |= 1u << d;
+        count[d] = c;
+
+        double into = pos - (double)c * lengths[d];
+        phase[d] = (float)(into * inverseLengths[d]);
+        timeToNext[d] = perSecond > 0 ? (lengths[d] - into) / perSecond : 0;
+    }
+
+    position = pos;
+    synced = true;
+}
@@ -0,0 +1,86 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Beat clock
+
+    Works out every beat division once per frame from the host's hemidemisemiQuaverCount
+    (64 per beat, 0-256 in a bar), bar (0-63) and bpm, instead of each effect doing its own
+    floor(hemidemisemiQuaverCount / n):
+
+        Hit(d)          true on the one frame a division boundary was crossed (edge triggered)
+        Phase(d)        0-1 through the current division
+        TimeToNext(d)   seconds until the next boundary at the current bpm
+        Count(d)        which division it is within the 64 bar loop
+
+    Divisions go 1/16 to 16 bars (the old hdsqDelays/beatLabels). The position is bar * 256 +
+    hemidemisemiQuaverCount, so wrapping from bar 63 to 0 is just another boundary, a jump
+    backwards (the host relocating) resyncs without firing. A bpm change is flagged for the
+    frame it happens on and the predictions use the new tempo straight away.
+
+    usage:
+        Process:    beats.Tick(fx);     once a frame (not Update, that also runs from Reset/SetState)
+        anywhere:   if (beats.Hit(FXBEAT_BAR)) ...  float p = beats.Phase(FXBEAT_QUARTER);
+*/
+
+#ifndef FXBEATCLOCK_H
+#define FXBEATCLOCK_H
+
+#include "fxpluginstructures.h"
+
+#define FXBEAT_BARLENGTH 256        // hemidemisemiquavers in a bar (4 beats)
+#define FXBEAT_LOOPBARS 64          // fx->bar wraps at this
+
+enum FXBEATDIVISION {
+    FXBEAT_16TH = 0,    // 1/16
+    FXBEAT_8TH,         // 1/8
+    FXBEAT_QUARTER,     // 1/4, a beat
+    FXBEAT_HALF,        // 1/2
+    FXBEAT_BAR,
+    FXBEAT_2BARS,
+    FXBEAT_4BARS,
+    FXBEAT_8BARS,
+    FXBEAT_16BARS,
+    FXBEAT_DIVISIONS
+};
+
+class FXBeatClock
+{
+    public:
+        FXBeatClock();
+
+        // the next Tick takes the position as it is without firing anything
+        void Reset();
+        // once per frame
+        void Tick(const FXOBJECT* fx);
+
+        bool Hit(int d) { return (hits >> d) & 1; }
+        unsigned int Hits() { return hits; }            // bit per division
+        float Phase(int d) { return phase[d]; }
+        double TimeToNext(int d) { return timeToNext[d]; }
+        long Count(int d) { return count[d]; }
+
+        double Position() { return position; }          // hemidemisemiquavers into the 64 bar loop
+        float Bpm() { return bpm; }
+        bool BpmChanged() { return bpmChanged; }
+
+        static int Length(int d) { return lengths[d]; }
+        static const char* Label(int d) { return labels[d]; }
+    protected:
+    private:
+        static const int lengths[FXBEAT_DIVISIONS];
+        static const double inverseLengths[FXBEAT_DIVISIONS];
+        static const char* const labels[FXBEAT_DIVISIONS];
+
+        bool synced;
+        double position;
+        float bpm;
+        float prevbpm;
+        bool bpmChanged;
+        unsigned int hits;
+        long count[FXBEAT_DIVISIONS];
+        float phase[FXBEAT_DIVISIONS];
+        double timeToNext[FXBEAT_DIVISIONS];
+};
+
+#endif // FXBEATCLOCK_H
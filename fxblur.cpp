@@ -0,0 +1,336 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Blur kernels (see fxblur.h)
+*/
+
+#include "fxblur.h"
+
+#include <sstream>
+#include <string.h>
+
+FXBlur::FXBlur() {
+    gl = 0;
+    quad = 0;
+    for (int i = 0; i < FXBLURKERNEL_COUNT; i++) shaders[i] = 0;
+    kind = FXBLUR_GAUSSIAN;
+    radius = 0.0f;
+    offset = 1.0f;
+    mipmaps = false;
+    levels = 0;
+    tapCount = LinearTaps(kind, radius, taps);
+    input = output = temp = -1;
+    for (int k = 0; k <= FXBLUR_MAXLEVELS; k++) level[k] = downPass[k] = mipPass[k] = hPass[k] = vPass[k] = -1;
+    for (int k = 0; k < FXBLUR_MAXLEVELS; k++) upPass[k] = -1;
+    frame = 0;
+    mipTexture = 0;
+    mipFrame = -1;
+    sampler = 0;
+}
+
+FXBlur::~FXBlur() {
+    // empty, the sampler is released in Deinit while the context is still current
+}
+
+void FXBlur::Deinit() {
+    if (sampler) glDeleteSamplers(1, &sampler);
+    sampler = 0;
+    mipTexture = 0;
+    mipFrame = -1;
+}
+
+string FXBlur::KernelText(FXBLURKERNEL kernel) {
+    std::ostringstream s;
+    s << "#version 120\n"
+         "uniform sampler2D fxBlurTex;\n";
+    if (kernel == FXBLURKERNEL_SEPARABLE) {
+        // fxBlur = one texel along the direction (uv), taps, clamp lo u/v, hi u/v
+        s << "uniform float fxBlurTap[" << FXBLUR_MAXTAPS * 2 << "];\n"
+             "uniform float fxBlur[7];\n"
+             "vec4 fxBlurAt(vec2 uv) { return texture2D(fxBlurTex, clamp(uv, vec2(fxBlur[3], fxBlur[4]), vec2(fxBlur[5], fxBlur[6]))); }\n"
+             "void main(){\n"
+             "  vec2 uv = gl_TexCoord[0].st;\n"
+             "  vec2 d = vec2(fxBlur[0], fxBlur[1]);\n"
+             "  vec4 c = fxBlurAt(uv) * fxBlurTap[1];\n"
+             "  for (int i = 1; i < " << FXBLUR_MAXTAPS << "; i++) {\n"
+             "    if (float(i) >= fxBlur[2]) break;\n"
+             "    vec2 o = d * fxBlurTap[i * 2];\n"
+             "    c += (fxBlurAt(uv + o) + fxBlurAt(uv - o)) * fxBlurTap[i * 2 + 1];\n"
+             "  }\n"
+             "  gl_FragColor = c;\n"
+             "}\n";
+        return s.str();
+    }
+    // fxKawase = offset x/y (uv), clamp lo u/v, hi u/v
+    s << "uniform float fxKawase[6];\n"
+         "vec4 fxBlurAt(vec2 uv) { return texture2D(fxBlurTex, clamp(uv, vec2(fxKawase[2], fxKawase[3]), vec2(fxKawase[4], fxKawase[5]))); }\n"
+         "void main(){\n"
+         "  vec2 uv = gl_TexCoord[0].st;\n"
+         "  vec2 o = vec2(fxKawase[0], fxKawase[1]);\n";
+    if (kernel == FXBLURKERNEL_DOWN) {
+        s << "  vec4 c = fxBlurAt(uv) * 4.0 + fxBlurAt(uv - o) + fxBlurAt(uv + o)\n"
+             "         + fxBlurAt(uv + vec2(o.x, -o.y)) + fxBlurAt(uv - vec2(o.x, -o.y));\n"
+             "  gl_FragColor = c / 8.0;\n";
+    }else {
+        s << "  vec4 c = fxBlurAt(uv + vec2(-o.x * 2.0, 0.0)) + fxBlurAt(uv + vec2(o.x * 2.0, 0.0))\n"
+             "         + fxBlurAt(uv + vec2(0.0, o.y * 2.0)) + fxBlurAt(uv + vec2(0.0, -o.y * 2.0))\n"
+             "         + (fxBlurAt(uv + o) + fxBlurAt(uv - o) + fxBlurAt(uv + vec2(o.x, -o.y)) + fxBlurAt(uv + vec2(-o.x, o.y))) * 2.0;\n"
+             "  gl_FragColor = c / 12.0;\n";
+    }
+    s << "}\n";
+    return s.str();
+}
+
+const char* FXBlur::KernelName(FXBLURKERNEL kernel) {
+    static const char* names[FXBLURKERNEL_COUNT] = {"000-VIDIFOLD-BLUR-Separable", "000-VIDIFOLD-BLUR-KawaseDown", "000-VIDIFOLD-BLUR-KawaseUp"};
+    return kernel >= 0 && kernel < FXBLURKERNEL_COUNT ? names[kernel] : "";
+}
+
+int FXBlur::LinearTaps(FXBLURKIND kind, float r, float* out) {
+    // texel weights out to n, then neighbours paired up into one read between them
+    r = max(0.0f, min(r, (float)FXBLUR_TAPRADIUS));
+    int n = (int)ceil(r);
+    float w[FXBLUR_TAPRADIUS + 2] = {0};
+    float sigma = max(r / 3.0f, 0.5f);
+    for (int k = 0; k <= n; k++) {
+        if (kind == FXBLUR_BOX) w[k] = k <= (int)r ? 1.0f : r - (int)r;
+        else w[k] = (float)exp(-(k * k) / (2.0f * sigma * sigma));
+    }
+    float total = w[0];
+    for (int k = 1; k <= n; k++) total += 2.0f * w[k];
+
+    out[0] = 0.0f;
+    out[1] = w[0] / total;
+    int count = 1;
+    for (int k = 1; k <= n; k += 2) {
+        float weight = w[k] + w[k + 1];
+        out[count * 2] = weight > 0.0f ? (k * w[k] + (k + 1) * w[k + 1]) / weight : (float)k;
+        out[count * 2 + 1] = weight / total;
+        count++;
+    }
+    return count;
+}
+
+int FXBlur::Levels(FXBLURKIND kind, float r) {
+    int l = 0;
+    if (kind == FXBLUR_KAWASE) {
+        // the nearest level count, the tap offsets cover the rest (see Set)
+        l = (int)floor(log2(max(r, 1.0f) / FXBLUR_KAWASERADIUS) + 0.5);
+        return max(1, min(l, FXBLUR_MAXLEVELS));
+    }
+    while (l < FXBLUR_MAXLEVELS && r / (1 << l) > FXBLUR_TAPRADIUS) l++;
+    return l;
+}
+
+void FXBlur::Set(FXBLURKIND k, float r) {
+    kind = k;
+    radius = max(r, 0.0f);
+    levels = Levels(kind, radius);
+    if (kind != FXBLUR_KAWASE) tapCount = LinearTaps(kind, radius / (1 << levels), taps);
+    else offset = max(0.5f, min(radius / (FXBLUR_KAWASERADIUS * (1 << levels)), 2.0f));
+}
+
+void FXBlur::Add(FXRenderGraph& graph, int in, int out) {
+    input = in;
+    output = out;
+    level[0] = input;
+    for (int k = 1; k <= FXBLUR_MAXLEVELS; k++) level[k] = graph.Texture(1, 1);
+    temp = graph.Texture(1, 1);
+
+    for (int k = 1; k <= FXBLUR_MAXLEVELS; k++) {
+        std::ostringstream name;
+        name << "blur down " << k;
+        downPass[k] = graph.AddPass(name.str(), [this, k](FXRenderGraph& g){ DrawDown(g, k); });
+        graph.Read(downPass[k], level[k - 1]);
+        graph.Write(downPass[k], level[k]);
+    }
+    for (int k = 1; k <= FXBLUR_MAXLEVELS; k++) {
+        std::ostringstream name;
+        name << "blur mip " << k;
+        mipPass[k] = graph.AddPass(name.str(), [this, k](FXRenderGraph& g){ DrawMip(g, k); });
+        graph.Read(mipPass[k], input);
+        graph.Write(mipPass[k], level[k]);
+    }
+    for (int k = 0; k <= FXBLUR_MAXLEVELS; k++) {
+        std::ostringstream h, v;
+        h << "blur h " << k;
+        v << "blur v " << k;
+        int from = level[k];
+        hPass[k] = graph.AddPass(h.str(), [this, from](FXRenderGraph& g){ DrawSeparable(g, from, false); });
+        graph.Read(hPass[k], from);
+        graph.Write(hPass[k], temp);
+        vPass[k] = graph.AddPass(v.str(), [this](FXRenderGraph& g){ DrawSeparable(g, temp, true); });
+        graph.Read(vPass[k], temp);
+        graph.Write(vPass[k], k ? level[k] : output);
+    }
+    // back up through the levels, a new version of each so the graph ping-pongs them
+    for (int k = FXBLUR_MAXLEVELS - 1; k >= 0; k--) {
+        std::ostringstream name;
+        name << "blur up " << k;
+        upPass[k] = graph.AddPass(name.str(), [this, k](FXRenderGraph& g){ DrawUp(g, k); });
+        graph.Read(upPass[k], level[k + 1]);
+        graph.Write(upPass[k], k ? level[k] : output);
+    }
+    for (int k = 0; k <= FXBLUR_MAXLEVELS; k++) {
+        graph.Enable(downPass[k], false);
+        graph.Enable(mipPass[k], false);
+        graph.Enable(hPass[k], false);
+        graph.Enable(vPass[k], false);
+        if (k < FXBLUR_MAXLEVELS) graph.Enable(upPass[k], false);
+    }
+}
+
+void FXBlur::Update(FXRenderGraph& graph, int width, int height, long f) {
+    if (input < 0) return;
+    frame = f;
+    // no smaller than a texel
+    int l = levels;
+    while (l > 0 && ((width >> l) < 1 || (height >> l) < 1)) l--;
+
+    for (int k = 1; k <= FXBLUR_MAXLEVELS; k++) graph.Resize(level[k], max(1, width >> k), max(1, height >> k));
+    graph.Resize(temp, max(1, width >> l), max(1, height >> l));
+
+    bool separable = kind != FXBLUR_KAWASE;
+    bool mip = separable && mipmaps && l > 0;
+    for (int k = 1; k <= FXBLUR_MAXLEVELS; k++) {
+        graph.Enable(downPass[k], k <= l && !mip);
+        graph.Enable(mipPass[k], k == l && mip);
+    }
+    for (int k = 0; k <= FXBLUR_MAXLEVELS; k++) {
+        graph.Enable(hPass[k], separable && k == l);
+        graph.Enable(vPass[k], separable && k == l);
+    }
+    for (int k = 0; k < FXBLUR_MAXLEVELS; k++) graph.Enable(upPass[k], k < l);
+}
+
+// texel size (uv) of the texture resource is in, and the clamp inside its image
+void FXBlur::Texel(FXRenderGraph& g, int from, float* texel, float* bounds) {
+    float tx = g.InputTX(from);
+    float ty = g.InputTY(from);
+    texel[0] = tx / max(g.InputWidth(from), 1);
+    texel[1] = ty / max(g.InputHeight(from), 1);
+    bounds[0] = 0.5f * texel[0];
+    bounds[1] = 0.5f * texel[1];
+    bounds[2] = tx - bounds[0];
+    bounds[3] = ty - bounds[1];
+}
+
+bool FXBlur::Begin(FXRenderGraph& g, int from, FXBLURKERNEL kernel) {
+    gl->ActiveTexture(GL_TEXTURE0);
+    gl->Enable(GL_TEXTURE_2D);
+    gl->BindTexture2D(g.Input(from));
+    FXSHADER* shader = shaders[kernel];
+    if (shader && shader->id) {
+        gl->UseProgram(shader->id);
+        glUniform1i(shader->params[0].id, 0);
+        return true;
+    }
+    // not linked yet, bilinear
+    gl->UseProgram(0);
+    glColor4f(1.0f,1.0f,1.0f,1.0f);
+    return false;
+}
+
+void FXBlur::Draw(FXRenderGraph& g, int from) {
+    float tx = g.InputTX(from);
+    float ty = g.InputTY(from);
+    float w = (float)g.TargetWidth();
+    float h = (float)g.TargetHeight();
+    if (quad && quad->Available()) {
+        quad->Draw(0, 0, 0, 0, w, h, tx, ty, 0.0f);
+        return;
+    }
+    glBegin(GL_TRIANGLE_STRIP);
+    glTexCoord2f(0, 0); glVertex2f(0, 0);
+    glTexCoord2f(tx, 0); glVertex2f(w, 0);
+    glTexCoord2f(0, ty); glVertex2f(0, h);
+    glTexCoord2f(tx, ty); glVertex2f(w, h);
+    glEnd();
+}
+
+void FXBlur::DrawDown(FXRenderGraph& g, int k) {
+    int from = level[k - 1];
+    // half size, so one bilinear read between 4 texels is already the 2x2 average
+    if (kind != FXBLUR_KAWASE) {
+        Resample(g, from);
+        return;
+    }
+    if (!Begin(g, from, FXBLURKERNEL_DOWN)) {
+        Draw(g, from);
+        return;
+    }
+    float texel[2], bounds[4];
+    Texel(g, from, texel, bounds);
+    float v[6] = {offset * texel[0], offset * texel[1], bounds[0], bounds[1], bounds[2], bounds[3]};
+    glUniform1fv(shaders[FXBLURKERNEL_DOWN]->params[1].id, 6, v);
+    Draw(g, from);
+}
+
+void FXBlur::DrawMip(FXRenderGraph& g, int k) {
+    GLuint texture = g.Input(input);
+    gl->ActiveTexture(GL_TEXTURE0);
+    gl->BindTexture2D(texture);
+    // once a frame however many blurs read it
+    if (texture != mipTexture || frame != mipFrame) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        mipTexture = texture;
+        mipFrame = frame;
+    }
+    if (!sampler) {
+        glGenSamplers(1, &sampler);
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    // only level k
+    glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, (float)k);
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, (float)k);
+    glBindSampler(0, sampler);
+    Resample(g, input);
+    glBindSampler(0, 0);
+}
+
+void FXBlur::DrawSeparable(FXRenderGraph& g, int from, bool vertical) {
+    Separable(g, from, vertical, taps, tapCount);
+}
+
+void FXBlur::DrawUp(FXRenderGraph& g, int k) {
+    int from = level[k + 1];
+    if (kind != FXBLUR_KAWASE) {
+        Resample(g, from);
+        return;
+    }
+    if (!Begin(g, from, FXBLURKERNEL_UP)) {
+        Draw(g, from);
+        return;
+    }
+    // diagonals half a texel out, the sides a whole one
+    float texel[2], bounds[4];
+    Texel(g, from, texel, bounds);
+    float v[6] = {0.5f * offset * texel[0], 0.5f * offset * texel[1], bounds[0], bounds[1], bounds[2], bounds[3]};
+    glUniform1fv(shaders[FXBLURKERNEL_UP]->params[1].id, 6, v);
+    Draw(g, from);
+}
+
+// the separable kernel with just the centre tap, a bilinear resize that stays inside the image
+// (plain texturing would take in whatever is next to it in the buffer at the top/right edges)
+void FXBlur::Resample(FXRenderGraph& g, int from) {
+    static const float copy[2] = {0.0f, 1.0f};
+    Separable(g, from, false, copy, 1);
+}
+
+void FXBlur::Separable(FXRenderGraph& g, int from, bool vertical, const float* t, int count) {
+    if (!Begin(g, from, FXBLURKERNEL_SEPARABLE)) {
+        Draw(g, from);
+        return;
+    }
+    float texel[2], bounds[4];
+    Texel(g, from, texel, bounds);
+    float v[7] = {vertical ? 0.0f : texel[0], vertical ? texel[1] : 0.0f, (float)count, bounds[0], bounds[1], bounds[2], bounds[3]};
+    FXSHADER* shader = shaders[FXBLURKERNEL_SEPARABLE];
+    glUniform1fv(shader->params[1].id, count * 2, t);
+    glUniform1fv(shader->params[2].id, 7, v);
+    Draw(g, from);
+}
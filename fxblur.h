@@ -0,0 +1,126 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Blur kernels
+
+    Blur/glow plugins each had their own N tap kernel in CreateShaders, a radius of 64 being 129
+    fetches a pixel a direction. FXBlur is one set of kernels (shared by name between plugins) that
+    adds its passes to the render graph:
+
+        gaussian/box    separable, the taps read between two texels so bilinear filtering weighs
+                        both (half the fetches), offsets/weights are uniforms so one program does any
+                        radius up to FXBLUR_TAPRADIUS, a box takes a fractional radius
+        kawase          dual Kawase, 5 tap downsamples then 8 tap upsamples through the levels,
+                        the nearest level count for the radius and the tap spread makes up the rest
+        levels          the radius sets how many times the image is halved (2x2 average), so the taps
+                        never go past FXBLUR_TAPRADIUS at the level they run at and a big blur costs
+                        about the same as a small one (at most 1/3 more pixels than the full size
+                        passes), the result comes back up a level at a time with bilinear
+        mipmaps         UseMipmaps(true) skips the halving on a Source() input, glGenerateMipmap is
+                        run on it the first time a frame needs it and the level is read through a
+                        sampler object (the host's texture filter is left alone)
+
+    The levels sit in the bottom left of whichever host buffers the graph hands out (see
+    fxrendergraph.h), so they never need more than bufferA/B/C, every read is clamped inside the
+    image. Until the kernels have linked the passes are plain bilinear copies. Radii are approximate
+    past the first level (the halving and the way back up blur a little on their own).
+
+    usage (see CreateBlurShaders/ApplyBlur in pluginprivateobject.cpp):
+        CreateShaders:  CreateBlurShaders();
+        InitPlugin:     blur.Set(FXBLUR_GAUSSIAN, 40.0f);
+                        blur.Add(graph, graph.Source(...), graphOutput);   // or any Texture()
+                        blur.Attach(gl, quad);  // once they are acquired
+        Update:         blur.Set(FXBLUR_KAWASE, radius);
+        Process:        ApplyBlur(); before graph.Execute (sizes/passes for this frame)
+        Deinit:         blur.Deinit();
+*/
+
+#ifndef FXBLUR_H
+#define FXBLUR_H
+
+#include "fxpluginstructures.h"
+#include "fxglstate.h"
+#include "fxquad.h"
+#include "fxrendergraph.h"
+
+#define FXBLUR_TAPRADIUS 8              // texels either side at one level, past it the image is halved first
+#define FXBLUR_MAXTAPS (FXBLUR_TAPRADIUS / 2 + 1)      // the centre + pairs of texels
+#define FXBLUR_MAXLEVELS 6              // halvings, 1/64 of the size
+#define FXBLUR_KAWASERADIUS 3.5f        // dual Kawase comes out near a gaussian of this x 2^levels
+
+enum FXBLURKIND {
+    FXBLUR_GAUSSIAN,                    // radius = 3 sigma
+    FXBLUR_BOX,
+    FXBLUR_KAWASE
+};
+
+enum FXBLURKERNEL {
+    FXBLURKERNEL_SEPARABLE,             // fxBlurTex, fxBlurTap, fxBlur
+    FXBLURKERNEL_DOWN,                  // fxBlurTex, fxKawase
+    FXBLURKERNEL_UP,                    // fxBlurTex, fxKawase
+    FXBLURKERNEL_COUNT
+};
+
+class FXBlur
+{
+    public:
+        FXBlur();
+        virtual ~FXBlur();
+
+        // #version 120 frag text (000-1TextureVert) and the program name, the frag is name + "Frag"
+        static string KernelText(FXBLURKERNEL kernel);
+        static const char* KernelName(FXBLURKERNEL kernel);
+        // offset (texels), weight pairs, [0] the centre, returns how many
+        static int LinearTaps(FXBLURKIND kind, float radius, float* taps);
+        static int Levels(FXBLURKIND kind, float radius);
+
+        void SetShader(FXBLURKERNEL kernel, FXSHADER* shader) { shaders[kernel] = shader; }
+        void Attach(FXGLState* state, FXQuad* q) { gl = state; quad = q; }
+        void Set(FXBLURKIND kind, float radius);
+        void UseMipmaps(bool on) { mipmaps = on; }
+
+        // the passes blurring input into output, all disabled until Update
+        void Add(FXRenderGraph& graph, int input, int output);
+        // before graph.Execute, the image size of the input and a frame count (mipmaps once a frame)
+        void Update(FXRenderGraph& graph, int width, int height, long frame);
+        bool Added() { return input >= 0; }
+        int LevelsInUse() { return levels; }
+        void Deinit();
+    protected:
+    private:
+        FXGLState* gl;
+        FXQuad* quad;
+        FXSHADER* shaders[FXBLURKERNEL_COUNT];
+        FXBLURKIND kind;
+        float radius;
+        float offset;                   // kawase tap spread, radius between two level counts
+        bool mipmaps;
+        int levels;
+        int tapCount;
+        float taps[FXBLUR_MAXTAPS * 2];
+
+        int input, output;
+        int level[FXBLUR_MAXLEVELS + 1];    // [0] is the input
+        int temp;                           // between the two separable passes
+        int downPass[FXBLUR_MAXLEVELS + 1], mipPass[FXBLUR_MAXLEVELS + 1];
+        int hPass[FXBLUR_MAXLEVELS + 1], vPass[FXBLUR_MAXLEVELS + 1];
+        int upPass[FXBLUR_MAXLEVELS];
+
+        long frame;
+        GLuint mipTexture;                  // last given mipmaps, and in which frame
+        long mipFrame;
+        GLuint sampler;
+
+        void DrawDown(FXRenderGraph& g, int k);
+        void DrawMip(FXRenderGraph& g, int k);
+        void DrawSeparable(FXRenderGraph& g, int from, bool vertical);
+        void DrawUp(FXRenderGraph& g, int k);
+        void Resample(FXRenderGraph& g, int from);
+        void Separable(FXRenderGraph& g, int from, bool vertical, const float* taps, int count);
+        bool Begin(FXRenderGraph& g, int from, FXBLURKERNEL kernel);
+        void Draw(FXRenderGraph& g, int from);
+        void Texel(FXRenderGraph& g, int from, float* texel, float* bounds);
+};
+
+#endif // FXBLUR_H
@@ -0,0 +1,301 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Lossless frame codec (see fxcodec.h)
+*/
+
+#include "fxcodec.h"
+#include "fxworkers.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define OP_INDEX 0x00
+#define OP_DIFF  0x40
+#define OP_LUMA  0x80
+#define OP_RUN   0xC0
+#define OP_RGB   0xFE
+#define OP_RGBA  0xFF
+#define OP_MASK  0xC0
+
+// worst case is every pixel as OP_RGBA
+#define STRIPE_MAX(pixels) ((pixels) * 5)
+#define STRIPE_RAW 0x80000000
+
+static inline uint32_t Load(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline int Hash(const unsigned char* p) {
+    return (p[0] * 3 + p[1] * 5 + p[2] * 7 + p[3] * 11) & 63;
+}
+
+// pixels from i on that are the same as px
+static inline size_t RunLength(const unsigned char* in, size_t i, size_t end, uint32_t px) {
+    size_t n = i;
+#ifdef __SSE2__
+    __m128i v = _mm_set1_epi32((int)px);
+    while (n + 4 <= end) {
+        int same = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(in + n * 4)), v));
+        if (same != 0xFFFF) return n - i + (__builtin_ctz(~same) >> 2);
+        n += 4;
+    }
+#endif
+    while (n < end && Load(in + n * 4) == px) n++;
+    return n - i;
+}
+
+static inline void Fill(unsigned char* out, size_t count, uint32_t px) {
+    size_t n = 0;
+#ifdef __SSE2__
+    __m128i v = _mm_set1_epi32((int)px);
+    for (; n + 4 <= count; n += 4) _mm_storeu_si128((__m128i*)(out + n * 4), v);
+#endif
+    for (; n < count; n++) memcpy(out + n * 4, &px, 4);
+}
+
+size_t FXCodec::EncodeStripe(const unsigned char* in, size_t pixels, unsigned char* out) {
+    uint32_t index[64];
+    memset(index, 0, sizeof(index));
+    unsigned char* o = out;
+
+    unsigned char prevBytes[4] = {0, 0, 0, 255};
+    const unsigned char* prevPx = prevBytes;
+    uint32_t prev = Load(prevBytes);
+
+    size_t i = 0;
+    while (i < pixels) {
+        const unsigned char* p = in + i * 4;
+        uint32_t px = Load(p);
+
+        if (px == prev) {
+            size_t run = RunLength(in, i, pixels, prev);
+            i += run;
+            while (run) {
+                size_t n = run < 62 ? run : 62;
+                *o++ = OP_RUN | (unsigned char)(n - 1);
+                run -= n;
+            }
+            continue;
+        }
+
+        int h = Hash(p);
+        if (index[h] == px) {
+            *o++ = OP_INDEX | h;
+        }else {
+            index[h] = px;
+            if (p[3] == prevPx[3]) {
+                signed char vr = p[0] - prevPx[0];
+                signed char vg = p[1] - prevPx[1];
+                signed char vb = p[2] - prevPx[2];
+                signed char vgr = vr - vg;
+                signed char vgb = vb - vg;
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    *o++ = OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                }else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                    *o++ = OP_LUMA | (vg + 32);
+                    *o++ = (vgr + 8) << 4 | (vgb + 8);
+                }else {
+                    *o++ = OP_RGB;
+                    *o++ = p[0];
+                    *o++ = p[1];
+                    *o++ = p[2];
+                }
+            }else {
+                *o++ = OP_RGBA;
+                memcpy(o, p, 4);
+                o += 4;
+            }
+        }
+        prev = px;
+        prevPx = p;
+        i++;
+    }
+    return o - out;
+}
+
+bool FXCodec::DecodeStripe(const unsigned char* in, size_t size, unsigned char* out, size_t pixels) {
+    uint32_t index[64];
+    memset(index, 0, sizeof(index));
+    const unsigned char* end = in + size;
+
+    unsigned char px[4] = {0, 0, 0, 255};
+    size_t i = 0;
+    while (i < pixels) {
+        if (in >= end) return false;
+        unsigned char b1 = *in++;
+
+        if (b1 == OP_RGB) {
+            if (end - in < 3) return false;
+            px[0] = in[0];
+            px[1] = in[1];
+            px[2] = in[2];
+            in += 3;
+        }else if (b1 == OP_RGBA) {
+            if (end - in < 4) return false;
+            memcpy(px, in, 4);
+            in += 4;
+        }else if ((b1 & OP_MASK) == OP_INDEX) {
+            memcpy(px, &index[b1], 4);
+        }else if ((b1 & OP_MASK) == OP_DIFF) {
+            px[0] += ((b1 >> 4) & 3) - 2;
+            px[1] += ((b1 >> 2) & 3) - 2;
+            px[2] += (b1 & 3) - 2;
+        }else if ((b1 & OP_MASK) == OP_LUMA) {
+            if (in >= end) return false;
+            unsigned char b2 = *in++;
+            int vg = (b1 & 0x3F) - 32;
+            px[0] += vg - 8 + ((b2 >> 4) & 0x0F);
+            px[1] += vg;
+            px[2] += vg - 8 + (b2 & 0x0F);
+        }else {
+            size_t run = (b1 & 0x3F) + 1;
+            if (run > pixels - i) return false;
+            Fill(out + i * 4, run, Load(px));
+            i += run;
+            continue;
+        }
+
+        memcpy(out + i * 4, px, 4);
+        index[Hash(px)] = Load(px);
+        i++;
+    }
+    return in == end;
+}
+
+bool FXCodec::Info(const unsigned char* data, size_t size, unsigned int& width, unsigned int& height) {
+    FXCODECHEADER header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, FXCODEC_MAGIC, 4) != 0 || header.channels != 4 || !header.stripeRows) return false;
+    if (header.stripeCount != (header.height + header.stripeRows - 1) / header.stripeRows) return false;
+    if (size < sizeof(header) + header.stripeCount * 4) return false;
+    width = header.width;
+    height = header.height;
+    return true;
+}
+
+bool FXCodec::Encode(const unsigned char* rgba, unsigned int width, unsigned int height,
+                     vector<unsigned char>& out, FXWorkerPool* pool) {
+    if (!rgba || !width || !height) return false;
+
+    FXCODECHEADER header;
+    memcpy(header.magic, FXCODEC_MAGIC, 4);
+    header.width = width;
+    header.height = height;
+    header.channels = 4;
+    header.stripeRows = FXCODEC_STRIPE_ROWS;
+    header.stripeCount = (height + FXCODEC_STRIPE_ROWS - 1) / FXCODEC_STRIPE_ROWS;
+
+    // every stripe gets room for its worst case, then they are packed down
+    size_t stripePixels = (size_t)width * FXCODEC_STRIPE_ROWS;
+    size_t dataStart = sizeof(header) + header.stripeCount * 4;
+    out.resize(dataStart + header.stripeCount * STRIPE_MAX(stripePixels));
+
+    vector<uint32_t> sizes(header.stripeCount);
+    unsigned char* base = &out[dataStart];
+    auto encode = [&](int s) {
+        unsigned int rows = min((unsigned int)FXCODEC_STRIPE_ROWS, height - s * FXCODEC_STRIPE_ROWS);
+        const unsigned char* in = rgba + (size_t)s * stripePixels * 4;
+        unsigned char* o = base + s * STRIPE_MAX(stripePixels);
+        size_t raw = (size_t)width * rows * 4;
+        size_t packed = EncodeStripe(in, (size_t)width * rows, o);
+        if (packed < raw) {
+            sizes[s] = (uint32_t)packed;
+        }else {
+            // noise, keep it as it was rather than growing it
+            memcpy(o, in, raw);
+            sizes[s] = (uint32_t)raw | STRIPE_RAW;
+        }
+    };
+    if (pool) pool->Run(header.stripeCount, encode);
+    else for (unsigned int s = 0; s < header.stripeCount; s++) encode(s);
+
+    size_t pos = 0;
+    for (unsigned int s = 0; s < header.stripeCount; s++) {
+        size_t bytes = sizes[s] & ~STRIPE_RAW;
+        memmove(base + pos, base + s * STRIPE_MAX(stripePixels), bytes);
+        pos += bytes;
+    }
+    memcpy(&out[0], &header, sizeof(header));
+    memcpy(&out[sizeof(header)], &sizes[0], header.stripeCount * 4);
+    out.resize(dataStart + pos);
+    return true;
+}
+
+bool FXCodec::Decode(const unsigned char* data, size_t size, unsigned char* rgba, FXWorkerPool* pool) {
+    unsigned int width, height;
+    if (!Info(data, size, width, height)) return false;
+
+    FXCODECHEADER header;
+    memcpy(&header, data, sizeof(header));
+    vector<uint32_t> sizes(header.stripeCount);
+    memcpy(&sizes[0], data + sizeof(header), header.stripeCount * 4);
+
+    // stripe start offsets, checked against the data we actually have
+    vector<size_t> starts(header.stripeCount);
+    size_t pos = sizeof(header) + header.stripeCount * 4;
+    for (unsigned int s = 0; s < header.stripeCount; s++) {
+        starts[s] = pos;
+        pos += sizes[s] & ~STRIPE_RAW;
+        if (pos > size) return false;
+    }
+
+    size_t stripePixels = (size_t)width * header.stripeRows;
+    std::atomic<bool> ok(true);
+    auto decode = [&](int s) {
+        unsigned int rows = min((unsigned int)header.stripeRows, height - s * header.stripeRows);
+        unsigned char* out = rgba + (size_t)s * stripePixels * 4;
+        if (sizes[s] & STRIPE_RAW) {
+            size_t raw = (size_t)width * rows * 4;
+            if ((sizes[s] & ~STRIPE_RAW) != raw) ok = false;
+            else memcpy(out, data + starts[s], raw);
+        }else if (!DecodeStripe(data + starts[s], sizes[s], out, (size_t)width * rows)) {
+            ok = false;
+        }
+    };
+    if (pool) pool->Run(header.stripeCount, decode);
+    else for (unsigned int s = 0; s < header.stripeCount; s++) decode(s);
+    return ok;
+}
+
+bool FXCodec::Decode(const unsigned char* data, size_t size, vector<unsigned char>& rgba,
+                     unsigned int& width, unsigned int& height, FXWorkerPool* pool) {
+    if (!Info(data, size, width, height)) return false;
+    rgba.resize((size_t)width * height * 4);
+    return Decode(data, size, &rgba[0], pool);
+}
+
+bool FXCodec::SaveImage(string filename, const unsigned char* rgba, unsigned int width, unsigned int height,
+                        FXWorkerPool* pool) {
+    vector<unsigned char> packed;
+    if (!Encode(rgba, width, height, packed, pool)) return false;
+
+    FILE* f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&packed[0], 1, packed.size(), f) == packed.size();
+    return (fclose(f) == 0) && ok;
+}
+
+bool FXCodec::LoadImage(string filename, vector<unsigned char>& rgba, unsigned int& width, unsigned int& height,
+                        FXWorkerPool* pool) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    vector<unsigned char> packed;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size > 0) {
+        packed.resize(size);
+        if (fread(&packed[0], 1, size, f) != (size_t)size) packed.clear();
+    }
+    fclose(f);
+    return !packed.empty() && Decode(&packed[0], packed.size(), rgba, width, height, pool);
+}
@@ -0,0 +1,73 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Lossless frame codec (.fxq)
+
+    QOI style encoding (index/diff/luma/run ops, see https://qoiformat.org) so it costs about
+    the same to encode as to memcpy the frame a few times, but the image is cut into stripes
+    of FXCODEC_STRIPE_ROWS rows that are coded independently, so every stripe of a frame can
+    be encoded and decoded on a different core (pass a FXWorkerPool). Runs are found/filled
+    4 pixels at a time with SSE2 when the compiler has it, scalar otherwise.
+
+    Typical output is 4-10x smaller than raw RGBA, noisy video less so.
+    Only 4 byte RGBA is handled, anything else is written raw by the callers.
+
+    File layout, little endian:
+        FXCODECHEADER
+        uint32 stripe sizes[stripeCount]    top bit set = stripe stored raw (it didn't compress)
+        stripe data back to back
+*/
+
+#ifndef FXCODEC_H
+#define FXCODEC_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "fxpluginstructures.h"
+
+class FXWorkerPool;
+
+#define FXCODEC_MAGIC "FXQ1"
+#define FXCODEC_STRIPE_ROWS 64
+
+// what DumpFBO/SaveRawImage write, and the codec field of recorded frames
+enum FXIMAGEFORMAT {
+    FXIMAGE_RAW = 0,            // raw bytes, no header
+    FXIMAGE_FXQ = 1             // see above
+};
+
+struct FXCODECHEADER {
+    char magic[4];
+    uint32_t width, height;
+    uint16_t channels;
+    uint16_t stripeRows;
+    uint32_t stripeCount;
+};
+
+class FXCodec
+{
+    public:
+        // out is resized to fit, reuse it between frames to save the allocation
+        static bool Encode(const unsigned char* rgba, unsigned int width, unsigned int height,
+                           vector<unsigned char>& out, FXWorkerPool* pool = 0);
+
+        // rgba must hold width*height*4 (see Info)
+        static bool Decode(const unsigned char* data, size_t size, unsigned char* rgba, FXWorkerPool* pool = 0);
+        static bool Decode(const unsigned char* data, size_t size, vector<unsigned char>& rgba,
+                           unsigned int& width, unsigned int& height, FXWorkerPool* pool = 0);
+
+        static bool Info(const unsigned char* data, size_t size, unsigned int& width, unsigned int& height);
+
+        static bool SaveImage(string filename, const unsigned char* rgba, unsigned int width, unsigned int height,
+                              FXWorkerPool* pool = 0);
+        static bool LoadImage(string filename, vector<unsigned char>& rgba, unsigned int& width, unsigned int& height,
+                              FXWorkerPool* pool = 0);
+    protected:
+    private:
+        static size_t EncodeStripe(const unsigned char* in, size_t pixels, unsigned char* out);
+        static bool DecodeStripe(const unsigned char* in, size_t size, unsigned char* out, size_t pixels);
+};
+
+#endif // FXCODEC_H
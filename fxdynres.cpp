@@ -0,0 +1,157 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Dynamic resolution (see fxdynres.h)
+*/
+
+#include "fxdynres.h"
+
+#include <string.h>
+
+FXDynamicResolution::FXDynamicResolution() {
+    memset(queries, 0, sizeof(queries));
+    created = false;
+    next = 0;
+    open = -1;
+    budgetMs = 0.0;
+    minScale = 0.5f;
+    step = 0.125f;
+    scale = 1.0f;
+    downAt = 1.0f;
+    upAt = 0.8f;
+    holdFrames = 30;
+    under = settled = 0;
+    lastMs = -1.0;
+    averageMs = 0.0;
+    samples = skipped = changes = 0;
+}
+
+FXDynamicResolution::~FXDynamicResolution() {
+    // empty, queries are released in Deinit while the context is still current
+}
+
+void FXDynamicResolution::Init(double ms, float lowest, float s) {
+    Deinit();
+    budgetMs = ms;
+    minScale = lowest > 0.0f ? min(lowest, 1.0f) : 0.5f;
+    step = s > 0.0f ? s : 0.125f;
+}
+
+void FXDynamicResolution::Deinit() {
+    if (created) {
+        for (int i = 0; i < FXDYNRES_QUERIES; i++) {
+            glDeleteQueries(1, &queries[i].start);
+            glDeleteQueries(1, &queries[i].end);
+        }
+    }
+    memset(queries, 0, sizeof(queries));
+    created = false;
+    next = 0;
+    open = -1;
+    budgetMs = 0.0;
+    scale = 1.0f;
+    under = settled = 0;
+    lastMs = -1.0;
+    averageMs = 0.0;
+    samples = skipped = changes = 0;
+}
+
+void FXDynamicResolution::SetHysteresis(float down, float up, int hold) {
+    downAt = down;
+    upAt = min(up, down);
+    holdFrames = max(hold, 1);
+}
+
+void FXDynamicResolution::Begin() {
+    if (!Enabled()) return;
+    if (!created) {
+        for (int i = 0; i < FXDYNRES_QUERIES; i++) {
+            glGenQueries(1, &queries[i].start);
+            glGenQueries(1, &queries[i].end);
+        }
+        created = true;
+    }
+    // still in flight, waiting on it would be the stall this is here to avoid
+    if (queries[next].pending) {
+        skipped++;
+        return;
+    }
+    glQueryCounter(queries[next].start, GL_TIMESTAMP);
+    open = next;
+}
+
+void FXDynamicResolution::End() {
+    if (open < 0) return;
+    Query& q = queries[open];
+    glQueryCounter(q.end, GL_TIMESTAMP);
+    q.scale = scale;
+    q.pending = true;
+    next = (open + 1) % FXDYNRES_QUERIES;
+    open = -1;
+}
+
+bool FXDynamicResolution::Update() {
+    if (!created) return false;
+    bool moved = false;
+    // oldest first, the first one not done means the rest aren't either
+    for (int k = 0; k < FXDYNRES_QUERIES; k++) {
+        Query& q = queries[(next + k) % FXDYNRES_QUERIES];
+        if (!q.pending) continue;
+        GLint ready = 0;
+        glGetQueryObjectiv(q.end, GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) break;
+        GLuint64 t0 = 0, t1 = 0;
+        glGetQueryObjectui64v(q.start, GL_QUERY_RESULT, &t0);
+        glGetQueryObjectui64v(q.end, GL_QUERY_RESULT, &t1);
+        q.pending = false;
+        lastMs = (double)(t1 - t0) / 1E6;
+        samples++;
+        // drawn at a scale that's since changed, says nothing about this one
+        if (q.scale == scale && Sample(lastMs)) moved = true;
+    }
+    return moved;
+}
+
+bool FXDynamicResolution::Sample(double ms) {
+    averageMs = settled ? averageMs + (ms - averageMs) * FXDYNRES_SMOOTHING : ms;
+    settled++;
+    if (settled < FXDYNRES_SETTLE) return false;
+
+    if (averageMs > budgetMs * downAt && scale > minScale) {
+        // cost goes with the pixels (scale^2), aim for where going back up would start
+        float target = scale * (float)sqrt(budgetMs * upAt / averageMs);
+        float s = 1.0f - ceil((1.0f - target) / step - 0.001f) * step;
+        return SetScale(max(minScale, min(s, scale - step)));
+    }
+
+    float up = min(1.0f, scale + step);
+    if (up > scale && averageMs * (up * up) / (scale * scale) < budgetMs * upAt) {
+        if (++under >= holdFrames) return SetScale(up);
+    }else {
+        under = 0;
+    }
+    return false;
+}
+
+bool FXDynamicResolution::SetScale(float s) {
+    if (s == scale) return false;
+    scale = s;
+    settled = 0;
+    under = 0;
+    changes++;
+    return true;
+}
+
+FXDYNRESSTATS FXDynamicResolution::Stats() {
+    FXDYNRESSTATS s;
+    s.scale = scale;
+    s.minScale = minScale;
+    s.budgetMs = budgetMs;
+    s.lastMs = lastMs;
+    s.averageMs = averageMs;
+    s.samples = samples;
+    s.skipped = skipped;
+    s.changes = changes;
+    return s;
+}
@@ -0,0 +1,134 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Dynamic resolution
+
+    A plugin that is over budget at 4K stalls the whole output, not just itself. FXDynamicResolution
+    times the GPU work of each Process and when the moving average goes over a budget the expensive
+    passes are drawn smaller and upscaled into the output:
+
+        timing  a GL_TIMESTAMP pair per frame (GL_TIME_ELAPSED can't nest and the host may already
+                have one open around Process), a ring of FXDYNRES_QUERIES read back once they are
+                available, a frame is skipped rather than waited on if every one is still in flight
+        scale   steps of 1/8 down to minScale, pixels go with scale^2 so a big overshoot drops more
+                than one step at once, times measured at an old scale are thrown away
+        recover one step up at a time, only after holdFrames samples in a row predict the next step
+                is under upAt x budget (the gap between downAt and upAt stops it flip flopping)
+
+    The smaller image is a render graph Texture() (graph.Resize, bottom left of a host buffer sized
+    from outputBuffer.width/height, so no extra memory) and the upscale is a Catmull-Rom bicubic in
+    5 bilinear taps (FXDYNRES_UPSCALE_GLSL, the 4 corner taps of the 9 tap version hardly weigh
+    anything), sharper than a plain linear stretch.
+    The scale/timings are exported to the host for instrumentation (DynamicResolution in main.cpp,
+    fxhost prints them).
+
+    usage (see ApplyDynamicResolution/ProcessUpscale in pluginprivateobject.cpp):
+        InitPlugin:     dynres.Init(8.0);           // ms of GPU per frame, before CreateShaders
+        Process:        ApplyDynamicResolution(); dynres.Begin(); graph.Execute(fx, gl); dynres.End();
+        passes:         draw to g.TargetWidth()/TargetHeight(), not the output size
+        Deinit:         dynres.Deinit();
+*/
+
+#ifndef FXDYNRES_H
+#define FXDYNRES_H
+
+#include "fxpluginstructures.h"
+
+#define FXDYNRES_QUERIES 4              // frames in flight before one goes untimed
+#define FXDYNRES_SMOOTHING 0.2          // moving average weight of each new time
+#define FXDYNRES_SETTLE 4               // samples at a new scale before it can move again
+
+// shared with the host (see DynamicResolution in main.cpp)
+struct FXDYNRESSTATS {
+    float scale;                // current scale of the output size
+    float minScale;
+    double budgetMs;
+    double lastMs;              // last GPU time read back (-1 before the first)
+    double averageMs;           // moving average at the current scale
+    long samples;               // times read back
+    long skipped;               // frames not timed, every query was still in flight
+    long changes;               // scale steps so far
+};
+
+// #version 120 with 000-1TextureVert, draw the quad with the texture's tx2/ty2
+// fxUpscale = texture width, height, tx2, ty2 (the image is sampled inside tx2/ty2 only)
+#define FXDYNRES_UPSCALE_GLSL \
+    "#version 120\n" \
+    "uniform sampler2D fxUpscaleTex;\n" \
+    "uniform float fxUpscale[4];\n" \
+    "void main(){\n" \
+    "  vec2 size = vec2(fxUpscale[0], fxUpscale[1]);\n" \
+    "  vec2 lo = 0.5 / size;\n" \
+    "  vec2 hi = vec2(fxUpscale[2], fxUpscale[3]) - lo;\n" \
+    "  vec2 p = gl_TexCoord[0].st * size;\n" \
+    "  vec2 p1 = floor(p - 0.5) + 0.5;\n" \
+    "  vec2 f = p - p1;\n" \
+    "  vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));\n" \
+    "  vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);\n" \
+    "  vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));\n" \
+    "  vec2 w3 = f * f * (-0.5 + 0.5 * f);\n" \
+    "  vec2 w12 = w1 + w2;\n" \
+    "  vec2 t0 = clamp((p1 - 1.0) / size, lo, hi);\n" \
+    "  vec2 t12 = clamp((p1 + w2 / w12) / size, lo, hi);\n" \
+    "  vec2 t3 = clamp((p1 + 2.0) / size, lo, hi);\n" \
+    "  vec4 c = texture2D(fxUpscaleTex, vec2(t12.x, t0.y)) * (w12.x * w0.y)\n" \
+    "         + texture2D(fxUpscaleTex, vec2(t0.x, t12.y)) * (w0.x * w12.y)\n" \
+    "         + texture2D(fxUpscaleTex, vec2(t12.x, t12.y)) * (w12.x * w12.y)\n" \
+    "         + texture2D(fxUpscaleTex, vec2(t3.x, t12.y)) * (w3.x * w12.y)\n" \
+    "         + texture2D(fxUpscaleTex, vec2(t12.x, t3.y)) * (w12.x * w3.y);\n" \
+    "  float w = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;\n" \
+    "  gl_FragColor = clamp(c / w, 0.0, 1.0);\n" \
+    "}\n"
+
+class FXDynamicResolution
+{
+    public:
+        FXDynamicResolution();
+        virtual ~FXDynamicResolution();
+
+        // budget in ms of GPU time per Process, 0 turns it off (queries are made on the first Begin)
+        void Init(double budgetMs, float minScale = 0.5f, float step = 0.125f);
+        void Deinit();
+        bool Enabled() { return budgetMs > 0.0; }
+        void SetBudget(double ms) { budgetMs = ms; }
+        // down once the average is over downAt x budget, up when the next step is predicted to be
+        // under upAt x budget for holdFrames samples in a row
+        void SetHysteresis(float downAt, float upAt, int holdFrames);
+
+        // around the GPU work to time
+        void Begin();
+        void End();
+        // reads back what the GPU has finished (never waits), true if the scale moved
+        bool Update();
+
+        float Scale() { return scale; }
+        int Width(int outputWidth) { return max(1, (int)(outputWidth * scale + 0.5f)); }
+        int Height(int outputHeight) { return max(1, (int)(outputHeight * scale + 0.5f)); }
+        FXDYNRESSTATS Stats();
+    protected:
+    private:
+        struct Query {
+            GLuint start, end;
+            float scale;                // what it was drawn at
+            bool pending;
+        };
+
+        Query queries[FXDYNRES_QUERIES];
+        bool created;
+        int next;                       // slot Begin writes (also the oldest pending)
+        int open;                       // slot between Begin and End, -1 if none
+        double budgetMs;
+        float minScale, step, scale;
+        float downAt, upAt;
+        int holdFrames;
+        int under;                      // samples in a row the next step up would fit
+        int settled;                    // samples at the current scale
+        double lastMs, averageMs;
+        long samples, skipped, changes;
+
+        bool Sample(double ms);
+        bool SetScale(float s);
+};
+
+#endif // FXDYNRES_H
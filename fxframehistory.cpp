@@ -0,0 +1,197 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Frame history (see fxframehistory.h)
+*/
+
+#include "fxframehistory.h"
+
+#include <cmath>
+
+FXFrameHistory::FXFrameHistory() {
+    requested = depth = 0;
+    scale = 1.0f;
+    format = FXHISTORY_RGBA8;
+    layout = FXHISTORY_ATLAS;
+    width = height = 0;
+    columns = rows = 1;
+    head = -1;
+    filled = 0;
+    sourceWidth = sourceHeight = 0;
+    texture = 0;
+    readFBO = writeFBO = 0;
+    for (int i = 0; i < FXFRAMEHISTORY_FLOATS; i++) values[i] = 0;
+}
+
+FXFrameHistory::~FXFrameHistory() {
+    // empty, GL objects are released in Deinit while the context is still current
+}
+
+void FXFrameHistory::Init(int d, float s, FXHISTORYFORMAT f, FXHISTORYLAYOUT l) {
+    Deinit();
+    requested = depth = max(d, 1);
+    scale = s > 0.0f ? min(s, 1.0f) : 1.0f;
+    format = f;
+    error = "";
+
+    // GL_MAX_ARRAY_TEXTURE_LAYERS is an invalid enum (and leaves 0) without texture arrays
+    while (glGetError() != GL_NO_ERROR) {}
+    GLint layers = 0;
+    if (l != FXHISTORY_ATLAS) glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers);
+    while (glGetError() != GL_NO_ERROR) {}
+    layout = layers >= depth ? FXHISTORY_ARRAY : FXHISTORY_ATLAS;
+    if (l == FXHISTORY_ARRAY && layout != FXHISTORY_ARRAY) error = "no texture arrays for this depth, using an atlas";
+}
+
+void FXFrameHistory::Deinit() {
+    Release();
+    requested = depth = 0;
+}
+
+void FXFrameHistory::Release() {
+    if (texture) glDeleteTextures(1, &texture);
+    if (readFBO) glDeleteFramebuffers(1, &readFBO);
+    if (writeFBO) glDeleteFramebuffers(1, &writeFBO);
+    texture = 0;
+    readFBO = writeFBO = 0;
+    width = height = 0;
+    sourceWidth = sourceHeight = 0;
+    Clear();
+}
+
+bool FXFrameHistory::Create(int pushedWidth, int pushedHeight, FXGLState* gl) {
+    width = max(1, (int)(pushedWidth * scale + 0.5f));
+    height = max(1, (int)(pushedHeight * scale + 0.5f));
+    columns = rows = 1;
+    depth = requested;
+
+    if (layout == FXHISTORY_ATLAS) {
+        // roughly square, within the biggest texture (fewer frames if even that won't hold them)
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        int fitX = max(1, (int)maxSize / width);
+        int fitY = max(1, (int)maxSize / height);
+        columns = min(min(depth, fitX), max(1, (int)ceil(sqrt((double)depth * height / width))));
+        rows = (depth + columns - 1) / columns;
+        if (rows > fitY) {
+            columns = min(depth, fitX);
+            rows = min(fitY, (depth + columns - 1) / columns);
+            depth = min(depth, columns * rows);
+            error = "atlas only holds " + to_string(depth) + " frames at this size";
+        }
+    }
+
+    glGenFramebuffers(1, &readFBO);
+    glGenFramebuffers(1, &writeFBO);
+    if (!Allocate(format, gl)) {
+        if (format == FXHISTORY_RGBA8 || !Allocate(FXHISTORY_RGBA8, gl)) {
+            error = "can't render to the history texture";
+            return false;
+        }
+        error = "format not renderable here, using RGBA8";
+        format = FXHISTORY_RGBA8;
+    }
+    sourceWidth = pushedWidth;
+    sourceHeight = pushedHeight;
+    return true;
+}
+
+bool FXFrameHistory::Allocate(FXHISTORYFORMAT f, FXGLState* gl) {
+    GLint internal = GL_RGBA8;
+    GLenum layoutFormat = GL_RGBA, type = GL_UNSIGNED_BYTE;
+    if (f == FXHISTORY_RGB565) { internal = GL_RGB565; layoutFormat = GL_RGB; type = GL_UNSIGNED_SHORT_5_6_5; }
+    else if (f == FXHISTORY_R11G11B10F) { internal = GL_R11F_G11F_B10F; layoutFormat = GL_RGB; type = GL_FLOAT; }
+    else if (f == FXHISTORY_R8) { internal = GL_R8; layoutFormat = GL_RED; }
+
+    if (texture) glDeleteTextures(1, &texture);
+    glGenTextures(1, &texture);
+    GLenum target = Target();
+    // 2D binds on the active unit go through the tracker (arrays aren't tracked)
+    if (gl && target == GL_TEXTURE_2D) gl->BindTexture2D(texture);
+    else glBindTexture(target, texture);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (f == FXHISTORY_R8) {
+        // grey rather than red (GL 3.3/ARB_texture_swizzle, red if not)
+        glTexParameteri(target, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(target, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        while (glGetError() != GL_NO_ERROR) {}
+    }
+    if (layout == FXHISTORY_ARRAY) glTexImage3D(target, 0, internal, width, height, depth, 0, layoutFormat, type, 0);
+    else glTexImage2D(target, 0, internal, columns * width, rows * height, 0, layoutFormat, type, 0);
+    if (gl && target == GL_TEXTURE_2D) gl->BindTexture2D(0);
+    else glBindTexture(target, 0);
+
+    if (gl) gl->BindFramebuffer(writeFBO);
+    else glBindFramebuffer(GL_FRAMEBUFFER, writeFBO);
+    if (layout == FXHISTORY_ARRAY) glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, 0);
+    else glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (gl) gl->BindFramebuffer(0);
+    else glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return ok;
+}
+
+bool FXFrameHistory::Push(GLuint source, int w, int h, FXGLState* gl) {
+    if (!depth || !source || w < 1 || h < 1) return false;
+    if (w != sourceWidth || h != sourceHeight) {
+        Release();
+        if (!Create(w, h, gl)) return false;
+    }
+
+    head = (head + 1) % depth;
+    filled = min(filled + 1, depth);
+
+    // the tracker only knows GL_FRAMEBUFFER, so both go to writeFBO through it and the read
+    // side is moved on raw, binding 0 through it afterwards puts both back
+    if (gl) gl->BindFramebuffer(writeFBO);
+    else glBindFramebuffer(GL_FRAMEBUFFER, writeFBO);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+    int x = 0, y = 0;
+    if (layout == FXHISTORY_ARRAY) glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, head);
+    else {
+        x = (head % columns) * width;
+        y = (head / columns) * height;
+    }
+    if (gl) gl->Disable(GL_SCISSOR_TEST);
+    else glDisable(GL_SCISSOR_TEST);
+    glBlitFramebuffer(0, 0, w, h, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT,
+        (w == width && h == height) ? GL_NEAREST : GL_LINEAR);
+    if (gl) gl->BindFramebuffer(0);
+    else glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void FXFrameHistory::Bind(int unit, FXGLState* gl) {
+    if (gl) {
+        gl->ActiveTexture(GL_TEXTURE0 + unit);
+        if (layout == FXHISTORY_ARRAY) glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        else gl->BindTexture2D(texture);
+        gl->ActiveTexture(GL_TEXTURE0);
+    }else{
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(Target(), texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
+
+const float* FXFrameHistory::Values() {
+    values[0] = (float)max(head, 0);
+    values[1] = (float)max(depth, 1);
+    values[2] = (float)filled;
+    values[3] = (float)columns;
+    values[4] = (float)rows;
+    values[5] = width ? 0.5f / (columns * width) : 0.0f;
+    values[6] = height ? 0.5f / (rows * height) : 0.0f;
+    return values;
+}
+
+long long FXFrameHistory::Bytes() {
+    const int bytes[4] = {4, 2, 4, 1};
+    long long slots = layout == FXHISTORY_ARRAY ? depth : columns * rows;
+    return (long long)width * height * slots * bytes[format];
+}
@@ -0,0 +1,134 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Frame history
+
+    Echo/delay/feedback effects want the last n frames, the requestedBuffers only go to
+    MAXFXFBOBUFFERS (3) and are full size. FXFrameHistory keeps a ring of its own instead:
+
+        layout  a 2D texture array (GL 3.0 / EXT_texture_array), one layer per frame, or an
+                atlas of tiles in one 2D texture where there are no arrays (or too few layers)
+        size    any depth, at a scale of the pushed frame (0.5 = a quarter of the memory)
+        format  RGBA8, RGB565 (half), R11G11B10F (no alpha, float) or R8 (red only, reads as grey),
+                RGBA8 if the driver can't render to the one asked for
+
+    Push blits (and scales) a texture into the next slot, nothing is copied on the CPU and nothing
+    ever moves, the shader gets the newest slot as a uniform and counts back from it. Memory is
+    fixed when the first frame comes in (Bytes()), 32 frames of 1080p at half size in RGB565 is 33MB.
+    Push before drawing and age 0 is this frame (echo of the input), after and it's the last one
+    drawn (feedback). A different pushed size starts the ring again.
+
+    usage (see CreateFrameHistoryParams/ApplyFrameHistory in pluginprivateobject.cpp):
+        CreateShaders:  history.Init(32, 0.5f, FXHISTORY_RGB565);   // context current, picks the layout
+                        frag text = "#version 120\n" + history.GLSL() + ...; CreateFrameHistoryParams(id);
+        Process:        history.Push(fx->source[0].id, w, h, gl); (w/h the image, not the texture)
+                        ApplyFrameHistory(); before uniforms.Apply()
+        Deinit:         history.Deinit();
+    shader:
+        vec4 c = fxHistoryFrame(uv, age);       // uv 0-1, age 0 newest .. fxHistoryFrames()-1 oldest
+*/
+
+#ifndef FXFRAMEHISTORY_H
+#define FXFRAMEHISTORY_H
+
+#include "fxpluginstructures.h"
+#include "fxglstate.h"
+
+#define FXFRAMEHISTORY_UNIT 13          // texture unit ApplyFrameHistory binds to (clear of the mixer and audio history)
+#define FXFRAMEHISTORY_FLOATS 7
+
+enum FXHISTORYLAYOUT {
+    FXHISTORY_AUTO,
+    FXHISTORY_ARRAY,
+    FXHISTORY_ATLAS
+};
+
+enum FXHISTORYFORMAT {
+    FXHISTORY_RGBA8,
+    FXHISTORY_RGB565,
+    FXHISTORY_R11G11B10F,
+    FXHISTORY_R8
+};
+
+// fxHistory[0] newest slot, [1] depth, [2] frames held, [3-4] atlas columns/rows, [5-6] half an atlas texel
+#define FXFRAMEHISTORY_GLSL_COMMON \
+    "uniform float fxHistory[7];\n" \
+    "float fxHistoryFrames() { return fxHistory[2]; }\n" \
+    "float fxHistorySlot(float age) {\n" \
+    "  float s = fxHistory[0] - clamp(floor(age + 0.5), 0.0, max(fxHistory[2] - 1.0, 0.0));\n" \
+    "  return s < 0.0 ? s + fxHistory[1] : s;\n" \
+    "}\n"
+
+#define FXFRAMEHISTORY_GLSL_ARRAY \
+    "#extension GL_EXT_texture_array : enable\n" \
+    "uniform sampler2DArray fxHistoryTex;\n" \
+    FXFRAMEHISTORY_GLSL_COMMON \
+    "vec4 fxHistoryFrame(vec2 uv, float age) { return texture2DArray(fxHistoryTex, vec3(uv, fxHistorySlot(age))); }\n"
+
+#define FXFRAMEHISTORY_GLSL_ATLAS \
+    "uniform sampler2D fxHistoryTex;\n" \
+    FXFRAMEHISTORY_GLSL_COMMON \
+    "vec4 fxHistoryFrame(vec2 uv, float age) {\n" \
+    "  float s = fxHistorySlot(age);\n" \
+    "  float row = floor((s + 0.5) / fxHistory[3]);\n" \
+    "  vec2 tile = vec2(s - row * fxHistory[3], row);\n" \
+    "  vec2 grid = vec2(fxHistory[3], fxHistory[4]);\n" \
+    "  vec2 inset = vec2(fxHistory[5], fxHistory[6]);\n" \
+    "  vec2 p = clamp((tile + uv) / grid, tile / grid + inset, (tile + 1.0) / grid - inset);\n" \
+    "  return texture2D(fxHistoryTex, p);\n" \
+    "}\n"
+
+class FXFrameHistory
+{
+    public:
+        FXFrameHistory();
+        virtual ~FXFrameHistory();
+
+        // picks the layout (context current), the texture is made on the first Push
+        void Init(int depth, float scale = 1.0f, FXHISTORYFORMAT format = FXHISTORY_RGBA8, FXHISTORYLAYOUT layout = FXHISTORY_AUTO);
+        void Deinit();
+
+        // blits width x height of texture (bottom left) in as the newest frame
+        bool Push(GLuint texture, int width, int height, FXGLState* gl = 0);
+        void Bind(int unit, FXGLState* gl = 0);
+        // forget the frames held, the memory stays
+        void Clear() { head = -1; filled = 0; }
+
+        // the shader functions for the layout in use
+        const char* GLSL() { return layout == FXHISTORY_ARRAY ? FXFRAMEHISTORY_GLSL_ARRAY : FXFRAMEHISTORY_GLSL_ATLAS; }
+        const float* Values();
+
+        FXHISTORYLAYOUT Layout() { return layout; }
+        FXHISTORYFORMAT Format() { return format; }
+        int Depth() { return depth; }
+        int Frames() { return filled; }
+        int Width() { return width; }
+        int Height() { return height; }
+        long long Bytes();
+        GLuint Texture() { return texture; }
+        string Error() { return error; }
+    protected:
+    private:
+        int requested;                  // Init depth (an atlas may hold fewer)
+        int depth;
+        float scale;
+        FXHISTORYFORMAT format;
+        FXHISTORYLAYOUT layout;
+        int width, height;              // one frame
+        int columns, rows;              // atlas
+        int head;                       // slot written last
+        int filled;
+        int sourceWidth, sourceHeight;  // pushed size the texture was made for
+        GLuint texture;
+        GLuint readFBO, writeFBO;
+        string error;
+        float values[FXFRAMEHISTORY_FLOATS];
+
+        bool Create(int pushedWidth, int pushedHeight, FXGLState* gl);
+        bool Allocate(FXHISTORYFORMAT f, FXGLState* gl);
+        void Release();
+        GLenum Target() { return layout == FXHISTORY_ARRAY ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D; }
+};
+
+#endif // FXFRAMEHISTORY_H
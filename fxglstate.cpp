@@ -0,0 +1,169 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    GL state tracker (see fxglstate.h)
+*/
+
+#include "fxglstate.h"
+#include "fxresources.h"
+
+FXGLState* FXGLState::Acquire() {
+    return FXResourceRegistry::Acquire<FXGLState>("FXGLState", []{ return new FXGLState(); }, [](FXGLState* s){ delete s; });
+}
+
+void FXGLState::Release(FXGLState* state) {
+    FXResourceRegistry::Release(state);
+}
+
+FXGLState::FXGLState() {
+    depth = 0;
+    Invalidate();
+}
+
+FXGLState::~FXGLState() {
+    // empty
+}
+
+/**
+    forget everything, what is bound included (End() then always puts the defaults back)
+*/
+void FXGLState::Invalidate() {
+    framebuffer = UNKNOWN;
+    program = UNKNOWN;
+    activeUnit = UNKNOWN;
+
+    viewportKnown = false;
+    orthoKnown = false;
+    clearColorKnown = false;
+    modelviewIdentity = UNKNOWN;
+    matrixMode = UNKNOWN;
+    for (int i = 0; i < CAP_COUNT; i++) caps[i] = UNKNOWN;
+    for (int i = 0; i < FXGLSTATE_TEXUNITS; i++) {
+        texture2DEnabled[i] = UNKNOWN;
+        textures[i] = UNKNOWN;
+    }
+}
+
+// the host defaults are only known to be in place here
+void FXGLState::Begin() {
+    if (depth++ > 0) return;
+    Invalidate();
+    framebuffer = 0;
+    program = 0;
+    activeUnit = GL_TEXTURE0;
+}
+
+void FXGLState::End() {
+    if (depth == 0 || --depth > 0) return;
+
+    // put back only what we changed
+    if (program != 0) glUseProgram(0);
+    if (framebuffer != 0) glBindFramebuffer(GL_FRAMEBUFFER_EXT, 0);
+    if (activeUnit != GL_TEXTURE0) glActiveTexture(GL_TEXTURE0);
+
+    program = 0;
+    framebuffer = 0;
+    activeUnit = GL_TEXTURE0;
+}
+
+void FXGLState::BindFramebuffer(GLuint fbo) {
+    if (depth && framebuffer == (long)fbo) return;
+    glBindFramebuffer(GL_FRAMEBUFFER_EXT, fbo);
+    framebuffer = fbo;
+}
+
+void FXGLState::Viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    if (depth && viewportKnown && viewport[0] == x && viewport[1] == y && viewport[2] == w && viewport[3] == h) return;
+    glViewport(x, y, w, h);
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = w;
+    viewport[3] = h;
+    viewportKnown = true;
+}
+
+void FXGLState::MatrixMode(GLenum mode) {
+    if (depth && matrixMode == (long)mode) return;
+    glMatrixMode(mode);
+    matrixMode = mode;
+}
+
+void FXGLState::Ortho2D(float width, float height) {
+    if (depth && orthoKnown && ortho[0] == width && ortho[1] == height) return;
+    MatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0f, width, 0.0f, height, -1.0f, 1.0f);
+    ortho[0] = width;
+    ortho[1] = height;
+    orthoKnown = true;
+}
+
+void FXGLState::ModelviewIdentity() {
+    if (depth && modelviewIdentity == 1) return;
+    MatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    modelviewIdentity = 1;
+}
+
+void FXGLState::SetCap(GLenum cap, bool on) {
+    int* tracked = 0;
+    if (cap == GL_DEPTH_TEST) tracked = &caps[CAP_DEPTH];
+    else if (cap == GL_SCISSOR_TEST) tracked = &caps[CAP_SCISSOR];
+    else if (cap == GL_BLEND) tracked = &caps[CAP_BLEND];
+    else if (cap == GL_TEXTURE_2D) {
+        unsigned int unit = activeUnit - GL_TEXTURE0;
+        if (unit < FXGLSTATE_TEXUNITS) tracked = &texture2DEnabled[unit];
+    }
+
+    if (depth && tracked && *tracked == (int)on) return;
+    if (on) glEnable(cap);
+    else glDisable(cap);
+    if (tracked) *tracked = on;
+}
+
+void FXGLState::Enable(GLenum cap) {
+    SetCap(cap, true);
+}
+
+void FXGLState::Disable(GLenum cap) {
+    SetCap(cap, false);
+}
+
+void FXGLState::ClearColor(float r, float g, float b, float a) {
+    if (depth && clearColorKnown && clearColor[0] == r && clearColor[1] == g && clearColor[2] == b && clearColor[3] == a) return;
+    glClearColor(r, g, b, a);
+    clearColor[0] = r;
+    clearColor[1] = g;
+    clearColor[2] = b;
+    clearColor[3] = a;
+    clearColorKnown = true;
+}
+
+void FXGLState::UseProgram(GLuint p) {
+    if (depth && program == (long)p) return;
+    glUseProgram(p);
+    program = p;
+}
+
+void FXGLState::ActiveTexture(GLenum unit) {
+    if (depth && activeUnit == (long)unit) return;
+    glActiveTexture(unit);
+    activeUnit = unit;
+}
+
+void FXGLState::BindTexture2D(GLuint texture) {
+    unsigned int unit = activeUnit - GL_TEXTURE0;
+    if (depth && unit < FXGLSTATE_TEXUNITS && textures[unit] == (long)texture) return;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (unit < FXGLSTATE_TEXUNITS) textures[unit] = texture;
+}
+
+void FXGLState::SetupTarget(GLuint fbo, int width, int height) {
+    BindFramebuffer(fbo);
+    Viewport(0, 0, width, height);
+    Ortho2D((GLfloat)width, (GLfloat)height);
+    ModelviewIdentity();
+    Disable(GL_DEPTH_TEST);
+    Disable(GL_SCISSOR_TEST);
+}
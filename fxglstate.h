@@ -0,0 +1,85 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    GL state tracker
+
+    The helpers call GL through this so a value that is already in place is not set again
+    (eg ClearFBO followed by Process120Example on the same buffer only binds/sets up once).
+
+    Nothing is ever read back with glGet*, instead:
+    - Begin() forgets everything (the host and other plugins change state between our calls)
+      except the defaults every plugin has to leave behind (fbo 0, program 0, texture unit 0)
+    - the first set of anything after Begin() always goes through, after that it is cached
+    - End() puts back only those defaults we actually changed
+      ("if you change any global states you MUST put them back to default before exiting")
+
+    Begin/End nest, so a helper can wrap itself and still be used inside Process.
+
+    If you make raw GL calls that change any tracked state (eg glTranslatef on the modelview)
+    call Invalidate() afterwards, everything is set again on its next use, and End() puts the
+    defaults back as it can no longer tell they are still in place.
+*/
+
+#ifndef FXGLSTATE_H
+#define FXGLSTATE_H
+
+#include "fxpluginstructures.h"
+
+#define FXGLSTATE_TEXUNITS 16
+
+class FXGLState
+{
+    public:
+        // one tracker per process (plugins render in the host context)
+        static FXGLState* Acquire();
+        static void Release(FXGLState* state);
+
+        void Begin();
+        void End();
+        void Invalidate();
+
+        void BindFramebuffer(GLuint fbo);
+        void Viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+        void Ortho2D(float width, float height);    // projection glOrtho(0,w,0,h,-1,1)
+        void ModelviewIdentity();
+        void Enable(GLenum cap);
+        void Disable(GLenum cap);
+        void ClearColor(float r, float g, float b, float a);
+        void UseProgram(GLuint program);
+        void ActiveTexture(GLenum unit);
+        void BindTexture2D(GLuint texture);         // on the active unit
+
+        // bind + viewport + ortho + identity modelview + no depth/scissor (the usual 2D pass setup)
+        void SetupTarget(GLuint fbo, int width, int height);
+    protected:
+    private:
+        FXGLState();
+        virtual ~FXGLState();
+
+        // tri-state so unknown values always get set the first time
+        enum { UNKNOWN = -1 };
+        enum { CAP_DEPTH, CAP_SCISSOR, CAP_BLEND, CAP_COUNT };
+
+        int depth;                              // Begin/End nesting
+
+        long framebuffer;
+        GLint viewport[4];
+        bool viewportKnown;
+        float ortho[2];
+        bool orthoKnown;
+        int modelviewIdentity;
+        long matrixMode;
+        int caps[CAP_COUNT];
+        int texture2DEnabled[FXGLSTATE_TEXUNITS];
+        float clearColor[4];
+        bool clearColorKnown;
+        long program;
+        long activeUnit;
+        long textures[FXGLSTATE_TEXUNITS];
+
+        void SetCap(GLenum cap, bool on);
+        void MatrixMode(GLenum mode);
+};
+
+#endif // FXGLSTATE_H
@@ -0,0 +1,92 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background image writer (see fximagewriter.h)
+*/
+
+#include "fximagewriter.h"
+#include "fxworkers.h"
+
+#include <stdio.h>
+#include <string.h>
+
+FXImageWriter::FXImageWriter(int slotCount) {
+    workers = 0;
+    slots.resize(slotCount);
+    for (int i = slotCount - 1; i >= 0; i--) freeSlots.push_back(i);
+    memset(&stats, 0, sizeof(stats));
+}
+
+FXImageWriter::~FXImageWriter() {
+    Wait();
+}
+
+void FXImageWriter::Init(FXWorkerPool* pool) {
+    workers = pool;
+}
+
+bool FXImageWriter::Submit(string filename, const unsigned char* pixels, unsigned int width, unsigned int height,
+                           FXIMAGEFORMAT format) {
+    int i;
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        stats.submitted++;
+        if (!workers || freeSlots.empty()) {
+            stats.dropped++;
+            return false;
+        }
+        i = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    // the slot is ours until the job hands it back
+    Slot& s = slots[i];
+    size_t bytes = (size_t)width * height * 4;
+    if (s.pixels.size() < bytes) s.pixels.resize(bytes);
+    memcpy(&s.pixels[0], pixels, bytes);
+    s.filename = filename;
+    s.width = width;
+    s.height = height;
+    s.format = format;
+
+    workers->Submit([this, i]{
+        bool ok = Write(slots[i], workers);
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        if (ok) {
+            stats.written++;
+        }else {
+            stats.writeErrors++;
+            lastError = slots[i].filename;
+        }
+        freeSlots.push_back(i);
+        slotFreed.notify_all();
+    });
+    return true;
+}
+
+void FXImageWriter::Wait() {
+    std::unique_lock<std::mutex> lock(slotsMutex);
+    slotFreed.wait(lock, [this]{ return freeSlots.size() == slots.size(); });
+}
+
+FXIMAGEWRITERSTATS FXImageWriter::Stats() {
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    return stats;
+}
+
+string FXImageWriter::LastError() {
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    return lastError;
+}
+
+// on a worker thread
+bool FXImageWriter::Write(const Slot& s, FXWorkerPool* pool) {
+    if (s.format == FXIMAGE_FXQ) return FXCodec::SaveImage(s.filename, &s.pixels[0], s.width, s.height, pool);
+
+    FILE* f = fopen(s.filename.c_str(), "wb");
+    if (!f) return false;
+    size_t bytes = (size_t)s.width * s.height * 4;
+    bool ok = fwrite(&s.pixels[0], 1, bytes, f) == bytes;
+    return (fclose(f) == 0) && ok;
+}
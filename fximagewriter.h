@@ -0,0 +1,81 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background image writer
+
+    DumpFBO captures (from FXAsyncReadback) are copied into one of a few preallocated slots and
+    written from a job on the shared worker pool, raw or compressed with the fxcodec
+    (FXIMAGE_FXQ, stripes spread over the pool), so the render thread never encodes or touches
+    the disk. The slot buffers are kept and only grow if a bigger image comes along.
+
+    If every slot is still being written the new image is dropped and counted, the same as the
+    readback ring does when it's full. Write errors are only counted on the workers (with the
+    last filename), the render thread reports them (see ServiceReadback).
+
+    usage:
+        images.Init(workers);
+        if (!images.Submit(name, pixels, w, h, FXIMAGE_FXQ)) ...dropped
+        ...
+        images.Wait();      // before the pool is released
+*/
+
+#ifndef FXIMAGEWRITER_H
+#define FXIMAGEWRITER_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "fxpluginstructures.h"
+#include "fxcodec.h"
+
+class FXWorkerPool;
+
+#define FXIMAGEWRITER_SLOTS 4       // images being written at once
+
+struct FXIMAGEWRITERSTATS {
+    long submitted;
+    long written;
+    long dropped;               // every slot busy
+    long writeErrors;
+};
+
+class FXImageWriter
+{
+    public:
+        FXImageWriter(int slotCount = FXIMAGEWRITER_SLOTS);
+        virtual ~FXImageWriter();
+
+        void Init(FXWorkerPool* pool);
+
+        // copies the pixels (RGBA), the caller can release them straight away
+        bool Submit(string filename, const unsigned char* pixels, unsigned int width, unsigned int height,
+                    FXIMAGEFORMAT format = FXIMAGE_RAW);
+        // waits for everything submitted so far
+        void Wait();
+
+        FXIMAGEWRITERSTATS Stats();
+        // the last file that couldn't be written, for the render thread to report
+        string LastError();
+    protected:
+    private:
+        struct Slot {
+            vector<unsigned char> pixels;
+            string filename;
+            unsigned int width, height;
+            FXIMAGEFORMAT format;
+        };
+
+        FXWorkerPool* workers;
+        vector<Slot> slots;
+        vector<int> freeSlots;
+        std::mutex slotsMutex;
+        std::condition_variable slotFreed;
+        FXIMAGEWRITERSTATS stats;
+        string lastError;
+
+        static bool Write(const Slot& s, FXWorkerPool* pool);
+};
+
+#endif // FXIMAGEWRITER_H
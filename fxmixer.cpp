@@ -0,0 +1,124 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Layer mixer (see fxmixer.h)
+*/
+
+#include "fxmixer.h"
+
+#include <sstream>
+
+FXLayerMixer::FXLayerMixer() {
+    count = 0;
+    for (int i = 0; i < FXMIXER_MAXLAYERS; i++) textures[i] = 0;
+    for (int i = 0; i < FXMIXER_FLOATS; i++) values[i] = 0;
+}
+
+string FXLayerMixer::ShaderText() {
+    std::ostringstream s;
+    s << "#version 120\n"
+         "#ifndef FXMIXER_LAYERS\n"
+         "#define FXMIXER_LAYERS " << FXMIXER_MAXLAYERS << "\n"
+         "#endif\n";
+    for (int k = 0; k < FXMIXER_MAXLAYERS; k++) s << "uniform sampler2D fxLayer" << k << ";\n";
+    s << "uniform float fxMix[" << FXMIXER_FLOATS << "];\n"
+         "uniform float fxMixCount;\n"
+         // same order as FXBLENDMODE
+         "vec3 fxBlend(vec3 c, vec3 l, float mode) {\n"
+         "  if (mode < 0.5) return l;\n"
+         "  if (mode < 1.5) return min(c + l, 1.0);\n"
+         "  if (mode < 2.5) return c * l;\n"
+         "  if (mode < 3.5) return 1.0 - (1.0 - c) * (1.0 - l);\n"
+         "  if (mode < 4.5) return abs(c - l);\n"
+         "  if (mode < 5.5) return max(c, l);\n"
+         "  return min(c, l);\n"
+         "}\n"
+         // m = opacity, mode, tx2, ty2
+         "vec3 fxMixLayer(vec3 c, sampler2D t, vec4 m, vec2 uv) {\n"
+         "  vec4 l = texture2D(t, uv * m.zw);\n"
+         "  return mix(c, fxBlend(c, l.rgb, m.y), m.x * l.a);\n"
+         "}\n"
+         "void main(){\n"
+         "  vec2 uv = gl_TexCoord[0].st;\n"
+         "  vec3 c = vec3(0.0);\n";
+    for (int k = 0; k < FXMIXER_MAXLAYERS; k++) {
+        s << "#if FXMIXER_LAYERS > " << k << "\n"
+             "  if (fxMixCount > " << k << ".5) c = fxMixLayer(c, fxLayer" << k << ", vec4(fxMix[" << k * 4 << "], fxMix["
+          << k * 4 + 1 << "], fxMix[" << k * 4 + 2 << "], fxMix[" << k * 4 + 3 << "]), uv);\n"
+             "#endif\n";
+    }
+    s << "  gl_FragColor = vec4(c, 1.0);\n"
+         "}\n";
+    return s.str();
+}
+
+const char* FXLayerMixer::BlendName(FXBLENDMODE mode) {
+    static const char* names[FXBLEND_COUNT] = {"normal", "add", "multiply", "screen", "difference", "lighten", "darken"};
+    return mode >= 0 && mode < FXBLEND_COUNT ? names[mode] : "?";
+}
+
+int FXLayerMixer::MaxLayers() {
+    static int units = 0;
+    if (!units) {
+        GLint n = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &n);
+        units = n > 0 ? min((int)n, FXMIXER_MAXLAYERS) : 1;
+    }
+    return units;
+}
+
+int FXLayerMixer::AddLayer(int source, float opacity, FXBLENDMODE mode) {
+    if ((int)layers.size() >= FXMIXER_MAXLAYERS) return -1;
+    Layer l;
+    l.source = source;
+    l.opacity = opacity;
+    l.mode = mode;
+    layers.push_back(l);
+    return (int)layers.size() - 1;
+}
+
+void FXLayerMixer::SetSource(int layer, int source) {
+    if (layer >= 0 && layer < (int)layers.size()) layers[layer].source = source;
+}
+
+void FXLayerMixer::SetOpacity(int layer, float opacity) {
+    if (layer >= 0 && layer < (int)layers.size()) layers[layer].opacity = opacity;
+}
+
+void FXLayerMixer::SetBlend(int layer, FXBLENDMODE mode) {
+    if (layer >= 0 && layer < (int)layers.size()) layers[layer].mode = mode;
+}
+
+int FXLayerMixer::Gather(const FXSOURCE* sources) {
+    int units = MaxLayers();
+    count = 0;
+    for (unsigned int i = 0; i < layers.size() && count < units; i++) {
+        const Layer& l = layers[i];
+        if (l.source < 0 || l.source >= MAXFXSOURCES) continue;
+        const FXSOURCE& s = sources[l.source];
+        // not supplied, or nothing to see
+        if (!s.id || l.opacity <= 0.0f) continue;
+        textures[count] = s.id;
+        float* v = &values[count * 4];
+        v[0] = min(l.opacity, 1.0f);
+        v[1] = (float)l.mode;
+        v[2] = s.tx2 > 0 ? s.tx2 : 1.0f;
+        v[3] = s.ty2 > 0 ? s.ty2 : 1.0f;
+        count++;
+    }
+    return count;
+}
+
+void FXLayerMixer::Bind(FXGLState* gl) {
+    // top down so unit 0 is the active one after
+    for (int k = count - 1; k >= 0; k--) {
+        if (gl) {
+            gl->ActiveTexture(GL_TEXTURE0 + k);
+            gl->BindTexture2D(textures[k]);
+        }else{
+            glActiveTexture(GL_TEXTURE0 + k);
+            glBindTexture(GL_TEXTURE_2D, textures[k]);
+        }
+    }
+}
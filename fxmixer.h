@@ -0,0 +1,90 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Layer mixer
+
+    For FXPT_MIXER plugins in a bus/output slot, source[1..10] are bus A/B and their layers (see the
+    FXSOURCE notes in fxpluginstructures.h). Blending them one at a time is a full screen pass (and
+    a buffer flip) per layer, FXLayerMixer does them all in one draw instead: every layer is bound to
+    its own texture unit and ShaderText() blends them bottom to top in the fragment shader.
+
+    Layers are added in draw order (bottom first) by source index, each with an opacity and blend
+    mode. Gather() drops the ones the host hasn't supplied (id 0) or that are at 0 opacity, so the
+    rest sit packed in units 0..Count()-1 and fxMix[] (opacity, mode, tx2, ty2 per layer) and the
+    shader stops after fxMixCount of them. Normal blends use the layer's alpha, over opaque black.
+
+    The shader is unrolled (1.20 can't index a sampler array with a variable), FXMIXER_LAYERS trims
+    it, eg as an FXShaderVariants key, and is capped to the GL_MAX_TEXTURE_IMAGE_UNITS the driver has.
+    fxbench -mixer n compares the one pass against a pass per layer.
+
+    usage (see CreateMixerParams/ApplyMixer in pluginprivateobject.cpp):
+        CreateShaders:  fx->shaders[0].text = FXLayerMixer::ShaderText(); CreateMixerParams(id);
+        InitPlugin:     mixer.AddLayer(1); mixer.AddLayer(6, 0.5f, FXBLEND_SCREEN);
+        Update:         mixer.SetOpacity(1, crossfade);
+        Process:        ApplyMixer(); before uniforms.Apply(), draw the quad with 0-1 texcoords
+*/
+
+#ifndef FXMIXER_H
+#define FXMIXER_H
+
+#include <vector>
+
+#include "fxpluginstructures.h"
+#include "fxglstate.h"
+
+#define FXMIXER_MAXLAYERS 10            // source[1..10]
+#define FXMIXER_FLOATS (FXMIXER_MAXLAYERS * 4)
+
+enum FXBLENDMODE {
+    FXBLEND_NORMAL,
+    FXBLEND_ADD,
+    FXBLEND_MULTIPLY,
+    FXBLEND_SCREEN,
+    FXBLEND_DIFFERENCE,
+    FXBLEND_LIGHTEN,
+    FXBLEND_DARKEN,
+    FXBLEND_COUNT
+};
+
+class FXLayerMixer
+{
+    public:
+        FXLayerMixer();
+
+        // the frag text, #version 120 with the 0-1 texcoords in gl_TexCoord[0]
+        static string ShaderText();
+        static const char* BlendName(FXBLENDMODE mode);
+        // texture units to draw with, FXMIXER_MAXLAYERS or fewer on old drivers (context current)
+        static int MaxLayers();
+
+        // in draw order, bottom first, returns the layer index or -1 if it's full
+        int AddLayer(int source, float opacity = 1.0f, FXBLENDMODE mode = FXBLEND_NORMAL);
+        void SetSource(int layer, int source);
+        void SetOpacity(int layer, float opacity);
+        void SetBlend(int layer, FXBLENDMODE mode);
+        void ClearLayers() { layers.clear(); count = 0; }
+        int Layers() { return (int)layers.size(); }
+
+        // packs the layers that will show, returns how many (fx->source, or any FXSOURCE[])
+        int Gather(const FXSOURCE* sources);
+        int Count() { return count; }
+        GLuint Texture(int k) { return k >= 0 && k < count ? textures[k] : 0; }
+        const float* Values() { return values; }
+        // gathered layers on units 0..Count()-1, unit 0 is left active (gl = 0 binds directly)
+        void Bind(FXGLState* gl = 0);
+    protected:
+    private:
+        struct Layer {
+            int source;
+            float opacity;
+            FXBLENDMODE mode;
+        };
+
+        vector<Layer> layers;
+        int count;
+        GLuint textures[FXMIXER_MAXLAYERS];
+        float values[FXMIXER_FLOATS];
+};
+
+#endif // FXMIXER_H
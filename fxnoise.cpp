@@ -0,0 +1,682 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Noise textures (see fxnoise.h)
+*/
+
+#include "fxnoise.h"
+#include "fxresources.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FXNOISE_X86
+#include <immintrin.h>
+#endif
+
+#define BLUE_SIGMA 1.5f
+#define BLUE_RADIUS 5               // the gaussian is under 0.4% past this
+#define BLUE_INITIAL 10             // 1 in n texels set in the starting pattern
+#define BLUE_GOLDEN 0.61803398875   // frame to frame offset of the ranks
+#define WHITE_CHUNK 65536           // words a worker job
+
+FXNoise* FXNoise::Acquire() {
+    return FXResourceRegistry::Acquire<FXNoise>("FXNoise", []{ return new FXNoise(); }, [](FXNoise* n){ delete n; });
+}
+
+void FXNoise::Release(FXNoise* noise) {
+    FXResourceRegistry::Release(noise);
+}
+
+FXNoise::FXNoise() {
+    nextHandle = 0;
+    dir = DefaultDir();
+    workers = FXWorkerPool::Acquire();
+    memset(&stats, 0, sizeof(stats));
+}
+
+// handles never dropped, the context is still current in Deinit
+FXNoise::~FXNoise() {
+    for (std::map<int, Tile*>::iterator i = handles.begin(); i != handles.end(); ++i) FXResourceRegistry::Release(i->second);
+    handles.clear();
+    // waits for anything still running, the jobs only hold on to their own entry
+    FXWorkerPool::Release(workers);
+}
+
+static uint64_t Hash64(const void* data, size_t size, uint64_t h = 14695981039346656037ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
+}
+
+static uint32_t Checksum(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// mkdir -p
+static bool MakeDirs(const string& path) {
+    for (size_t i = 1; i <= path.size(); i++) {
+        if (i < path.size() && path[i] != '/') continue;
+        string part = path.substr(0, i);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    }
+    return true;
+}
+
+// lowbias32, a full avalanche 32 bit hash
+static inline uint32_t Mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+FXNOISEPARAMS FXNoise::Params(FXNOISEKIND kind, int size, int channels, int frames, uint32_t seed) {
+    FXNOISEPARAMS p;
+    p.kind = kind;
+    p.size = size;
+    p.channels = channels;
+    p.frames = frames;
+    p.seed = seed;
+    p.period = 8;
+    p.octaves = 4;
+    return p;
+}
+
+bool FXNoise::Valid(const FXNOISEPARAMS& p) {
+    if (p.size < 4 || p.size > FXNOISE_MAXSIZE || (p.size & (p.size - 1))) return false;
+    if (p.kind == FXNOISE_BLUE && p.size > FXNOISE_MAXBLUESIZE) return false;
+    if (p.channels < 1 || p.channels > 4 || p.frames < 1 || p.size * p.frames > FXNOISE_MAXSIZE) return false;
+    if (p.kind == FXNOISE_PERLIN && (p.period < 1 || p.period > p.size || p.octaves < 1)) return false;
+    return p.kind == FXNOISE_WHITE || p.kind == FXNOISE_PERLIN || p.kind == FXNOISE_BLUE;
+}
+
+// the fields one by one, never the padding, perlin's lattice only counts for perlin
+void FXNoise::Fields(const FXNOISEPARAMS& p, int32_t v[FXNOISE_FIELDS]) {
+    int32_t f[FXNOISE_FIELDS] = {FXNOISE_VERSION, p.kind, p.size, p.channels, p.frames, (int32_t)p.seed,
+                                 p.kind == FXNOISE_PERLIN ? p.period : 0, p.kind == FXNOISE_PERLIN ? p.octaves : 0};
+    memcpy(v, f, sizeof(f));
+}
+
+uint64_t FXNoise::Key(const FXNOISEPARAMS& p) {
+    int32_t v[FXNOISE_FIELDS];
+    Fields(p, v);
+    return Hash64(v, sizeof(v));
+}
+
+size_t FXNoise::Bytes(const FXNOISEPARAMS& p) {
+    return (size_t)p.size * p.size * p.frames * p.channels;
+}
+
+string FXNoise::DefaultDir() {
+    const char* d = getenv("FXNOISE_CACHE");
+    if (d) return d;
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) return string(xdg) + "/vidifold/noise";
+    const char* home = getenv("HOME");
+    return string(home ? home : "/tmp") + "/.cache/vidifold/noise";
+}
+
+//----------------------------------------------------------------------------
+
+int FXNoise::Request(const FXNOISEPARAMS& params) {
+    if (!Valid(params)) return -1;
+    uint64_t key = Key(params);
+    // the registry compares the params themselves, the hash only names the file on disk
+    int32_t fields[FXNOISE_FIELDS];
+    Fields(params, fields);
+    string d = dir;
+    FXWorkerPool* pool = workers;
+    bool made = false;
+    Tile* tile = FXResourceRegistry::Acquire<Tile>(FXResourceRegistry::Key("FXNoise", fields, sizeof(fields)), [&]{
+        Tile e = std::make_shared<Entry>();
+        e->params = params;
+        e->key = key;
+        e->texture = 0;
+        e->ms = 0.0;
+        e->fromDisk = false;
+        e->done = false;
+        e->cancel = false;
+        pool->Submit([e, d, pool]{ Make(e, d, pool); });
+        return new Tile(e);
+    }, [](Tile* t){
+        // a job still running keeps the entry alive until it sees cancel
+        (*t)->cancel = true;
+        if ((*t)->texture) glDeleteTextures(1, &(*t)->texture);
+        delete t;
+    }, &made);
+
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    stats.requests++;
+    if (!made) stats.shared++;
+    int handle = nextHandle++;
+    handles[handle] = tile;
+    return handle;
+}
+
+void FXNoise::Drop(int handle) {
+    Tile* tile = 0;
+    {
+        std::lock_guard<std::mutex> lock(handlesMutex);
+        std::map<int, Tile*>::iterator i = handles.find(handle);
+        if (i == handles.end()) return;
+        tile = i->second;
+        handles.erase(i);
+    }
+    FXResourceRegistry::Release(tile);
+}
+
+FXNoise::Tile FXNoise::Find(int handle) {
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    std::map<int, Tile*>::iterator i = handles.find(handle);
+    if (i == handles.end()) return Tile();
+    return *i->second;
+}
+
+bool FXNoise::Ready(int handle) {
+    Tile e = Find(handle);
+    return e && e->done;
+}
+
+bool FXNoise::Wait(int handle) {
+    Tile e = Find(handle);
+    if (!e) return false;
+    std::unique_lock<std::mutex> lock(e->doneMutex);
+    e->doneWake.wait(lock, [&e]{ return e->done.load(); });
+    return !e->data.empty();
+}
+
+const unsigned char* FXNoise::Data(int handle) {
+    Tile e = Find(handle);
+    if (!e || !e->done || e->data.empty()) return 0;
+    return &e->data[0];
+}
+
+FXNOISEPARAMS FXNoise::Get(int handle) {
+    Tile e = Find(handle);
+    return e ? e->params : Params(FXNOISE_WHITE, 0);
+}
+
+GLuint FXNoise::Texture(int handle, FXGLState* gl) {
+    Tile e = Find(handle);
+    if (!e || !e->done) return 0;
+    // instances share the entry, only the first one here uploads
+    std::lock_guard<std::mutex> upload(e->doneMutex);
+    if (e->texture || e->data.empty()) return e->texture;
+
+    const GLint internal[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    const GLenum format[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    const FXNOISEPARAMS& p = e->params;
+    glGenTextures(1, &e->texture);
+    // through the tracker on the unit ApplyNoise samples it from, where it's left bound
+    if (gl) {
+        gl->ActiveTexture(GL_TEXTURE0 + FXNOISE_UNIT);
+        gl->BindTexture2D(e->texture);
+    }else {
+        glBindTexture(GL_TEXTURE_2D, e->texture);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal[p.channels - 1], p.size, p.size * p.frames, 0,
+                 format[p.channels - 1], GL_UNSIGNED_BYTE, &e->data[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (gl) gl->ActiveTexture(GL_TEXTURE0);
+    else glBindTexture(GL_TEXTURE_2D, 0);
+
+    // counted once, here, so a tile another instance already uploaded isn't counted again
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    if (e->fromDisk) {
+        stats.loaded++;
+    }else {
+        stats.generated++;
+        stats.generateMs += e->ms;
+    }
+    return e->texture;
+}
+
+//----------------------------------------------------------------------------
+
+// on a worker, from disk or made and stored, done is set either way
+void FXNoise::Make(std::shared_ptr<Entry> e, string dir, FXWorkerPool* workers) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    // white noise is quicker to make than to read back
+    string filename;
+    if (!dir.empty() && e->params.kind != FXNOISE_WHITE) {
+        char name[32];
+        snprintf(name, sizeof(name), "/%016llx.fxnz", (unsigned long long)e->key);
+        filename = dir + name;
+    }
+
+    if (!filename.empty() && Load(filename, *e)) {
+        e->fromDisk = true;
+    }else {
+        e->data.resize(Bytes(e->params));
+        if (!Generate(e->params, &e->data[0], workers, &e->cancel)) {
+            e->data.clear();
+        }else if (!filename.empty() && MakeDirs(dir)) {
+            Store(filename, *e);
+        }
+    }
+    e->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(e->doneMutex);
+        e->done = true;
+    }
+    e->doneWake.notify_all();
+}
+
+bool FXNoise::Load(const string& filename, Entry& e) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    FXNOISEHEADER h;
+    size_t length = Bytes(e.params);
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == FXNOISE_MAGIC && h.version == FXNOISE_VERSION &&
+              h.key == e.key && h.length == length;
+    if (ok) {
+        e.data.resize(length);
+        ok = fread(&e.data[0], 1, length, f) == length && fgetc(f) == EOF && Checksum(&e.data[0], length) == h.checksum;
+    }
+    fclose(f);
+    if (!ok) {
+        // truncated or from another version, made again and stored over it
+        e.data.clear();
+        unlink(filename.c_str());
+    }
+    return ok;
+}
+
+// into a temporary and renamed, another process reading it never sees half a file
+bool FXNoise::Store(const string& filename, const Entry& e) {
+    FXNOISEHEADER h;
+    memset(&h, 0, sizeof(h));
+    h.magic = FXNOISE_MAGIC;
+    h.version = FXNOISE_VERSION;
+    h.key = e.key;
+    h.length = (uint32_t)e.data.size();
+    h.checksum = Checksum(&e.data[0], e.data.size());
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+    string temp = filename + suffix;
+    FILE* f = fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(&e.data[0], 1, e.data.size(), f) == e.data.size();
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(temp.c_str(), filename.c_str()) == 0;
+    if (!ok) unlink(temp.c_str());
+    return ok;
+}
+
+//----------------------------------------------------------------------------
+// white
+
+FXNOISEPATH FXNoise::BestPath() {
+    FXNOISEPATH best = FXNOISE_SCALAR;
+#ifdef FXNOISE_X86
+#ifdef __SSE2__
+    best = FXNOISE_SSE2;
+#endif
+    if (__builtin_cpu_supports("avx2")) best = FXNOISE_AVX2;
+#endif
+    return best;
+}
+
+const char* FXNoise::PathName(FXNOISEPATH p) {
+    switch (p) {
+        case FXNOISE_SCALAR: return "scalar";
+        case FXNOISE_SSE2: return "sse2";
+        case FXNOISE_AVX2: return "avx2";
+        default: return "auto";
+    }
+}
+
+#if defined(FXNOISE_X86) && defined(__SSE2__)
+// SSE2 has no 32 bit mullo (SSE4.1), the even and odd lanes through mul_epu32
+static inline __m128i MulLo32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static int WhiteSSE2(uint32_t key, uint32_t first, int count, uint32_t* out) {
+    const __m128i k = _mm_set1_epi32((int)key);
+    const __m128i m1 = _mm_set1_epi32((int)0x7feb352du);
+    const __m128i m2 = _mm_set1_epi32((int)0x846ca68bu);
+    const __m128i four = _mm_set1_epi32(4);
+    __m128i index = _mm_add_epi32(_mm_set1_epi32((int)first), _mm_setr_epi32(0, 1, 2, 3));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_xor_si128(index, k);
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        x = MulLo32(x, m1);
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+        x = MulLo32(x, m2);
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        _mm_storeu_si128((__m128i*)(out + i), x);
+        index = _mm_add_epi32(index, four);
+    }
+    return i;
+}
+#endif
+
+#ifdef FXNOISE_X86
+// only called when the CPU has AVX2
+__attribute__((target("avx2")))
+static int WhiteAVX2(uint32_t key, uint32_t first, int count, uint32_t* out) {
+    const __m256i k = _mm256_set1_epi32((int)key);
+    const __m256i m1 = _mm256_set1_epi32((int)0x7feb352du);
+    const __m256i m2 = _mm256_set1_epi32((int)0x846ca68bu);
+    const __m256i eight = _mm256_set1_epi32(8);
+    __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)first), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_xor_si256(index, k);
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        x = _mm256_mullo_epi32(x, m1);
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+        x = _mm256_mullo_epi32(x, m2);
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        _mm256_storeu_si256((__m256i*)(out + i), x);
+        index = _mm256_add_epi32(index, eight);
+    }
+    return i;
+}
+#endif
+
+void FXNoise::White(FXNOISEPATH p, uint32_t seed, uint32_t first, int count, uint32_t* out) {
+    if (p == FXNOISE_AUTO || p > BestPath()) p = BestPath();
+    uint32_t key = Mix(seed + 0x9e3779b9u);
+    int done = 0;
+#ifdef FXNOISE_X86
+    if (p == FXNOISE_AVX2) done = WhiteAVX2(key, first, count, out);
+#ifdef __SSE2__
+    else if (p == FXNOISE_SSE2) done = WhiteSSE2(key, first, count, out);
+#endif
+#endif
+    // whatever is left over (or everything on the scalar path)
+    for (int i = done; i < count; i++) out[i] = Mix((first + i) ^ key);
+}
+
+//----------------------------------------------------------------------------
+// perlin
+
+static inline float Fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// the 12 cube edge gradients of improved noise (4 of them twice to make 16)
+static inline float Gradient(uint32_t h, float x, float y, float z) {
+    int g = h & 15;
+    float u = g < 8 ? x : y;
+    float v = g < 4 ? y : (g == 12 || g == 14 ? x : z);
+    return ((g & 1) ? -u : u) + ((g & 2) ? -v : v);
+}
+
+static inline uint32_t Lattice(int x, int y, int z, uint32_t seed) {
+    return Mix((uint32_t)x ^ Mix((uint32_t)y ^ Mix((uint32_t)z ^ seed)));
+}
+
+static inline int Wrap(int a, int period) {
+    a %= period;
+    return a < 0 ? a + period : a;
+}
+
+// -1..1 (about), the lattice wraps at period in every direction
+static float Perlin(float x, float y, float z, int period, int zPeriod, uint32_t seed) {
+    int x0 = (int)floorf(x), y0 = (int)floorf(y), z0 = (int)floorf(z);
+    float fx = x - x0, fy = y - y0, fz = z - z0;
+    int xa = Wrap(x0, period), xb = Wrap(x0 + 1, period);
+    int ya = Wrap(y0, period), yb = Wrap(y0 + 1, period);
+    int za = Wrap(z0, zPeriod), zb = Wrap(z0 + 1, zPeriod);
+    float u = Fade(fx), v = Fade(fy), w = Fade(fz);
+
+    float n000 = Gradient(Lattice(xa, ya, za, seed), fx, fy, fz);
+    float n100 = Gradient(Lattice(xb, ya, za, seed), fx - 1, fy, fz);
+    float n010 = Gradient(Lattice(xa, yb, za, seed), fx, fy - 1, fz);
+    float n110 = Gradient(Lattice(xb, yb, za, seed), fx - 1, fy - 1, fz);
+    float n001 = Gradient(Lattice(xa, ya, zb, seed), fx, fy, fz - 1);
+    float n101 = Gradient(Lattice(xb, ya, zb, seed), fx - 1, fy, fz - 1);
+    float n011 = Gradient(Lattice(xa, yb, zb, seed), fx, fy - 1, fz - 1);
+    float n111 = Gradient(Lattice(xb, yb, zb, seed), fx - 1, fy - 1, fz - 1);
+
+    float x00 = n000 + u * (n100 - n000), x10 = n010 + u * (n110 - n010);
+    float x01 = n001 + u * (n101 - n001), x11 = n011 + u * (n111 - n011);
+    float y0v = x00 + v * (x10 - x00), y1v = x01 + v * (x11 - x01);
+    return y0v + w * (y1v - y0v);
+}
+
+// one row of one frame, every channel
+static void PerlinRow(const FXNOISEPARAMS& p, int row, unsigned char* out) {
+    int frame = row / p.size, y = row % p.size;
+    // octaves past 2 texels a cell are just more white noise
+    int octaves = 1;
+    while (octaves < p.octaves && (p.period << octaves) <= p.size / 2) octaves++;
+    float z = p.frames > 1 ? (float)frame * p.period / p.frames : 0.0f;
+    for (int c = 0; c < p.channels; c++) {
+        uint32_t seed = Mix(p.seed + c * 0x9e3779b9u);
+        for (int x = 0; x < p.size; x++) {
+            float fx = (x + 0.5f) * p.period / p.size;
+            float fy = (y + 0.5f) * p.period / p.size;
+            float n = 0.0f, amplitude = 1.0f, total = 0.0f;
+            for (int o = 0; o < octaves; o++) {
+                float s = (float)(1 << o);
+                n += amplitude * Perlin(fx * s, fy * s, z * s, p.period << o, p.period << o, seed + o);
+                total += amplitude;
+                amplitude *= 0.5f;
+            }
+            float v = 0.5f + 0.5f * FXNOISE_PERLINGAIN * n / total;
+            out[x * p.channels + c] = (unsigned char)(min(max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// blue
+
+/**
+    void-and-cluster over a size x size torus, energy is the gaussian weighted count of set texels
+    around each texel. The tightest cluster is the set texel with the most energy, the largest void
+    the empty one with the least. Each row keeps its best of both, setting/clearing a texel changes
+    the energy of 2 x BLUE_RADIUS + 1 rows and only those are looked at again.
+*/
+struct VoidAndCluster {
+    int size, mask, radius, span;
+    vector<float> kernel;
+    vector<float> energy;
+    vector<unsigned char> bits;
+    vector<int> rowCluster, rowVoid;
+    vector<unsigned char> dirty;
+    vector<int> dirtyRows;
+
+    VoidAndCluster(int s) {
+        size = s;
+        mask = s - 1;
+        radius = min(BLUE_RADIUS, (s - 1) / 2);
+        span = radius * 2 + 1;
+        kernel.resize(span * span);
+        for (int dy = -radius; dy <= radius; dy++) {
+            for (int dx = -radius; dx <= radius; dx++) {
+                kernel[(dy + radius) * span + dx + radius] = expf(-(dx * dx + dy * dy) / (2.0f * BLUE_SIGMA * BLUE_SIGMA));
+            }
+        }
+        energy.assign(s * s, 0.0f);
+        bits.assign(s * s, 0);
+        rowCluster.assign(s, -1);
+        rowVoid.assign(s, -1);
+        dirty.assign(s, 0);
+        AllDirty();
+    }
+
+    void AllDirty() {
+        dirtyRows.clear();
+        for (int y = 0; y < size; y++) {
+            dirty[y] = 1;
+            dirtyRows.push_back(y);
+        }
+    }
+
+    void Set(int p, bool on) {
+        bits[p] = on;
+        float sign = on ? 1.0f : -1.0f;
+        int x = p & mask, y = p / size;
+        for (int dy = -radius; dy <= radius; dy++) {
+            int row = (y + dy) & mask;
+            if (!dirty[row]) {
+                dirty[row] = 1;
+                dirtyRows.push_back(row);
+            }
+            float* e = &energy[row * size];
+            const float* k = &kernel[(dy + radius) * span + radius];
+            for (int dx = -radius; dx <= radius; dx++) e[(x + dx) & mask] += sign * k[dx];
+        }
+    }
+
+    void Refresh() {
+        for (unsigned int i = 0; i < dirtyRows.size(); i++) {
+            int y = dirtyRows[i];
+            const float* e = &energy[y * size];
+            const unsigned char* b = &bits[y * size];
+            int c = -1, v = -1;
+            for (int x = 0; x < size; x++) {
+                if (b[x]) {
+                    if (c < 0 || e[x] > e[c]) c = x;
+                }else if (v < 0 || e[x] < e[v]) {
+                    v = x;
+                }
+            }
+            rowCluster[y] = c < 0 ? -1 : y * size + c;
+            rowVoid[y] = v < 0 ? -1 : y * size + v;
+            dirty[y] = 0;
+        }
+        dirtyRows.clear();
+    }
+
+    int Cluster() {
+        Refresh();
+        int best = -1;
+        for (int y = 0; y < size; y++) {
+            int c = rowCluster[y];
+            if (c >= 0 && (best < 0 || energy[c] > energy[best])) best = c;
+        }
+        return best;
+    }
+
+    int Void() {
+        Refresh();
+        int best = -1;
+        for (int y = 0; y < size; y++) {
+            int v = rowVoid[y];
+            if (v >= 0 && (best < 0 || energy[v] < energy[best])) best = v;
+        }
+        return best;
+    }
+};
+
+// 0..size^2-1 for each texel, false if cancelled
+static bool BlueNoise(int size, uint32_t seed, vector<uint32_t>& rank, const std::atomic<bool>* cancel) {
+    const int n = size * size;
+    VoidAndCluster m(size);
+    rank.assign(n, 0);
+
+    // a random start, then clusters moved into voids until the one taken out goes straight back
+    uint32_t r = Mix(seed) | 1;
+    int initial = max(1, n / BLUE_INITIAL);
+    for (int placed = 0; placed < initial;) {
+        r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+        int p = r % n;
+        if (m.bits[p]) continue;
+        m.Set(p, true);
+        placed++;
+    }
+    for (int i = 0; i < n; i++) {
+        if (cancel && (i & 1023) == 0 && *cancel) return false;
+        int c = m.Cluster();
+        m.Set(c, false);
+        int v = m.Void();
+        m.Set(v, true);
+        if (v == c) break;
+    }
+    vector<float> energy = m.energy;
+    vector<unsigned char> bits = m.bits;
+
+    // phase 1, the start pattern's texels ranked tightest cluster last
+    for (int ones = initial; ones > 0;) {
+        if (cancel && (ones & 4095) == 0 && *cancel) return false;
+        int c = m.Cluster();
+        m.Set(c, false);
+        rank[c] = --ones;
+    }
+    // phase 2 and 3 from the start pattern again, largest void next (past half full that is the
+    // same texel as the tightest cluster of the empty ones, the energy of a full torus is flat)
+    m.energy = energy;
+    m.bits = bits;
+    m.AllDirty();
+    for (int ones = initial; ones < n;) {
+        if (cancel && (ones & 4095) == 0 && *cancel) return false;
+        int v = m.Void();
+        m.Set(v, true);
+        rank[v] = ones++;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+
+bool FXNoise::Generate(const FXNOISEPARAMS& p, unsigned char* out, FXWorkerPool* workers, const std::atomic<bool>* cancel) {
+    if (!Valid(p)) return false;
+    const size_t bytes = Bytes(p);
+
+    if (p.kind == FXNOISE_WHITE) {
+        // size is a power of two from 4, so always whole words
+        int words = (int)(bytes / 4);
+        int jobs = (words + WHITE_CHUNK - 1) / WHITE_CHUNK;
+        uint32_t* w = (uint32_t*)out;
+        auto job = [&](int j) {
+            int first = j * WHITE_CHUNK;
+            White(FXNOISE_AUTO, p.seed, first, min(WHITE_CHUNK, words - first), w + first);
+        };
+        if (workers) workers->Run(jobs, job);
+        else for (int j = 0; j < jobs; j++) job(j);
+        return true;
+    }
+
+    if (p.kind == FXNOISE_PERLIN) {
+        const size_t rowBytes = (size_t)p.size * p.channels;
+        auto job = [&](int row) { PerlinRow(p, row, out + row * rowBytes); };
+        if (workers) workers->Run(p.size * p.frames, job);
+        else for (int row = 0; row < p.size * p.frames; row++) job(row);
+        return cancel ? !*cancel : true;
+    }
+
+    // blue, a map a channel, each frame the same ranks moved along by the golden ratio
+    const int n = p.size * p.size;
+    std::atomic<bool> ok(true);
+    auto job = [&](int c) {
+        vector<uint32_t> rank;
+        if (!BlueNoise(p.size, p.seed + c * 0x9e3779b9u, rank, cancel)) {
+            ok = false;
+            return;
+        }
+        for (int f = 0; f < p.frames; f++) {
+            uint64_t offset = (uint64_t)(fmod(f * BLUE_GOLDEN, 1.0) * n);
+            unsigned char* o = out + (size_t)f * n * p.channels + c;
+            for (int i = 0; i < n; i++) o[i * p.channels] = (unsigned char)(((rank[i] + offset) % n) * 256 / n);
+        }
+    };
+    if (workers) workers->Run(p.channels, job);
+    else for (int c = 0; c < p.channels; c++) job(c);
+    return ok;
+}
@@ -0,0 +1,168 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Noise textures
+
+    TEXREQ_WHITE/PERLIN/BLUE_NOISE get the host's one tile in bufferA, at its size and channels.
+    FXNoise makes tiles to order (size, 1-4 channels, animated frames, seed):
+
+        white   a hash of the byte position, so every path gives the same bytes, 4 bytes a hash
+                (8 at once on AVX2, 4 on SSE2, else plain C)
+        perlin  gradient noise on a lattice that wraps at the tile edge, octaves double the
+                lattice so they tile too, frames walk round a loop in z (the last goes back to the first)
+        blue    void-and-cluster (Ulichney) ranks, toroidal gaussian energy (sigma 1.5, cut at 5
+                texels) with the best texel of each row kept so a step only rescans the rows it
+                touched, ~1s at 256x256 a channel. Channels are separate maps, frames are the same
+                map offset by the golden ratio (blue in space, low discrepancy over time)
+
+    One library per process (Acquire/Release). Request() hands back a handle, the tile itself is
+    kept in the resource registry by its params (see fxresources.h) so every instance asking for the
+    same gets the same one, made once on the worker pool (perlin/blue are first looked for on disk,
+    dir/KEY.fxnz, and stored there after). Texture() uploads it the first time it's asked for once
+    the worker is done, 0 until then. The last Drop() deletes the texture and stops a blue noise map
+    that's still being made.
+
+    The texture is size x size*frames (frames stacked upwards), GL_NEAREST and GL_REPEAT, R8/RG8/
+    RGB8/RGBA8 by channels, FXNOISE_GLSL samples it per pixel.
+
+    usage (see CreateNoiseParams/ApplyNoise in pluginprivateobject.cpp):
+        InitPlugin:     noiseHandle = noise->Request(FXNoise::Params(FXNOISE_BLUE, 256));
+        CreateShaders:  frag text = "#version 120\n" FXNOISE_GLSL ...; CreateNoiseParams(id);
+        Process:        ApplyNoise(); before uniforms.Apply()
+        Deinit:         noise->Drop(noiseHandle);
+    shader:
+        vec4 n = fxNoiseTexel(gl_FragCoord.xy);     // tiled 1:1 on the output, this frame's variant
+*/
+
+#ifndef FXNOISE_H
+#define FXNOISE_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <memory>
+
+#include "fxpluginstructures.h"
+#include "fxglstate.h"
+#include "fxworkers.h"
+
+#define FXNOISE_UNIT 12                 // texture unit ApplyNoise binds to (clear of the mixer, frame and audio history)
+#define FXNOISE_MAXSIZE 4096
+#define FXNOISE_MAXBLUESIZE 512         // void-and-cluster is n^2 steps, 512 is a few seconds a channel
+#define FXNOISE_PERLINGAIN 1.6f         // summed octaves stay inside about +-0.6, stretched to fill 0-255
+#define FXNOISE_MAGIC 0x5A4E5846        // "FXNZ"
+#define FXNOISE_VERSION 1
+#define FXNOISE_FIELDS 8                // the params as they go into the key, see Fields
+
+enum FXNOISEKIND {FXNOISE_WHITE, FXNOISE_PERLIN, FXNOISE_BLUE};
+enum FXNOISEPATH {FXNOISE_AUTO = 0, FXNOISE_SCALAR, FXNOISE_SSE2, FXNOISE_AVX2};
+
+struct FXNOISEPARAMS {
+    FXNOISEKIND kind;
+    int size;                   // width and height, a power of two so it tiles
+    int channels;               // 1-4
+    int frames;                 // animated variants, 1 for a still tile
+    uint32_t seed;
+    int period;                 // perlin, lattice cells across the tile at the first octave
+    int octaves;                // perlin
+};
+
+struct FXNOISEHEADER {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t length;
+    uint32_t checksum;          // FNV-1a of the bytes
+};
+
+struct FXNOISESTATS {
+    long requests;
+    long shared;                // requests that found the params already made or in the making
+    long generated;
+    long loaded;                // from the disk cache
+    double generateMs;          // worker time over everything generated
+};
+
+// fxNoise[0] size, [1] frames, [2] this frame
+#define FXNOISE_GLSL \
+    "uniform sampler2D fxNoiseTex;\n" \
+    "uniform float fxNoise[3];\n" \
+    "vec4 fxNoiseTexel(vec2 p) {\n" \
+    "  vec2 t = mod(floor(p), fxNoise[0]) + 0.5;\n" \
+    "  t.y += mod(fxNoise[2], fxNoise[1]) * fxNoise[0];\n" \
+    "  return texture2D(fxNoiseTex, t / vec2(fxNoise[0], fxNoise[0] * fxNoise[1]));\n" \
+    "}\n" \
+    "vec4 fxNoiseUV(vec2 uv) { return fxNoiseTexel(uv * fxNoise[0]); }\n"
+
+class FXNoise
+{
+    public:
+        // one library per process, shared between instances
+        static FXNoise* Acquire();
+        static void Release(FXNoise* noise);
+
+        static FXNOISEPARAMS Params(FXNOISEKIND kind, int size, int channels = 1, int frames = 1, uint32_t seed = 1);
+
+        // a handle for the tile (made on a worker if it isn't already), -1 if the params are no good
+        int Request(const FXNOISEPARAMS& params);
+        void Drop(int handle);
+        bool Ready(int handle);
+        // blocks until the worker is done (fxbench, or a plugin that can't draw without it)
+        bool Wait(int handle);
+        // uploaded on the first call after Ready, 0 until then (context current, with gl it is left bound on FXNOISE_UNIT)
+        GLuint Texture(int handle, FXGLState* gl = 0);
+        // the bytes, size x size*frames x channels, 0 until Ready
+        const unsigned char* Data(int handle);
+        FXNOISEPARAMS Get(int handle);
+
+        // "" keeps everything in memory, the directory is made on the first store
+        void SetCacheDir(const string& directory) { dir = directory; }
+        // $FXNOISE_CACHE (set but empty for none), else ~/.cache/vidifold/noise
+        static string DefaultDir();
+        FXNOISESTATS Stats() { return stats; }
+
+        // the tile straight into out (bytes as Data), no cache, false if cancelled
+        static bool Generate(const FXNOISEPARAMS& params, unsigned char* out, FXWorkerPool* workers, const std::atomic<bool>* cancel = 0);
+        // words [first, first + count) of the white noise hash
+        static void White(FXNOISEPATH p, uint32_t seed, uint32_t first, int count, uint32_t* out);
+        static FXNOISEPATH BestPath();
+        static const char* PathName(FXNOISEPATH p);
+        static bool Valid(const FXNOISEPARAMS& params);
+        static uint64_t Key(const FXNOISEPARAMS& params);
+        static size_t Bytes(const FXNOISEPARAMS& params);
+    protected:
+    private:
+        FXNoise();
+        virtual ~FXNoise();
+
+        struct Entry {
+            FXNOISEPARAMS params;
+            uint64_t key;
+            vector<unsigned char> data;
+            GLuint texture;
+            double ms;
+            bool fromDisk;
+            std::atomic<bool> done;
+            std::atomic<bool> cancel;
+            std::mutex doneMutex;
+            std::condition_variable doneWake;
+        };
+
+        // the registry holds the tiles (one per params for the whole process), handles are per Request
+        typedef std::shared_ptr<Entry> Tile;
+        std::mutex handlesMutex;
+        std::map<int, Tile*> handles;
+        int nextHandle;
+        string dir;
+        FXWorkerPool* workers;
+        FXNOISESTATS stats;
+
+        Tile Find(int handle);
+        static void Fields(const FXNOISEPARAMS& params, int32_t v[FXNOISE_FIELDS]);
+        static void Make(std::shared_ptr<Entry> entry, string dir, FXWorkerPool* workers);
+        static bool Load(const string& filename, Entry& entry);
+        static bool Store(const string& filename, const Entry& entry);
+};
+
+#endif // FXNOISE_H
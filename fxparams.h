@@ -0,0 +1,364 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Declarative parameter table
+
+    Instead of hand written CreateParam/Update/Random/Reset/state blocks that all have to
+    agree on the param index, the params are described once in a constexpr table in the plugin
+    class: type, range, default, the member it drives and how the value is converted.
+    FXParamTable generates everything else from it:
+
+        Create       the CreateParam calls, in table order (so indices can't drift)
+        Update       builds a bit mask of the params the host flagged and only converts those,
+                     calling the optional changed function afterwards
+        Random       params made with FXRandom get a random value
+        Reset        back to the defaults
+        Save/Load    one tagged state field per param (tag from the name, see fxstate.h),
+                     schemaHash covers names, types and ranges
+        PackedToFields
+                     the old version 2 packed state struct (bits per param from its range)
+                     as tagged fields, for the state migration
+
+    No virtuals, no per frame strings, the table and the state size are all compile time.
+
+    usage (inside the class, after the members the table points at):
+        static constexpr FXPARAMDESC<PluginPrivateObject> paramDescs[] = {
+            FXRandom(FXRange("Red", 0, 100, 0, &PluginPrivateObject::r, 0.01f, &PluginPrivateObject::RedChanged)),
+            FXToggle("Enabled", 1, &PluginPrivateObject::enabled),
+            FXBender("FOV", &PluginPrivateObject::FOV, 45.0f, 3.0f, 5.0f, 175.0f)
+        };
+        FXParamTable<PluginPrivateObject, FXPARAMCOUNT(paramDescs), paramDescs> params;
+
+    and once in the .cpp
+        constexpr FXPARAMDESC<PluginPrivateObject> PluginPrivateObject::paramDescs[];
+
+    Hand written params can still be created after params.Create(fx), they just follow on.
+*/
+
+#ifndef FXPARAMS_H
+#define FXPARAMS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "fxpluginstructures.h"
+#include "fxstate.h"
+
+#define FXPARAMCOUNT(table) ((int)(sizeof(table) / sizeof(table[0])))
+
+enum FXPARAMCONV {
+    FXCONV_NONE,        // no target (labels, breaks, triggers that only call changed)
+    FXCONV_INT,         // int target = curValue
+    FXCONV_SCALE,       // float target = curValue * scale (eg 0.01 for 0-100 > 0-1)
+    FXCONV_TOGGLE,      // bool target = curValue != 0
+    FXCONV_BENDER,      // float target += BenderCalc(deltaValue) * scale, clamped lo-hi, reset sets resetValue
+    FXCONV_RGBA         // FXRGBA target from the packed colour
+};
+
+struct FXRGBA {
+    float r, g, b, a;
+};
+
+template<class T> struct FXPARAMDESC {
+    FXPARAMTYPE type;
+    const char* name;
+    long minValue, maxValue, defaultValue;
+    FXPARAMCONV conv;
+    float scale;
+    float lo, hi, resetValue;      // FXCONV_BENDER only
+    bool randomize;
+    float T::*f;
+    int T::*i;
+    bool T::*b;
+    FXRGBA T::*c;
+    void (T::*changed)();          // optional, called once the target has been set
+};
+
+// same curve as PluginPrivateObject::BenderCalc
+inline float FXBenderCalc(long deltaValue) {
+    float d = fabs((float)deltaValue);
+    float dist = pow(d * 0.1, 3.) * 0.0001;
+    return deltaValue < 0 ? -dist : dist;
+}
+
+//----------------------------------------------------------------------------
+// table entries
+
+template<class T> constexpr FXPARAMDESC<T> FXParamDesc(FXPARAMTYPE type, const char* name, long minValue, long maxValue,
+        long defaultValue, FXPARAMCONV conv, float scale, float lo, float hi, float resetValue, bool randomize,
+        float T::*f, int T::*i, bool T::*b, FXRGBA T::*c, void (T::*changed)()) {
+    return FXPARAMDESC<T>{type, name, minValue, maxValue, defaultValue, conv, scale, lo, hi, resetValue, randomize,
+                          f, i, b, c, changed};
+}
+
+// bar control, target = value * scale
+template<class T> constexpr FXPARAMDESC<T> FXRange(const char* name, long minValue, long maxValue, long defaultValue,
+        float T::*target, float scale = 1.0f, void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_RANGE, name, minValue, maxValue, defaultValue, FXCONV_SCALE, scale, 0, 0, 0, false,
+                          target, 0, 0, 0, changed);
+}
+
+template<class T> constexpr FXPARAMDESC<T> FXRangeInt(const char* name, long minValue, long maxValue, long defaultValue,
+        int T::*target, void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_RANGE, name, minValue, maxValue, defaultValue, FXCONV_INT, 1, 0, 0, 0, false,
+                          0, target, 0, 0, changed);
+}
+
+template<class T> constexpr FXPARAMDESC<T> FXToggle(const char* name, long defaultValue, bool T::*target,
+        void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_TOGGLE, name, 0, 1, defaultValue, FXCONV_TOGGLE, 1, 0, 0, 0, false,
+                          0, 0, target, 0, changed);
+}
+
+// button stepping through options 0 to options-1 (set the label in changed)
+template<class T> constexpr FXPARAMDESC<T> FXMultiState(const char* name, long options, long defaultValue, int T::*target,
+        void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_MULTI_STATE, name, 0, options - 1, defaultValue, FXCONV_INT, 1, 0, 0, 0, false,
+                          0, target, 0, 0, changed);
+}
+
+template<class T> constexpr FXPARAMDESC<T> FXColour(const char* name, unsigned long defaultValue, FXRGBA T::*target,
+        void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_COLOURSELECTOR, name, 0, 0, (long)defaultValue, FXCONV_RGBA, 1, 0, 0, 0, false,
+                          0, 0, 0, target, changed);
+}
+
+// relative control, target moves by BenderCalc(delta) * scale and stays within lo-hi
+template<class T> constexpr FXPARAMDESC<T> FXBender(const char* name, float T::*target, float resetValue, float scale,
+        float lo, float hi, void (T::*changed)() = 0) {
+    return FXParamDesc<T>(FXP_BENDER, name, -100, 100, 0, FXCONV_BENDER, scale, lo, hi, resetValue, false,
+                          target, 0, 0, 0, changed);
+}
+
+template<class T> constexpr FXPARAMDESC<T> FXTrigger(const char* name, void (T::*changed)()) {
+    return FXParamDesc<T>(FXP_TRIGGER, name, 0, 1, 0, FXCONV_NONE, 1, 0, 0, 0, false, 0, 0, 0, 0, changed);
+}
+
+template<class T> constexpr FXPARAMDESC<T> FXLabel(const char* name, FXPARAMTYPE type = FXP_LABEL) {
+    return FXParamDesc<T>(type, name, 0, 0, 0, FXCONV_NONE, 1, 0, 0, 0, false, 0, 0, 0, 0, 0);
+}
+
+// include the param in Random
+template<class T> constexpr FXPARAMDESC<T> FXRandom(FXPARAMDESC<T> d) {
+    return FXParamDesc<T>(d.type, d.name, d.minValue, d.maxValue, d.defaultValue, d.conv, d.scale, d.lo, d.hi,
+                          d.resetValue, true, d.f, d.i, d.b, d.c, d.changed);
+}
+
+//----------------------------------------------------------------------------
+// compile time sizes
+
+constexpr int FXBitsFor(unsigned long range, int bits = 0) {
+    return range ? FXBitsFor(range >> 1, bits + 1) : bits;
+}
+
+// bits a param takes in the packed state, floats (bender targets) and colours are stored whole
+template<class T> constexpr int FXParamBits(const FXPARAMDESC<T>& d) {
+    return d.conv == FXCONV_NONE ? 0
+         : (d.conv == FXCONV_BENDER || d.conv == FXCONV_RGBA) ? 32
+         : FXBitsFor((unsigned long)(d.maxValue - d.minValue));
+}
+
+template<class T, int N> constexpr int FXParamTotalBits(const FXPARAMDESC<T> (&table)[N], int i = 0) {
+    return i < N ? FXParamBits(table[i]) + FXParamTotalBits(table, i + 1) : 0;
+}
+
+template<class T, int N> constexpr uint32_t FXParamSchemaHash(const FXPARAMDESC<T> (&table)[N], int i = 0,
+        uint32_t h = 2166136261u) {
+    return i < N ? FXParamSchemaHash(table, i + 1,
+                       FXStateHashInt((uint32_t)table[i].maxValue, FXStateHashInt((uint32_t)table[i].minValue,
+                       FXStateHashInt((uint32_t)table[i].type, FXStateHash(table[i].name, h)))))
+                 : h;
+}
+
+template<int Bits> struct FXPACKEDPARAMS {
+    uint32_t words[Bits > 0 ? (Bits + 31) / 32 : 1];
+};
+
+//----------------------------------------------------------------------------
+
+template<class T, int N, const FXPARAMDESC<T> (&Table)[N]>
+class FXParamTable
+{
+    public:
+        static_assert(N <= MAXFXPARAMS, "too many params in the table");
+
+        static const int bits = FXParamTotalBits(Table);
+        static const uint32_t schemaHash = FXParamSchemaHash(Table);
+        typedef FXPACKEDPARAMS<bits> State;
+
+        FXParamTable() : base(0) {}
+
+        // interface index of table entry n
+        int Index(int n) { return base + n; }
+        // first index after the table, for hand written params
+        int End() { return base + N; }
+
+        void Create(FXOBJECT* fx) {
+            base = fx->info.paramCount;
+            for (int n = 0; n < N; n++) {
+                const FXPARAMDESC<T>& d = Table[n];
+                FXPARAM& p = fx->interfaceparams[base + n];
+                p.t = d.type;
+                p.name.assign(d.name);
+                p.minValue = d.minValue;
+                p.maxValue = d.maxValue;
+                p.curValue = d.defaultValue;
+                p.defaultValue = d.defaultValue;
+                p.global = false;  // not supported
+                p.update = false;
+                if (d.type == FXP_LABEL) p.displayValue = d.name;
+            }
+            fx->info.paramCount = base + N;
+        }
+
+        /**
+            converts only what the host (or Random/Reset/SetState) flagged
+            forceHostUpdate leaves the flags set so the host refreshes its panel
+        */
+        void Update(FXOBJECT* fx, T* target, bool forceHostUpdate) {
+            uint32_t dirty[(N + 31) / 32];
+            memset(dirty, 0, sizeof(dirty));
+            for (int n = 0; n < N; n++) {
+                if (fx->interfaceparams[base + n].update) dirty[n >> 5] |= 1u << (n & 31);
+            }
+            for (int w = 0; w < (N + 31) / 32; w++) {
+                uint32_t m = dirty[w];
+                while (m) {
+                    int n = (w << 5) + __builtin_ctz(m);
+                    m &= m - 1;
+                    Apply(fx->interfaceparams[base + n], Table[n], target, forceHostUpdate);
+                }
+            }
+        }
+
+        void Random(FXOBJECT* fx) {
+            for (int n = 0; n < N; n++) {
+                const FXPARAMDESC<T>& d = Table[n];
+                if (!d.randomize) continue;
+                FXPARAM& p = fx->interfaceparams[base + n];
+                if (d.conv == FXCONV_RGBA) {
+                    // random colour, fully opaque
+                    p.curValue = (long)(((unsigned long)(rand() & 0xFF) << 24) | ((rand() & 0xFF) << 16) | ((rand() & 0xFF) << 8) | 0xFF);
+                }else {
+                    p.curValue = d.minValue + (rand() % (d.maxValue - d.minValue + 1));
+                }
+                p.update = true;
+            }
+        }
+
+        void Reset(FXOBJECT* fx) {
+            for (int n = 0; n < N; n++) {
+                FXPARAM& p = fx->interfaceparams[base + n];
+                p.curValue = p.defaultValue;
+                p.update = true;
+                if (p.t == FXP_BENDER) p.reset = true;
+            }
+        }
+
+        void Save(FXOBJECT* fx, T* target, FXStateWriter& out) {
+            for (int n = 0; n < N; n++) {
+                const FXPARAMDESC<T>& d = Table[n];
+                if (d.conv == FXCONV_NONE) continue;
+                if (d.conv == FXCONV_BENDER) out.PutFloat(FXStateTag(d.name), target->*d.f);
+                else out.PutInt(FXStateTag(d.name), (int32_t)fx->interfaceparams[base + n].curValue);
+            }
+        }
+
+        // sets and flags whatever the snapshot has (clamped to the current ranges), call Update afterwards
+        void Load(FXStateReader& in, FXOBJECT* fx, T* target) {
+            for (int n = 0; n < N; n++) {
+                const FXPARAMDESC<T>& d = Table[n];
+                if (d.conv == FXCONV_NONE) continue;
+                if (d.conv == FXCONV_BENDER) {
+                    float v;
+                    if (in.GetFloat(FXStateTag(d.name), v)) target->*d.f = v;
+                    continue;
+                }
+                int32_t v;
+                if (!in.GetInt(FXStateTag(d.name), v)) continue;
+                FXPARAM& p = fx->interfaceparams[base + n];
+                if (d.conv == FXCONV_RGBA) {
+                    p.curValue = (long)(uint32_t)v;
+                }else {
+                    p.curValue = v < d.minValue ? d.minValue : (v > d.maxValue ? d.maxValue : v);
+                }
+                p.update = true;
+            }
+        }
+
+        // version 2 packed state to tagged fields (bits in table order)
+        static void PackedToFields(const State& state, FXStateWriter& out) {
+            int offset = 0;
+            for (int n = 0; n < N; n++) {
+                const FXPARAMDESC<T>& d = Table[n];
+                int count = FXParamBits(d);
+                if (!count) continue;
+                uint32_t v = GetBits(state, offset, count);
+                offset += count;
+                if (d.conv == FXCONV_BENDER) {
+                    float f;
+                    memcpy(&f, &v, 4);
+                    out.PutFloat(FXStateTag(d.name), f);
+                }else if (d.conv == FXCONV_RGBA) {
+                    out.PutInt(FXStateTag(d.name), (int32_t)v);
+                }else {
+                    out.PutInt(FXStateTag(d.name), (int32_t)(d.minValue + (long)v));
+                }
+            }
+        }
+    protected:
+    private:
+        int base;
+
+        static void Apply(FXPARAM& p, const FXPARAMDESC<T>& d, T* target, bool forceHostUpdate) {
+            switch (d.conv) {
+                case FXCONV_INT:
+                    target->*d.i = (int)p.curValue;
+                    break;
+                case FXCONV_SCALE:
+                    target->*d.f = p.curValue * d.scale;
+                    break;
+                case FXCONV_TOGGLE:
+                    target->*d.b = p.curValue != 0;
+                    break;
+                case FXCONV_RGBA: {
+                    unsigned long rgba = p.curValue;
+                    FXRGBA& c = target->*d.c;
+                    c.r = ((rgba & 0xFF000000) >> 24) / 255.0f;
+                    c.g = ((rgba & 0x00FF0000) >> 16) / 255.0f;
+                    c.b = ((rgba & 0x0000FF00) >> 8) / 255.0f;
+                    c.a = (rgba & 0x000000FF) / 255.0f;
+                    break;
+                }
+                case FXCONV_BENDER: {
+                    float& v = target->*d.f;
+                    if (p.reset) {
+                        v = d.resetValue;
+                        p.reset = false;
+                    }else {
+                        v += FXBenderCalc(p.deltaValue) * d.scale;
+                        if (v < d.lo) v = d.lo;
+                        if (v > d.hi) v = d.hi;
+                    }
+                    break;
+                }
+                case FXCONV_NONE:
+                    break;
+            }
+            if (d.changed) (target->*d.changed)();
+            // benders never echo back, the host keeps sending deltas while it's held
+            p.update = (d.conv == FXCONV_BENDER) ? false : forceHostUpdate;
+        }
+
+        static uint32_t GetBits(const State& s, int offset, int count) {
+            uint32_t v = 0;
+            for (int k = 0; k < count; k++, offset++) {
+                if (s.words[offset >> 5] & (1u << (offset & 31))) v |= 1u << k;
+            }
+            return v;
+        }
+};
+
+#endif // FXPARAMS_H
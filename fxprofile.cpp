@@ -0,0 +1,88 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Stage profiler (see fxprofile.h)
+*/
+
+#include "fxprofile.h"
+
+#include <string.h>
+#include <time.h>
+
+static double ProfileNowNs() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec * 1E9) + t.tv_nsec;
+}
+
+FXProfiler::FXProfiler() {
+    stageCount = 0;
+    queriesCreated = false;
+    memset(stages, 0, sizeof(stages));
+}
+
+FXProfiler::~FXProfiler() {
+    // empty, queries are released in Deinit while the context is still current
+}
+
+void FXProfiler::Deinit() {
+    for (int i = 0; i < stageCount; i++) glDeleteQueries(2, stages[i].queries);
+    stageCount = 0;
+}
+
+// stage names are static strings so the pointer is enough
+int FXProfiler::Find(const char* name) {
+    for (int i = 0; i < stageCount; i++) {
+        if (stages[i].name == name) return i;
+    }
+    if (stageCount == FXPROFILE_MAXSTAGES) return -1;
+
+    Stage& s = stages[stageCount];
+    s.name = name;
+    s.pending = false;
+    s.gpuNs = -1;
+    s.runs = 0;
+    glGenQueries(2, s.queries);
+    return stageCount++;
+}
+
+int FXProfiler::Begin(const char* name) {
+    int i = Find(name);
+    if (i < 0) return -1;
+
+    // a stage that runs again before Collect just overwrites the previous queries
+    glQueryCounter(stages[i].queries[0], GL_TIMESTAMP);
+    stages[i].startNs = ProfileNowNs();
+    return i;
+}
+
+void FXProfiler::End(int stage) {
+    if (stage < 0) return;
+
+    Stage& s = stages[stage];
+    glQueryCounter(s.queries[1], GL_TIMESTAMP);
+    s.wallNs = ProfileNowNs() - s.startNs;
+    s.pending = true;
+    s.runs++;
+}
+
+int FXProfiler::Collect(FXPROFILESAMPLE* samples, int maxSamples) {
+    int n = 0;
+    for (int i = 0; i < stageCount && n < maxSamples; i++) {
+        Stage& s = stages[i];
+        if (s.pending) {
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(s.queries[0], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(s.queries[1], GL_QUERY_RESULT, &t1);
+            s.gpuNs = (double)(t1 - t0);
+            s.pending = false;
+        }
+        samples[n].name = s.name;
+        samples[n].wallNs = s.wallNs;
+        samples[n].gpuNs = s.gpuNs;
+        samples[n].runs = s.runs;
+        n++;
+    }
+    return n;
+}
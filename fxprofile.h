@@ -0,0 +1,80 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Stage profiler
+
+    Times named stages inside the plugin (wall clock and GPU via GL_TIMESTAMP queries)
+    so the benchmark host can see more than just the Update/Process entry points.
+
+    Only active when built with -DFX_PROFILE, otherwise FX_PROFILE_SCOPE compiles to nothing
+    and there are no queries issued, so it is safe to leave the scopes in a release build.
+
+    usage (inside PluginPrivateObject):
+        FX_PROFILE_SCOPE("Process120Example");
+*/
+
+#ifndef FXPROFILE_H
+#define FXPROFILE_H
+
+#include "fxpluginstructures.h"
+
+#define FXPROFILE_MAXSTAGES 16
+
+// shared with the host (see ProfileStages in main.cpp)
+struct FXPROFILESAMPLE {
+    const char* name;       // static string from FX_PROFILE_SCOPE
+    double wallNs;          // wall time of the last completed run of the stage
+    double gpuNs;           // gpu time of the last completed run (-1 if not available)
+    long runs;              // total times the stage has run
+};
+
+class FXProfiler
+{
+    public:
+        FXProfiler();
+        virtual ~FXProfiler();
+
+        int Begin(const char* name);
+        void End(int stage);
+
+        // waits on outstanding queries, only call when you can afford to stall (ie from a benchmark host)
+        int Collect(FXPROFILESAMPLE* samples, int maxSamples);
+
+        void Deinit();
+    protected:
+    private:
+        struct Stage {
+            const char* name;
+            double startNs;
+            double wallNs;
+            GLuint queries[2];
+            bool pending;
+            double gpuNs;
+            long runs;
+        };
+        Stage stages[FXPROFILE_MAXSTAGES];
+        int stageCount;
+        bool queriesCreated;
+
+        int Find(const char* name);
+};
+
+// RAII helper so early returns still close the stage
+class FXProfileScope
+{
+    public:
+        FXProfileScope(FXProfiler& p, const char* name) : profiler(p) { stage = profiler.Begin(name); }
+        ~FXProfileScope() { profiler.End(stage); }
+    private:
+        FXProfiler& profiler;
+        int stage;
+};
+
+#ifdef FX_PROFILE
+    #define FX_PROFILE_SCOPE(name) FXProfileScope _fxProfileScope(profiler, name)
+#else
+    #define FX_PROFILE_SCOPE(name)
+#endif
+
+#endif // FXPROFILE_H
@@ -0,0 +1,190 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Program binary cache (see fxprogramcache.h)
+*/
+
+#include "fxprogramcache.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static uint64_t Hash64(const void* data, size_t size, uint64_t h = 14695981039346656037ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
+}
+
+static uint64_t Hash64(const string& s, uint64_t h) {
+    // the terminator too, so "ab"+"c" and "a"+"bc" differ
+    return Hash64(s.c_str(), s.size() + 1, h);
+}
+
+static uint32_t Checksum(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// mkdir -p
+static bool MakeDirs(const string& path) {
+    for (size_t i = 1; i <= path.size(); i++) {
+        if (i < path.size() && path[i] != '/') continue;
+        string part = path.substr(0, i);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    }
+    return true;
+}
+
+FXProgramCache::FXProgramCache() {
+    enabled = false;
+    driverHash = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+string FXProgramCache::DefaultDir() {
+    const char* d = getenv("FXSHADER_CACHE");
+    if (d) return d;
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) return string(xdg) + "/vidifold/shaders";
+    const char* home = getenv("HOME");
+    return string(home ? home : "/tmp") + "/.cache/vidifold/shaders";
+}
+
+bool FXProgramCache::Open(const string& directory) {
+    enabled = false;
+    dir = directory;
+    if (dir.empty()) return false;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0 || !MakeDirs(dir)) return false;
+
+    const char* vendor = (const char*)glGetString(GL_VENDOR);
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    driverHash = Hash64(string(vendor ? vendor : ""), 14695981039346656037ULL);
+    driverHash = Hash64(string(renderer ? renderer : ""), driverHash);
+    driverHash = Hash64(string(version ? version : ""), driverHash);
+    enabled = true;
+    return true;
+}
+
+uint64_t FXProgramCache::Key(const string& vertText, const string& fragText) {
+    return Hash64(fragText, Hash64(vertText, driverHash));
+}
+
+string FXProgramCache::Filename(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.fxpb", (unsigned long long)key);
+    return dir + name;
+}
+
+GLuint FXProgramCache::Load(uint64_t key) {
+    if (!enabled) return 0;
+    string filename = Filename(key);
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        stats.misses++;
+        return 0;
+    }
+
+    FXPROGRAMCACHEHEADER h;
+    vector<unsigned char> binary;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == FXPROGRAMCACHE_MAGIC &&
+              h.version == FXPROGRAMCACHE_VERSION && h.key == key && h.length > 0;
+    if (ok) {
+        binary.resize(h.length);
+        ok = fread(&binary[0], 1, h.length, f) == h.length && fgetc(f) == EOF &&
+             Checksum(&binary[0], h.length) == h.checksum;
+    }
+    fclose(f);
+
+    GLuint p = 0;
+    if (ok) {
+        p = glCreateProgram();
+        glProgramBinary(p, h.binaryFormat, &binary[0], h.length);
+        GLint linked = 0;
+        glGetProgramiv(p, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            glDeleteProgram(p);
+            p = 0;
+        }
+    }
+    if (!p) {
+        // truncated, corrupt or the driver has moved on, compile from source and store again
+        unlink(filename.c_str());
+        stats.rejected++;
+        stats.misses++;
+        return 0;
+    }
+    stats.hits++;
+    return p;
+}
+
+void FXProgramCache::PrepareLink(GLuint program) {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool FXProgramCache::Store(uint64_t key, GLuint program) {
+    if (!enabled) return false;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        stats.storeErrors++;
+        return false;
+    }
+    vector<unsigned char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, &binary[0]);
+    if (written <= 0) {
+        stats.storeErrors++;
+        return false;
+    }
+
+    FXPROGRAMCACHEHEADER h;
+    h.magic = FXPROGRAMCACHE_MAGIC;
+    h.version = FXPROGRAMCACHE_VERSION;
+    h.key = key;
+    h.binaryFormat = format;
+    h.length = written;
+    h.checksum = Checksum(&binary[0], written);
+    h.reserved = 0;
+
+    // written to the side and renamed, another instance/process never sees half a file
+    string filename = Filename(key);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+    string tmp = filename + suffix;
+    FILE* f = fopen(tmp.c_str(), "wb");
+    bool ok = f && fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(&binary[0], 1, written, f) == (size_t)written;
+    if (f && fclose(f) != 0) ok = false;
+    if (!ok || rename(tmp.c_str(), filename.c_str()) != 0) {
+        unlink(tmp.c_str());
+        stats.storeErrors++;
+        return false;
+    }
+    stats.stored++;
+    return true;
+}
+
+int FXProgramCache::Clear() {
+    if (dir.empty()) return 0;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return 0;
+    int removed = 0;
+    struct dirent* e;
+    while ((e = readdir(d))) {
+        size_t n = strlen(e->d_name);
+        if (n > 5 && !strcmp(e->d_name + n - 5, ".fxpb") && unlink((dir + "/" + e->d_name).c_str()) == 0) removed++;
+    }
+    closedir(d);
+    return removed;
+}
@@ -0,0 +1,91 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Program binary cache
+
+    Linked programs saved with glGetProgramBinary and loaded back with glProgramBinary, so a
+    program is only compiled/linked from source the first time it is seen on a machine.
+
+    The key is a hash of the vert and frag text plus GL_VENDOR/GL_RENDERER/GL_VERSION, so a
+    driver update just misses. Each file (dir/KEY.fxpb) carries its key, binary format, length
+    and a checksum, anything that doesn't check out or that the driver won't take back
+    (GL_LINK_STATUS false after glProgramBinary) is deleted and the caller compiles from source.
+
+    usage (what the host does per program):
+        cache.Open(FXProgramCache::DefaultDir());       // context must be current
+        uint64_t key = cache.Key(vertText, fragText);
+        GLuint p = cache.Load(key);
+        if (!p) {
+            p = glCreateProgram(); attach..
+            FXProgramCache::PrepareLink(p);
+            glLinkProgram(p);
+            cache.Store(key, p);
+        }
+
+    NOTE: a driver with no binary formats (GL_NUM_PROGRAM_BINARY_FORMATS 0) leaves the cache
+    off, Mesa only has one while its own shader cache is on (not MESA_SHADER_CACHE_DISABLE).
+*/
+
+#ifndef FXPROGRAMCACHE_H
+#define FXPROGRAMCACHE_H
+
+#include <stdint.h>
+
+#include "fxpluginstructures.h"
+
+#define FXPROGRAMCACHE_MAGIC 0x42504658     // "FXPB"
+#define FXPROGRAMCACHE_VERSION 1
+
+struct FXPROGRAMCACHEHEADER {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+    uint32_t checksum;          // FNV-1a of the binary
+    uint32_t reserved;
+};
+
+struct FXPROGRAMCACHESTATS {
+    long hits;
+    long misses;
+    long rejected;              // on disk but bad/stale, deleted
+    long stored;
+    long storeErrors;
+};
+
+class FXProgramCache
+{
+    public:
+        FXProgramCache();
+
+        // "" turns it off, the directory is made if needed
+        bool Open(const string& directory);
+        void Close() { enabled = false; }
+        bool Enabled() { return enabled; }
+        string Directory() { return dir; }
+        // $FXSHADER_CACHE (set but empty for none), else ~/.cache/vidifold/shaders
+        static string DefaultDir();
+
+        uint64_t Key(const string& vertText, const string& fragText);
+        // linked program or 0
+        GLuint Load(uint64_t key);
+        // before glLinkProgram, so the driver keeps the binary around
+        static void PrepareLink(GLuint program);
+        bool Store(uint64_t key, GLuint program);
+        // deletes every entry (fxbench cold starts)
+        int Clear();
+
+        FXPROGRAMCACHESTATS Stats() { return stats; }
+    protected:
+    private:
+        bool enabled;
+        string dir;
+        uint64_t driverHash;
+        FXPROGRAMCACHESTATS stats;
+
+        string Filename(uint64_t key);
+};
+
+#endif // FXPROGRAMCACHE_H
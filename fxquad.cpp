@@ -0,0 +1,160 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Cached quad (see fxquad.h)
+*/
+
+#include "fxquad.h"
+#include "fxresources.h"
+
+#include <string.h>
+
+FXQuad* FXQuad::Acquire() {
+    return FXResourceRegistry::Acquire<FXQuad>("FXQuad", []{ return new FXQuad(); }, [](FXQuad* q){ delete q; });
+}
+
+// last one out deletes the GL objects, so call while the host context is current (ie from Deinit)
+void FXQuad::Release(FXQuad* quad) {
+    FXResourceRegistry::Release(quad);
+}
+
+FXQuad::FXQuad() {
+    checked = false;
+    supported = false;
+    vbo = 0;
+    vao = 0;
+    useCounter = 0;
+    memset(slots, 0, sizeof(slots));
+}
+
+FXQuad::~FXQuad() {
+    Destroy();
+}
+
+bool FXQuad::Available() {
+#ifdef FX_IMMEDIATE_QUADS
+    return false;
+#else
+    if (!checked) {
+        // once only, never per frame
+        const char* version = (const char*)glGetString(GL_VERSION);
+        supported = version && atoi(version) >= 2;
+        checked = true;
+    }
+    return supported;
+#endif
+}
+
+void FXQuad::Create() {
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 6 * FXQUAD_SLOTS, 0, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void FXQuad::Destroy() {
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    vbo = 0;
+    vao = 0;
+}
+
+/**
+    returns the slot holding this quad, uploading it over the least recently used slot if needed
+*/
+int FXQuad::FindSlot(const float key[13]) {
+    int oldest = 0;
+    useCounter++;
+
+    for (int i = 0; i < FXQUAD_SLOTS; i++) {
+        if (slots[i].used && memcmp(slots[i].key, key, sizeof(slots[i].key)) == 0) {
+            slots[i].lastUse = useCounter;
+            return i;
+        }
+        if (!slots[i].used || slots[i].lastUse < slots[oldest].lastUse) oldest = i;
+        if (!slots[i].used) break;
+    }
+
+    // key order: x1,y1,tx1,ty1,ttx1,tty1,x2,y2,tx2,ty2,ttx2,tty2,z
+    float x1 = key[0], y1 = key[1], x2 = key[6], y2 = key[7], z = key[12];
+    Vertex v[6] = {
+        {x1, y1, z, key[2], key[3], key[4], key[5]},
+        {x2, y1, z, key[8], key[3], key[10], key[5]},
+        {x1, y2, z, key[2], key[9], key[4], key[11]},
+
+        {x1, y2, z, key[2], key[9], key[4], key[11]},
+        {x2, y1, z, key[8], key[3], key[10], key[5]},
+        {x2, y2, z, key[8], key[9], key[10], key[11]},
+    };
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(v) * oldest, sizeof(v), v);
+
+    memcpy(slots[oldest].key, key, sizeof(slots[oldest].key));
+    slots[oldest].used = true;
+    slots[oldest].lastUse = useCounter;
+    return oldest;
+}
+
+/**
+    client arrays are disabled again after the draw (host default state)
+*/
+void FXQuad::DrawSlot(int slot, bool secondTexCoords) {
+    const GLsizei stride = sizeof(Vertex);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, (void*)0);
+
+    glClientActiveTexture(GL_TEXTURE0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, stride, (void*)(sizeof(float) * 3));
+
+    if (secondTexCoords) {
+        glClientActiveTexture(GL_TEXTURE1);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, stride, (void*)(sizeof(float) * 5));
+    }
+
+    glDrawArrays(GL_TRIANGLES, slot * 6, 6);
+
+    if (secondTexCoords) {
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glClientActiveTexture(GL_TEXTURE0);
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void FXQuad::Draw(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z) {
+    if (!vbo) Create();
+    float key[13] = {x1, y1, tx1, ty1, 0, 0, x2, y2, tx2, ty2, 0, 0, z};
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    DrawSlot(FindSlot(key), false);
+}
+
+void FXQuad::Draw2(float x1, float y1, float tx1, float ty1, float ttx1, float tty1,
+                   float x2, float y2, float tx2, float ty2, float ttx2, float tty2) {
+    if (!vbo) Create();
+    float key[13] = {x1, y1, tx1, ty1, ttx1, tty1, x2, y2, tx2, ty2, ttx2, tty2, 0};
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    DrawSlot(FindSlot(key), true);
+}
+
+/**
+    4 vertex strip built in FXQUAD_VERT330 from gl_VertexID,
+    width/height is the size of the target being drawn to (replaces the glm::ortho projection)
+*/
+void FXQuad::DrawGenerated(GLint posLoc, GLint uvLoc, GLint sizeLoc, float width, float height,
+                           float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2) {
+    if (!vao) glGenVertexArrays(1, &vao);
+
+    glUniform4f(posLoc, x1, y1, x2, y2);
+    glUniform4f(uvLoc, tx1, ty1, tx2, ty2);
+    glUniform2f(sizeLoc, width, height);
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,94 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Cached quad
+
+    Replaces the glBegin/glEnd immediate mode quads with draws out of a small vertex buffer
+    that is shared by all instances (created on first use).
+
+    Two ways to draw:
+
+    Draw/Draw2 : for #version 120 shaders and the default 000-xTextureVert host shaders,
+                 the quad comes from the fixed function arrays (gl_Vertex/gl_MultiTexCoordN)
+                 the vbo keeps the last FXQUAD_SLOTS different quads, so a plugin drawing the
+                 same quads each frame (the usual case) never uploads anything
+
+    DrawGenerated : for #version 330 shaders using the FXQUAD_VERT330 vert shader,
+                 no attributes at all, corners come from gl_VertexID and the position/texcoord
+                 rectangles are uniforms, so any tx2/ty2 works without touching a buffer
+
+    If the driver is older than GL 2.0 (or built with -DFX_IMMEDIATE_QUADS) Available() returns false
+    and PluginPrivateObject falls back to the old immediate mode helpers.
+*/
+
+#ifndef FXQUAD_H
+#define FXQUAD_H
+
+#include "fxpluginstructures.h"
+
+#define FXQUAD_SLOTS 8
+#define FXQUAD_VERT330_NAME "000-VIDIFOLD-QuadVert330"
+
+// attribute-less quad vert shader, outputs UV like 000-1TextureVert330
+// fxQuadPos is x1,y1,x2,y2 in pixels of the current target and fxQuadSize its width,height
+#define FXQUAD_VERT330 \
+    "#version 330\n" \
+    "uniform vec4 fxQuadPos;\n" \
+    "uniform vec4 fxQuadUV;\n" \
+    "uniform vec2 fxQuadSize;\n" \
+    "out vec2 UV;\n" \
+    "void main(){\n" \
+    "  vec2 c = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n" \
+    "  vec2 p = mix(fxQuadPos.xy, fxQuadPos.zw, c);\n" \
+    "  gl_Position = vec4((p / fxQuadSize) * 2.0 - 1.0, 0.0, 1.0);\n" \
+    "  UV = mix(fxQuadUV.xy, fxQuadUV.zw, c);\n" \
+    "}\n"
+
+class FXQuad
+{
+    public:
+        // one quad per process, shared between instances
+        static FXQuad* Acquire();
+        static void Release(FXQuad* quad);
+
+        bool Available();
+
+        void Draw(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z);
+        void Draw2(float x1, float y1, float tx1, float ty1, float ttx1, float tty1,
+                   float x2, float y2, float tx2, float ty2, float ttx2, float tty2);
+
+        // uniform locations come from CreateShaderParam entries for fxQuadPos, fxQuadUV and fxQuadSize
+        void DrawGenerated(GLint posLoc, GLint uvLoc, GLint sizeLoc, float width, float height,
+                           float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2);
+    protected:
+    private:
+        FXQuad();
+        virtual ~FXQuad();
+
+        // x,y,z + two texcoord sets
+        struct Vertex {
+            float x, y, z;
+            float s0, t0;
+            float s1, t1;
+        };
+        struct Slot {
+            float key[13];
+            bool used;
+            unsigned long lastUse;
+        };
+
+        bool checked;
+        bool supported;
+        GLuint vbo;
+        GLuint vao;             // empty, needed for the attribute-less draw
+        Slot slots[FXQUAD_SLOTS];
+        unsigned long useCounter;
+
+        void Create();
+        void Destroy();
+        int FindSlot(const float key[13]);
+        void DrawSlot(int slot, bool secondTexCoords);
+};
+
+#endif // FXQUAD_H
@@ -0,0 +1,129 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Asynchronous frame readback (see fxreadback.h)
+*/
+
+#include "fxreadback.h"
+
+FXAsyncReadback::FXAsyncReadback(int ringSize) {
+    if (ringSize < 2) ringSize = 2;
+
+    Slot empty;
+    empty.pbo = 0;
+    empty.capacity = 0;
+    empty.fence = 0;
+    empty.state = SLOT_FREE;
+    empty.details.pixels = 0;
+    empty.details.width = empty.details.height = 0;
+    empty.details.frame = 0;
+    empty.details.timestampNs = 0;
+    empty.details.tag = 0;
+    slots.assign(ringSize, empty);
+
+    writeSlot = 0;
+    readSlot = 0;
+    dropped = 0;
+}
+
+FXAsyncReadback::~FXAsyncReadback() {
+    // empty, GL objects are released in Deinit while the context is still current
+}
+
+void FXAsyncReadback::Deinit() {
+    for (unsigned int i = 0; i < slots.size(); i++) {
+        Slot& s = slots[i];
+        if (s.state == SLOT_MAPPED) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        if (s.fence) glDeleteSync(s.fence);
+        if (s.pbo) glDeleteBuffers(1, &s.pbo);
+        s.fence = 0;
+        s.pbo = 0;
+        s.capacity = 0;
+        s.state = SLOT_FREE;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    writeSlot = readSlot = 0;
+}
+
+bool FXAsyncReadback::Pending() {
+    return slots[readSlot].state != SLOT_FREE;
+}
+
+bool FXAsyncReadback::Request(unsigned int width, unsigned int height, string name, long frame, int64_t timestampNs, int tag) {
+    Slot& s = slots[writeSlot];
+    if (s.state != SLOT_FREE) {
+        // nobody has picked up the oldest read yet, never stall to make room
+        dropped++;
+        return false;
+    }
+
+    unsigned int size = width * height * 4;
+    if (!s.pbo) glGenBuffers(1, &s.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    if (size > s.capacity) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, 0, GL_STREAM_READ);
+        s.capacity = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)0);   // into the pbo, returns straight away
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // MUST unbind, else the host's next glReadPixels lands in our buffer
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    s.details.width = width;
+    s.details.height = height;
+    s.details.name = name;
+    s.details.frame = frame;
+    s.details.timestampNs = timestampNs;
+    s.details.tag = tag;
+    s.details.pixels = 0;
+    s.state = SLOT_PENDING;
+
+    writeSlot = (writeSlot + 1) % slots.size();
+    return true;
+}
+
+const FXREADBACKFRAME* FXAsyncReadback::Acquire(bool wait) {
+    Slot& s = slots[readSlot];
+    if (s.state != SLOT_PENDING) return 0;
+
+    // timeout of 0 only polls, the flush bit makes sure the fence actually gets submitted
+    GLuint64 timeout = wait ? 1000000000ULL : 0;
+    GLenum r = glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED) return 0;
+
+    glDeleteSync(s.fence);
+    s.fence = 0;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    s.details.pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+        s.details.width * s.details.height * 4, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!s.details.pixels) {
+        s.state = SLOT_FREE;
+        readSlot = (readSlot + 1) % slots.size();
+        return 0;
+    }
+    s.state = SLOT_MAPPED;
+    return &s.details;
+}
+
+void FXAsyncReadback::ReleaseFrame() {
+    Slot& s = slots[readSlot];
+    if (s.state != SLOT_MAPPED) return;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    s.details.pixels = 0;
+    s.state = SLOT_FREE;
+    readSlot = (readSlot + 1) % slots.size();
+}
@@ -0,0 +1,74 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Asynchronous frame readback
+
+    glReadPixels into a ring of pixel buffer objects with a fence after each one, so the read
+    returns straight away and the pixels are picked up a couple of frames later once the GPU
+    has caught up (a read at frame N is normally ready at N+2 with the default ring of 3).
+    The buffers are allocated once and only grow if a bigger frame is requested.
+
+    Request reads from whatever framebuffer is currently bound for reading (bind it through gl).
+    If every slot is still waiting to be picked up the request is dropped and counted.
+
+    usage:
+        gl->BindFramebuffer(fbo); readback.Request(w, h, "name", frame, timeNs);
+        ...
+        const FXREADBACKFRAME* f;
+        while ((f = readback.Acquire())) { use f->pixels; readback.ReleaseFrame(); }
+*/
+
+#ifndef FXREADBACK_H
+#define FXREADBACK_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "fxpluginstructures.h"
+
+#define FXREADBACK_RING 3
+
+// a finished read, pixels are RGBA and only valid until ReleaseFrame
+struct FXREADBACKFRAME {
+    const unsigned char* pixels;
+    unsigned int width, height;
+    string name;
+    long frame;
+    int64_t timestampNs;
+    int tag;                    // whatever was passed to Request, not used here
+};
+
+class FXAsyncReadback
+{
+    public:
+        FXAsyncReadback(int ringSize = FXREADBACK_RING);
+        virtual ~FXAsyncReadback();
+
+        bool Request(unsigned int width, unsigned int height, string name, long frame, int64_t timestampNs, int tag = 0);
+
+        // oldest finished read (never waits unless wait is set), 0 if there is nothing ready
+        const FXREADBACKFRAME* Acquire(bool wait = false);
+        void ReleaseFrame();
+
+        bool Pending();
+        long Dropped() { return dropped; }
+        void Deinit();
+    protected:
+    private:
+        enum { SLOT_FREE, SLOT_PENDING, SLOT_MAPPED };
+        struct Slot {
+            GLuint pbo;
+            unsigned int capacity;
+            GLsync fence;
+            int state;
+            FXREADBACKFRAME details;
+        };
+
+        vector<Slot> slots;
+        unsigned int writeSlot;
+        unsigned int readSlot;
+        long dropped;
+};
+
+#endif // FXREADBACK_H
@@ -0,0 +1,269 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background frame recorder (see fxrecorder.h)
+*/
+
+#include "fxrecorder.h"
+#include "fxworkers.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stddef.h>
+#include <chrono>
+
+FXFrameRecorder::FXFrameRecorder() : head(0), tail(0), running(false),
+    submitted(0), written(0), dropped(0), writeErrors(0), maxQueued(0) {
+    fd = -1;
+    dataEnd = 0;
+    frameBytes = 0;
+    policy = FXRECORD_DROP;
+    codec = FXIMAGE_RAW;
+    workers = 0;
+    memset(&header, 0, sizeof(header));
+}
+
+FXFrameRecorder::~FXFrameRecorder() {
+    Stop();
+}
+
+bool FXFrameRecorder::Start(string filename, unsigned int width, unsigned int height, unsigned int maxFrames,
+                            FXRECORDPOLICY p, FXIMAGEFORMAT c) {
+    Stop();
+
+    fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    frameBytes = (size_t)width * height * 4;
+    policy = p;
+    codec = c;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FXRECORD_MAGIC, sizeof(header.magic));
+    header.version = FXRECORD_VERSION;
+    header.width = width;
+    header.height = height;
+    header.bytesPerPixel = 4;
+    header.indexCapacity = maxFrames;
+    header.frameCount = 0;
+
+    // frame data starts on a page boundary after the index
+    uint64_t indexEnd = sizeof(FXRECORDHEADER) + (uint64_t)maxFrames * sizeof(FXRECORDINDEX);
+    header.dataOffset = (indexEnd + 4095) & ~(uint64_t)4095;
+    dataEnd = header.dataOffset;
+
+    // reserve the whole file up front so the writer never waits on the filesystem growing it
+    // (not fatal if the filesystem can't, it just grows as we go)
+    // compressed sizes aren't known, a 4:1 guess is usually about right
+    uint64_t expected = (codec == FXIMAGE_FXQ) ? frameBytes / 4 : frameBytes;
+    posix_fallocate(fd, 0, header.dataOffset + (uint64_t)maxFrames * expected);
+
+    if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    // all the frame memory is allocated here, never while recording
+    slots.resize(FXRECORD_QUEUE);
+    for (unsigned int i = 0; i < slots.size(); i++) slots[i].pixels.resize(frameBytes);
+    if (codec == FXIMAGE_FXQ) {
+        workers = FXWorkerPool::Acquire();
+        packed.reserve(frameBytes);
+    }
+
+    head = 0;
+    tail = 0;
+    submitted = written = dropped = writeErrors = 0;
+    maxQueued = 0;
+
+    running = true;
+    writer = std::thread(&FXFrameRecorder::WriterLoop, this);
+    return true;
+}
+
+/**
+    writes whatever is still queued then closes the file
+*/
+void FXFrameRecorder::Stop() {
+    if (!running) return;
+
+    running = false;
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+
+    // trim the unused preallocation
+    if (ftruncate(fd, dataEnd) != 0) writeErrors++;
+    close(fd);
+    fd = -1;
+
+    slots.clear();
+    packed.clear();
+    FXWorkerPool::Release(workers);
+    workers = 0;
+}
+
+bool FXFrameRecorder::Submit(const unsigned char* pixels, unsigned int width, unsigned int height, long frame, int64_t timestampNs) {
+    if (!running) return false;
+    submitted++;
+
+    if (width != header.width || height != header.height) {
+        dropped++;
+        return false;
+    }
+
+    unsigned long h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+        if (policy == FXRECORD_DROP) {
+            dropped++;
+            return false;
+        }
+        wake.notify_one();
+        std::this_thread::yield();
+    }
+
+    Slot& s = slots[h % slots.size()];
+    memcpy(&s.pixels[0], pixels, frameBytes);
+    s.frame = frame;
+    s.timestampNs = timestampNs;
+
+    head.store(h + 1, std::memory_order_release);
+
+    int queued = (int)(h + 1 - tail.load(std::memory_order_acquire));
+    if (queued > maxQueued) maxQueued = queued;
+
+    wake.notify_one();
+    return true;
+}
+
+void FXFrameRecorder::Drop() {
+    if (!running) return;
+    submitted++;
+    dropped++;
+}
+
+bool FXFrameRecorder::WriteSlot(Slot& s) {
+    if (header.frameCount >= header.indexCapacity) {
+        dropped++;   // file full
+        return false;
+    }
+
+    const unsigned char* data = &s.pixels[0];
+    size_t size = frameBytes;
+    if (codec == FXIMAGE_FXQ) {
+        if (!FXCodec::Encode(data, header.width, header.height, packed, workers)) {
+            writeErrors++;
+            return false;
+        }
+        data = &packed[0];
+        size = packed.size();
+    }
+
+    FXRECORDINDEX entry;
+    entry.offset = dataEnd;
+    entry.size = size;
+    entry.codec = codec;
+    entry.frame = s.frame;
+    entry.timestampNs = s.timestampNs;
+
+    if (pwrite(fd, data, size, dataEnd) != (ssize_t)size) {
+        writeErrors++;
+        return false;
+    }
+    dataEnd += size;
+
+    uint64_t indexPos = sizeof(FXRECORDHEADER) + (uint64_t)header.frameCount * sizeof(FXRECORDINDEX);
+    header.frameCount++;
+    if (pwrite(fd, &entry, sizeof(entry), indexPos) != (ssize_t)sizeof(entry)
+        || pwrite(fd, &header.frameCount, sizeof(header.frameCount), offsetof(FXRECORDHEADER, frameCount)) != (ssize_t)sizeof(header.frameCount)) {
+        writeErrors++;
+        return false;
+    }
+    written++;
+    return true;
+}
+
+void FXFrameRecorder::WriterLoop() {
+    for (;;) {
+        unsigned long t = tail.load(std::memory_order_relaxed);
+        if (t != head.load(std::memory_order_acquire)) {
+            WriteSlot(slots[t % slots.size()]);
+            tail.store(t + 1, std::memory_order_release);
+            continue;
+        }
+        if (!running) break;
+
+        // the producer never takes the lock, so don't rely on the notify alone
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, std::chrono::milliseconds(2));
+    }
+}
+
+FXRECORDSTATS FXFrameRecorder::Stats() {
+    FXRECORDSTATS s;
+    s.submitted = submitted;
+    s.written = written;
+    s.dropped = dropped;
+    s.writeErrors = writeErrors;
+    s.maxQueued = maxQueued;
+    return s;
+}
+
+//----------------------------------------------------------------------------
+
+FXRecordingReader::FXRecordingReader() {
+    fd = -1;
+    memset(&header, 0, sizeof(header));
+}
+
+FXRecordingReader::~FXRecordingReader() {
+    Close();
+}
+
+void FXRecordingReader::Close() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    index.clear();
+    memset(&header, 0, sizeof(header));
+}
+
+bool FXRecordingReader::Open(string filename) {
+    Close();
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)
+        || memcmp(header.magic, FXRECORD_MAGIC, sizeof(header.magic)) != 0
+        || header.version != FXRECORD_VERSION) {
+        Close();
+        return false;
+    }
+
+    index.resize(header.frameCount);
+    size_t bytes = index.size() * sizeof(FXRECORDINDEX);
+    if (bytes && pread(fd, &index[0], bytes, sizeof(FXRECORDHEADER)) != (ssize_t)bytes) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool FXRecordingReader::ReadFrame(unsigned int i, vector<unsigned char>& pixels, FXWorkerPool* pool) {
+    if (i >= index.size()) return false;
+    const FXRECORDINDEX& e = index[i];
+    pixels.resize((size_t)header.width * header.height * 4);
+
+    if (e.codec == FXIMAGE_RAW) {
+        if (e.size != pixels.size()) return false;
+        return pread(fd, &pixels[0], e.size, e.offset) == (ssize_t)e.size;
+    }
+    if (e.codec != FXIMAGE_FXQ) return false;
+
+    packed.resize(e.size);
+    unsigned int w, h;
+    if (!e.size || pread(fd, &packed[0], e.size, e.offset) != (ssize_t)e.size) return false;
+    if (!FXCodec::Info(&packed[0], packed.size(), w, h) || w != header.width || h != header.height) return false;
+    return FXCodec::Decode(&packed[0], packed.size(), &pixels[0], pool);
+}
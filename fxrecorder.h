@@ -0,0 +1,152 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background frame recorder
+
+    Captured frames (from FXAsyncReadback) are copied into preallocated slots of a bounded
+    single producer/single consumer lock-free queue, a writer thread appends them to one
+    preallocated container file, so the render thread never touches the disk.
+
+    If the disk can't keep up the queue fills and, depending on the policy, frames are
+    dropped (counted) or Submit waits for a free slot (back-pressure).
+
+    Frames can be stored raw or compressed with the fxcodec (FXIMAGE_FXQ), the compression
+    runs on the writer thread with the stripes spread over the shared worker pool.
+
+    Container file (.vfr), little endian:
+        FXRECORDHEADER
+        FXRECORDINDEX[indexCapacity]    one per frame, written as each frame lands
+        frame data from dataOffset      frames back to back
+
+    the header frameCount is updated after every frame, so a file cut short by a crash
+    is still readable up to the last complete frame.
+*/
+
+#ifndef FXRECORDER_H
+#define FXRECORDER_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "fxpluginstructures.h"
+#include "fxcodec.h"
+
+class FXWorkerPool;
+
+#define FXRECORD_MAGIC "VFREC01"
+#define FXRECORD_VERSION 1
+#define FXRECORD_QUEUE 8        // frames in flight between render and writer thread
+
+enum FXRECORDPOLICY {
+    FXRECORD_DROP,              // drop the new frame when the queue is full
+    FXRECORD_BLOCK              // wait for the writer (stalls the render thread!)
+};
+
+struct FXRECORDHEADER {
+    char magic[8];
+    uint32_t version;
+    uint32_t width, height;
+    uint32_t bytesPerPixel;
+    uint32_t indexCapacity;
+    uint32_t frameCount;
+    uint64_t dataOffset;
+    uint64_t reserved[4];
+};
+
+struct FXRECORDINDEX {
+    uint64_t offset;            // from the start of the file
+    uint32_t size;              // bytes stored
+    uint32_t codec;             // FXIMAGEFORMAT, 0 raw RGBA, 1 fxq
+    int64_t frame;              // plugin frame number
+    int64_t timestampNs;        // fx->curTime when the frame was rendered
+};
+
+struct FXRECORDSTATS {
+    long submitted;
+    long written;
+    long dropped;               // queue full (FXRECORD_DROP) or file full
+    long writeErrors;
+    int maxQueued;
+};
+
+class FXFrameRecorder
+{
+    public:
+        FXFrameRecorder();
+        virtual ~FXFrameRecorder();
+
+        // maxFrames sizes the preallocated file (1080p60 raw is ~500MB/s so keep an eye on disk space)
+        bool Start(string filename, unsigned int width, unsigned int height, unsigned int maxFrames,
+                   FXRECORDPOLICY policy = FXRECORD_DROP, FXIMAGEFORMAT codec = FXIMAGE_RAW);
+        void Stop();
+        bool Recording() { return running; }
+
+        // copies the pixels, the caller can release them straight away
+        bool Submit(const unsigned char* pixels, unsigned int width, unsigned int height, long frame, int64_t timestampNs);
+        // a frame that never got as far as Submit (eg the readback ring was full), counted as dropped
+        void Drop();
+
+        FXRECORDSTATS Stats();
+    protected:
+    private:
+        struct Slot {
+            vector<unsigned char> pixels;
+            long frame;
+            int64_t timestampNs;
+        };
+
+        int fd;
+        FXRECORDHEADER header;
+        uint64_t dataEnd;
+        size_t frameBytes;
+        FXRECORDPOLICY policy;
+        FXIMAGEFORMAT codec;
+        FXWorkerPool* workers;          // only while recording compressed
+        vector<unsigned char> packed;   // writer thread only
+
+        vector<Slot> slots;
+        std::atomic<unsigned long> head;        // written by the render thread only
+        std::atomic<unsigned long> tail;        // written by the writer thread only
+        std::atomic<bool> running;
+        std::thread writer;
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+
+        std::atomic<long> submitted, written, dropped, writeErrors;
+        std::atomic<int> maxQueued;
+
+        void WriterLoop();
+        bool WriteSlot(Slot& s);
+};
+
+// reads back a .vfr file (for review tools, not for use during a show)
+class FXRecordingReader
+{
+    public:
+        FXRecordingReader();
+        virtual ~FXRecordingReader();
+
+        bool Open(string filename);
+        void Close();
+
+        unsigned int FrameCount() { return header.frameCount; }
+        unsigned int Width() { return header.width; }
+        unsigned int Height() { return header.height; }
+        const FXRECORDINDEX& Index(unsigned int i) { return index[i]; }
+
+        // fills pixels with RGBA width*height*4, a pool spreads the decode over its threads
+        bool ReadFrame(unsigned int i, vector<unsigned char>& pixels, FXWorkerPool* pool = 0);
+    protected:
+    private:
+        int fd;
+        FXRECORDHEADER header;
+        vector<FXRECORDINDEX> index;
+        vector<unsigned char> packed;
+};
+
+#endif // FXRECORDER_H
@@ -0,0 +1,432 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Render graph (see fxrendergraph.h)
+*/
+
+#include "fxrendergraph.h"
+
+#include <sstream>
+#include <string.h>
+
+FXRenderGraph::FXRenderGraph() {
+    dirty = true;
+    current = -1;
+    targetWidth = targetHeight = 0;
+    outputWidth = outputHeight = 0;
+    poolSignature = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+int FXRenderGraph::Texture(int width, int height) {
+    Resource r;
+    r.kind = SCRATCH;
+    r.width = width;
+    r.height = height;
+    r.buffer = 0;
+    r.texture = 0;
+    r.tx2 = r.ty2 = 1.0f;
+    r.keep = false;
+    resources.push_back(r);
+    dirty = true;
+    return (int)resources.size() - 1;
+}
+
+int FXRenderGraph::Import(FXBUFFERDETAILS* buffer) {
+    int r = Texture();
+    resources[r].kind = FIXED;
+    resources[r].buffer = buffer;
+    return r;
+}
+
+int FXRenderGraph::Output(FXBUFFERDETAILS* buffer) {
+    int r = Import(buffer);
+    resources[r].keep = true;
+    return r;
+}
+
+int FXRenderGraph::Source(GLuint texture, int width, int height, float tx2, float ty2) {
+    int r = Texture(width, height);
+    resources[r].kind = SOURCE;
+    resources[r].texture = texture;
+    resources[r].tx2 = tx2;
+    resources[r].ty2 = ty2;
+    return r;
+}
+
+void FXRenderGraph::Keep(int resource) {
+    if (resource < 0 || resource >= (int)resources.size()) return;
+    resources[resource].keep = true;
+    dirty = true;
+}
+
+void FXRenderGraph::Resize(int resource, int width, int height) {
+    if (resource < 0 || resource >= (int)resources.size() || resources[resource].kind != SCRATCH) return;
+    Resource& r = resources[resource];
+    if (r.width == width && r.height == height) return;
+    r.width = width;
+    r.height = height;
+    dirty = true;
+}
+
+void FXRenderGraph::SetSource(int resource, GLuint texture, int width, int height, float tx2, float ty2) {
+    if (resource < 0 || resource >= (int)resources.size() || resources[resource].kind != SOURCE) return;
+    Resource& r = resources[resource];
+    r.texture = texture;
+    r.width = width;
+    r.height = height;
+    r.tx2 = tx2;
+    r.ty2 = ty2;
+}
+
+int FXRenderGraph::AddPass(string name, PassFunc draw) {
+    Pass p;
+    p.name = name;
+    p.draw = draw;
+    p.enabled = true;
+    p.write.resource = -1;
+    p.write.version = -1;
+    p.mode = FXWRITE_FULL;
+    p.live = false;
+    passes.push_back(p);
+    dirty = true;
+    return (int)passes.size() - 1;
+}
+
+void FXRenderGraph::Read(int pass, int resource) {
+    Access a;
+    a.resource = resource;
+    a.version = -1;
+    passes[pass].reads.push_back(a);
+    dirty = true;
+}
+
+void FXRenderGraph::Write(int pass, int resource, FXWRITEMODE mode) {
+    passes[pass].write.resource = resource;
+    passes[pass].mode = mode;
+    dirty = true;
+}
+
+void FXRenderGraph::Enable(int pass, bool on) {
+    if (pass < 0 || pass >= (int)passes.size() || passes[pass].enabled == on) return;
+    passes[pass].enabled = on;
+    dirty = true;
+}
+
+void FXRenderGraph::Clear() {
+    resources.clear();
+    passes.clear();
+    versions.clear();
+    pool.clear();
+    dirty = true;
+}
+
+// host buffers that aren't imported, in a fixed order so the assignment is the same every compile
+void FXRenderGraph::BuildPool(FXOBJECT* fx) {
+    FXBUFFERDETAILS* candidates[FXGRAPH_MAXBUFFERS];
+    const char* labels[FXGRAPH_MAXBUFFERS] = {"bufferA", "bufferB", "bufferC", "requestedBuffers[0]", "requestedBuffers[1]", "requestedBuffers[2]"};
+    int n = 0;
+    candidates[n++] = &fx->bufferA;
+    candidates[n++] = &fx->bufferB;
+    candidates[n++] = &fx->bufferC;
+    for (unsigned int i = 0; i < MAXFXFBOBUFFERS; i++) candidates[n++] = i < fx->info.fboCount ? &fx->requestedBuffers[i] : 0;
+
+    pool.clear();
+    for (int i = 0; i < n; i++) {
+        FXBUFFERDETAILS* b = candidates[i];
+        if (!b || !b->FBOID || !b->TextureID) continue;
+        // bufferA carries the special texture when one was asked for
+        if (b == &fx->bufferA && (fx->info.specialTexturesRequested & ~TEXREQ_NONE)) continue;
+        bool imported = false;
+        for (unsigned int r = 0; r < resources.size(); r++) imported = imported || resources[r].buffer == b;
+        if (imported) continue;
+        Buffer p;
+        p.details = b;
+        p.label = labels[i];
+        pool.push_back(p);
+    }
+}
+
+long long FXRenderGraph::Signature(FXOBJECT* fx) {
+    FXBUFFERDETAILS* b[4 + MAXFXFBOBUFFERS] = {&fx->outputBuffer, &fx->bufferA, &fx->bufferB, &fx->bufferC};
+    int n = 4;
+    for (unsigned int i = 0; i < fx->info.fboCount && i < MAXFXFBOBUFFERS; i++) b[n++] = &fx->requestedBuffers[i];
+    long long h = n;
+    for (int i = 0; i < n; i++) {
+        h = h * 31 + b[i]->FBOID;
+        h = h * 31 + b[i]->TextureID;
+        h = h * 31 + b[i]->width;
+        h = h * 31 + b[i]->height;
+    }
+    return h;
+}
+
+void FXRenderGraph::Size(int resource, FXOBJECT* fx, int& width, int& height) {
+    const Resource& r = resources[resource];
+    if (r.kind == FIXED) {
+        width = r.buffer->width;
+        height = r.buffer->height;
+        return;
+    }
+    width = r.width ? r.width : fx->outputBuffer.width;
+    height = r.height ? r.height : fx->outputBuffer.height;
+}
+
+bool FXRenderGraph::Compile(FXOBJECT* fx) {
+    dirty = false;
+    error = "";
+    versions.clear();
+    memset(&stats, 0, sizeof(stats));
+    BuildPool(fx);
+    poolSignature = Signature(fx);
+    outputWidth = fx->outputBuffer.width;
+    outputHeight = fx->outputBuffer.height;
+
+    // 1: versions, every write (bar KEEP) starts a new one, reads see the latest
+    vector<int> latest(resources.size(), -1);
+    vector<bool> declared(resources.size(), false);     // some pass writes it, enabled or not
+    for (unsigned int r = 0; r < resources.size(); r++) {
+        if (resources[r].kind == SCRATCH) continue;
+        // what is there before the first pass (last frame's feedback, the source)
+        Version v;
+        v.resource = r;
+        v.first = -1;
+        v.last = -1;
+        v.buffer = -1;
+        v.live = false;
+        versions.push_back(v);
+        latest[r] = (int)versions.size() - 1;
+    }
+    for (unsigned int p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        pass.live = false;
+        int w = pass.write.resource;
+        if (w >= 0) declared[w] = true;
+        if (!pass.enabled) continue;
+        if (w < 0 || resources[w].kind == SOURCE) {
+            error = pass.name + ": nothing (or a Source) to write to";
+            return false;
+        }
+        for (unsigned int i = 0; i < pass.reads.size(); i++) {
+            Access& a = pass.reads[i];
+            a.version = latest[a.resource];
+            if (a.version < 0 && !declared[a.resource]) {
+                error = pass.name + ": reads a texture nothing has written yet";
+                return false;
+            }
+            // its writers are all disabled, Input gives 0
+            if (a.resource == w && (resources[w].kind == FIXED || pass.mode == FXWRITE_KEEP)) {
+                error = pass.name + ": reads and writes the same buffer, draw into a Texture() in between";
+                return false;
+            }
+        }
+        if (pass.mode == FXWRITE_KEEP) {
+            if (latest[w] < 0) {
+                error = pass.name + ": FXWRITE_KEEP on a texture nothing has written yet";
+                return false;
+            }
+        }else {
+            Version v;
+            v.resource = w;
+            v.first = p;
+            v.last = p;
+            v.buffer = -1;
+            v.live = false;
+            versions.push_back(v);
+            latest[w] = (int)versions.size() - 1;
+        }
+        pass.write.version = latest[w];
+    }
+
+    // 2: culling, back from what is kept
+    for (unsigned int r = 0; r < resources.size(); r++) {
+        if (resources[r].keep && latest[r] >= 0) versions[latest[r]].live = true;
+    }
+    for (int p = (int)passes.size() - 1; p >= 0; p--) {
+        Pass& pass = passes[p];
+        if (!pass.enabled || !versions[pass.write.version].live) continue;
+        pass.live = true;
+        for (unsigned int i = 0; i < pass.reads.size(); i++) {
+            if (pass.reads[i].version >= 0) versions[pass.reads[i].version].live = true;
+        }
+    }
+
+    // 3: how long each version has to last
+    for (unsigned int p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        if (!pass.live) continue;
+        Version& w = versions[pass.write.version];
+        if (w.first < 0 || (int)p < w.first) w.first = p;
+        w.last = max(w.last, (int)p);
+        for (unsigned int i = 0; i < pass.reads.size(); i++) {
+            if (pass.reads[i].version < 0) continue;
+            Version& r = versions[pass.reads[i].version];
+            r.last = max(r.last, (int)p);
+        }
+    }
+    // a kept scratch texture holds on to its buffer for the whole frame
+    for (unsigned int r = 0; r < resources.size(); r++) {
+        if (resources[r].keep && latest[r] >= 0) versions[latest[r]].last = (int)passes.size();
+    }
+
+    // 4: scratch versions onto host buffers, a buffer is free again after the last read of what it holds
+    vector<int> holder(pool.size(), -1);
+    for (unsigned int p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        int tw, th;
+        // a disabled pass may have nothing to write to, an enabled one always does (checked in 1)
+        if (!pass.live) {
+            if (pass.enabled) {
+                Size(pass.write.resource, fx, tw, th);
+                stats.culled++;
+                stats.pixelsSaved += (long long)tw * th;
+            }
+            continue;
+        }
+        Size(pass.write.resource, fx, tw, th);
+        stats.passes++;
+        if (pass.mode == FXWRITE_FULL) {
+            stats.clearsSkipped++;
+            stats.pixelsSaved += (long long)tw * th;
+        }else if (pass.mode == FXWRITE_PARTIAL) {
+            stats.clears++;
+        }
+
+        for (unsigned int b = 0; b < pool.size(); b++) {
+            if (holder[b] >= 0 && versions[holder[b]].last < (int)p) holder[b] = -1;
+        }
+
+        Version& v = versions[pass.write.version];
+        if (resources[v.resource].kind != SCRATCH || v.buffer >= 0) continue;
+        // the smallest free buffer it fits in
+        int best = -1;
+        for (unsigned int b = 0; b < pool.size(); b++) {
+            const FXBUFFERDETAILS* d = pool[b].details;
+            if (holder[b] >= 0 || (int)d->width < tw || (int)d->height < th) continue;
+            if (best < 0 || d->width * d->height < pool[best].details->width * pool[best].details->height) best = b;
+        }
+        if (best < 0) {
+            std::stringstream s;
+            s << pass.name << ": no free buffer for " << tw << "x" << th << " (" << pool.size()
+              << " host buffers, request more with fboCount or cut what is alive at once)";
+            error = s.str();
+            return false;
+        }
+        v.buffer = best;
+        holder[best] = pass.write.version;
+    }
+    for (unsigned int b = 0; b < pool.size(); b++) {
+        for (unsigned int v = 0; v < versions.size(); v++) {
+            if (versions[v].buffer == (int)b) {
+                stats.buffers++;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool FXRenderGraph::Execute(FXOBJECT* fx, FXGLState* gl) {
+    if (dirty || Signature(fx) != poolSignature) {
+        if (!Compile(fx)) return false;
+    }else if (!error.empty()) {
+        return false;
+    }
+
+    for (unsigned int p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        if (!pass.live) continue;
+        const Version& v = versions[pass.write.version];
+        GLuint fbo = v.buffer >= 0 ? pool[v.buffer].details->FBOID : resources[v.resource].buffer->FBOID;
+        Size(v.resource, fx, targetWidth, targetHeight);
+
+        gl->SetupTarget(fbo, targetWidth, targetHeight);
+        if (pass.mode == FXWRITE_PARTIAL) {
+            gl->ClearColor(0.0f,0.0f,0.0f,0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        current = p;
+        pass.draw(*this);
+    }
+    current = -1;
+    return true;
+}
+
+const FXRenderGraph::Version* FXRenderGraph::ReadVersion(int resource) {
+    if (current < 0) return 0;
+    const Pass& pass = passes[current];
+    for (unsigned int i = 0; i < pass.reads.size(); i++) {
+        if (pass.reads[i].resource == resource && pass.reads[i].version >= 0) return &versions[pass.reads[i].version];
+    }
+    return 0;
+}
+
+GLuint FXRenderGraph::Input(int resource) {
+    const Version* v = ReadVersion(resource);
+    if (!v) return 0;
+    if (v->buffer >= 0) return pool[v->buffer].details->TextureID;
+    const Resource& r = resources[resource];
+    return r.kind == SOURCE ? r.texture : r.buffer->TextureID;
+}
+
+float FXRenderGraph::InputTX(int resource) {
+    const Version* v = ReadVersion(resource);
+    if (!v) return 1.0f;
+    if (v->buffer < 0) return resources[resource].tx2;
+    const FXBUFFERDETAILS* d = pool[v->buffer].details;
+    int w = resources[resource].width ? resources[resource].width : outputWidth;
+    return (float)w / d->width;
+}
+
+float FXRenderGraph::InputTY(int resource) {
+    const Version* v = ReadVersion(resource);
+    if (!v) return 1.0f;
+    if (v->buffer < 0) return resources[resource].ty2;
+    const FXBUFFERDETAILS* d = pool[v->buffer].details;
+    int h = resources[resource].height ? resources[resource].height : outputHeight;
+    return (float)h / d->height;
+}
+
+int FXRenderGraph::InputWidth(int resource) {
+    if (resource < 0 || resource >= (int)resources.size()) return 0;
+    const Resource& r = resources[resource];
+    if (r.kind == FIXED) return r.buffer->width;
+    return r.width ? r.width : outputWidth;
+}
+
+int FXRenderGraph::InputHeight(int resource) {
+    if (resource < 0 || resource >= (int)resources.size()) return 0;
+    const Resource& r = resources[resource];
+    if (r.kind == FIXED) return r.buffer->height;
+    return r.height ? r.height : outputHeight;
+}
+
+string FXRenderGraph::Describe() {
+    std::stringstream s;
+    for (unsigned int p = 0; p < passes.size(); p++) {
+        const Pass& pass = passes[p];
+        s << pass.name;
+        if (!pass.enabled) {
+            s << " (disabled)\n";
+            continue;
+        }
+        if (!pass.live) {
+            s << " (culled)\n";
+            continue;
+        }
+        const Version& v = versions[pass.write.version];
+        s << " > " << (v.buffer >= 0 ? pool[v.buffer].label : (resources[v.resource].buffer == 0 ? "?" : "fixed"))
+          << (pass.mode == FXWRITE_FULL ? " (no clear)" : pass.mode == FXWRITE_PARTIAL ? " (clear)" : " (keep)");
+        for (unsigned int i = 0; i < pass.reads.size(); i++) {
+            const Resource& res = resources[pass.reads[i].resource];
+            s << (i ? ", " : " < ");
+            if (pass.reads[i].version < 0) s << "(disabled)";
+            else if (versions[pass.reads[i].version].buffer >= 0) s << pool[versions[pass.reads[i].version].buffer].label;
+            else s << (res.kind == SOURCE ? "source" : "fixed");
+        }
+        s << "\n";
+    }
+    return s.str();
+}
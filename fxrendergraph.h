@@ -0,0 +1,156 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Render graph
+
+    Multi pass effects declare their passes (in the order they run) with what each reads and
+    writes, and the graph works out the FBOs instead of hand coding bind/viewport/ortho/clear
+    against bufferA/B/C:
+
+        resources   Texture(w, h) is scratch (0 = output size), it gets whichever of bufferA/B/C and
+                    the requestedBuffers is free at the time, so two textures never alive at the same
+                    time share one buffer (aliasing). Output()/Import() are fixed buffers (eg a
+                    requestedBuffer kept for feedback), Source() is a read only texture
+        ping-pong   each write is a new version of the texture, so a pass that reads and writes the
+                    same one (blur h then v, feedback, n iterations) just flips between buffers
+        culling     only passes leading to the output (or a Keep() resource) run, a disabled pass
+                    takes everything only it fed with it
+        clears      FXWRITE_FULL (every pixel drawn, no blending) skips the clear, FXWRITE_PARTIAL
+                    clears to 0 first, FXWRITE_KEEP draws over the previous version
+
+    A smaller texture than its buffer is drawn in the bottom left corner, InputTX/TY give the
+    texcoords to sample it with. Compile runs again by itself when a pass is enabled/disabled or
+    the host buffers change (or a Texture() is resized), otherwise Execute only binds and calls
+    the passes.
+
+    usage:
+        InitPlugin: out = graph.Output(&fx->outputBuffer);
+                    tmp = graph.Texture();
+                    int h = graph.AddPass("blur h", [this](FXRenderGraph& g){ ... g.Input(src) ... });
+                    graph.Read(h, src); graph.Write(h, tmp, FXWRITE_FULL);
+                    int v = graph.AddPass("blur v", ...);
+                    graph.Read(v, tmp); graph.Write(v, out, FXWRITE_FULL);
+        Process:    graph.Execute(fx, gl);
+*/
+
+#ifndef FXRENDERGRAPH_H
+#define FXRENDERGRAPH_H
+
+#include <vector>
+#include <functional>
+
+#include "fxpluginstructures.h"
+#include "fxglstate.h"
+
+#define FXGRAPH_MAXBUFFERS (3 + MAXFXFBOBUFFERS)      // bufferA/B/C + requestedBuffers
+
+enum FXWRITEMODE {
+    FXWRITE_FULL,               // covers the whole target, no clear needed
+    FXWRITE_PARTIAL,            // cleared to 0 first
+    FXWRITE_KEEP                // draws over what the last writer left
+};
+
+struct FXRENDERGRAPHSTATS {
+    int passes;                 // live passes
+    int culled;
+    int buffers;                // scratch buffers in use
+    int clears;
+    int clearsSkipped;
+    long long pixelsSaved;      // culled pass targets + skipped clears, per frame
+};
+
+class FXRenderGraph
+{
+    public:
+        typedef std::function<void(FXRenderGraph&)> PassFunc;
+
+        FXRenderGraph();
+
+        int Texture(int width = 0, int height = 0);
+        int Output(FXBUFFERDETAILS* buffer);            // fixed and always kept
+        int Import(FXBUFFERDETAILS* buffer);            // fixed, kept only if Keep()
+        int Source(GLuint texture, int width, int height, float tx2 = 1.0f, float ty2 = 1.0f);
+        void Keep(int resource);
+        // a Source() with this frame's texture (eg fx->source[0].id), no recompile
+        void SetSource(int resource, GLuint texture, int width, int height, float tx2 = 1.0f, float ty2 = 1.0f);
+        // a Texture() at a new size (eg dynamic resolution), only recompiles if it changed
+        void Resize(int resource, int width, int height);
+
+        int AddPass(string name, PassFunc draw);
+        void Read(int pass, int resource);
+        void Write(int pass, int resource, FXWRITEMODE mode = FXWRITE_FULL);
+        void Enable(int pass, bool on);
+        void Clear();                                   // forget every pass and resource
+
+        // the host buffers to allocate from, false (and Error) if the passes don't fit
+        bool Compile(FXOBJECT* fx);
+        bool Execute(FXOBJECT* fx, FXGLState* gl);
+        string Error() { return error; }
+        FXRENDERGRAPHSTATS Stats() { return stats; }
+        // pass order with their buffers, eg for Debug
+        string Describe();
+
+        // inside a pass
+        GLuint Input(int resource);                     // texture of the version this pass reads, 0 if its writer is disabled
+        float InputTX(int resource);
+        float InputTY(int resource);
+        int InputWidth(int resource);                   // image size, the texture is InputWidth / InputTX wide
+        int InputHeight(int resource);
+        int TargetWidth() { return targetWidth; }
+        int TargetHeight() { return targetHeight; }
+    protected:
+    private:
+        enum { SCRATCH, FIXED, SOURCE };
+        struct Resource {
+            int kind;
+            int width, height;
+            FXBUFFERDETAILS* buffer;
+            GLuint texture;
+            float tx2, ty2;
+            bool keep;
+        };
+        struct Access {
+            int resource;
+            int version;                // filled in by Compile
+        };
+        struct Pass {
+            string name;
+            PassFunc draw;
+            bool enabled;
+            vector<Access> reads;
+            Access write;
+            FXWRITEMODE mode;
+            bool live;
+        };
+        // one written state of a resource, the unit buffers are given out in
+        struct Version {
+            int resource;
+            int first, last;            // pass range it has to survive
+            int buffer;                 // index into pool, -1 for fixed/source
+            bool live;
+        };
+        struct Buffer {
+            FXBUFFERDETAILS* details;
+            const char* label;
+        };
+
+        vector<Resource> resources;
+        vector<Pass> passes;
+        vector<Version> versions;
+        vector<Buffer> pool;
+        bool dirty;
+        string error;
+        FXRENDERGRAPHSTATS stats;
+        long long poolSignature;        // host buffers at the last compile
+        int current;                    // pass being drawn
+        int targetWidth, targetHeight;
+        int outputWidth, outputHeight;
+
+        long long Signature(FXOBJECT* fx);
+        void BuildPool(FXOBJECT* fx);
+        void Size(int resource, FXOBJECT* fx, int& width, int& height);
+        const Version* ReadVersion(int resource);
+};
+
+#endif // FXRENDERGRAPH_H
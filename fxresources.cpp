@@ -0,0 +1,97 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Resource registry (see fxresources.h)
+*/
+
+#include "fxresources.h"
+
+// recursive, create can acquire what it needs itself (FXNoise the worker pool)
+std::recursive_mutex& FXResourceRegistry::Lock() {
+    static std::recursive_mutex lock;
+    return lock;
+}
+
+std::map<string, FXResourceRegistry::Entry>& FXResourceRegistry::Table() {
+    static std::map<string, Entry> table;
+    return table;
+}
+
+FXRESOURCESTATS& FXResourceRegistry::Counts() {
+    static FXRESOURCESTATS counts = {0, 0, 0, 0, 0};
+    return counts;
+}
+
+void* FXResourceRegistry::AcquireResource(const string& key, std::function<void*()> create,
+                                          std::function<void(void*)> destroy, bool* made) {
+    std::lock_guard<std::recursive_mutex> lock(Lock());
+    std::map<string, Entry>& table = Table();
+    FXRESOURCESTATS& counts = Counts();
+    if (made) *made = false;
+
+    std::map<string, Entry>::iterator found = table.find(key);
+    if (found != table.end()) {
+        found->second.refs++;
+        counts.acquires++;
+        counts.references++;
+        return found->second.resource;
+    }
+
+    // made with the lock held, a second thread asking for it waits for this one
+    void* resource = create();
+    if (!resource) return 0;
+    Entry& e = table[key];
+    e.resource = resource;
+    e.destroy = destroy;
+    e.refs = 1;
+    counts.acquires++;
+    counts.references++;
+    counts.made++;
+    counts.live++;
+    if (made) *made = true;
+    return resource;
+}
+
+bool FXResourceRegistry::Release(const void* resource) {
+    if (!resource) return false;
+    std::function<void(void*)> destroy;
+    void* last = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(Lock());
+        std::map<string, Entry>& table = Table();
+        FXRESOURCESTATS& counts = Counts();
+        std::map<string, Entry>::iterator i = table.begin();
+        while (i != table.end() && i->second.resource != resource) ++i;
+        if (i == table.end()) return false;
+        counts.references--;
+        if (--i->second.refs > 0) return false;
+        destroy = i->second.destroy;
+        last = i->second.resource;
+        table.erase(i);
+        counts.destroyed++;
+        counts.live--;
+    }
+    // gone from the table already, an Acquire from here on makes a new one
+    destroy(last);
+    return true;
+}
+
+int FXResourceRegistry::Refs(const string& key) {
+    std::lock_guard<std::recursive_mutex> lock(Lock());
+    std::map<string, Entry>& table = Table();
+    std::map<string, Entry>::iterator found = table.find(key);
+    return found == table.end() ? 0 : found->second.refs;
+}
+
+// the bytes themselves rather than a hash of them, two different contents can never share an entry
+string FXResourceRegistry::Key(const string& kind, const void* data, size_t size) {
+    string key = kind + "/";
+    key.append((const char*)data, size);
+    return key;
+}
+
+FXRESOURCESTATS FXResourceRegistry::Stats() {
+    std::lock_guard<std::recursive_mutex> lock(Lock());
+    return Counts();
+}
@@ -0,0 +1,84 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Resource registry
+
+    Every CreateInstance makes its own PluginPrivateObject, so anything an instance builds for
+    itself (VBOs, LUTs, noise, CPU tables) is built again for every slot the plugin is in.
+    FXResourceRegistry is one table per .so of what has been made, by key:
+
+        key         a name for the one per process objects ("FXQuad"), or Key(kind, bytes, size) for
+                    anything made from data (a LUT from its table, a noise tile from its params),
+                    the same content is the same key whichever instance asks (the whole content,
+                    so keep what goes in small, eg the params a table is made from)
+        Acquire     the resource under the key, made by create the first time (once, even with two
+                    threads asking at the same moment), every Acquire is a reference
+        Release     the last reference calls destroy, outside the lock so destroy can release what
+                    it acquired itself (FXNoise lets go of the worker pool)
+
+    A resource is made/destroyed on whichever thread gets there first, so GL resources are only
+    acquired/released where the host's context is current (InitPlugin/Process/Deinit, never a job).
+    create and destroy come from the class's own Acquire, so private constructors still work.
+
+    usage:
+        FXQuad* FXQuad::Acquire() {
+            return FXResourceRegistry::Acquire<FXQuad>("FXQuad", []{ return new FXQuad(); }, [](FXQuad* q){ delete q; });
+        }
+        void FXQuad::Release(FXQuad* quad) { FXResourceRegistry::Release(quad); }
+
+        string key = FXResourceRegistry::Key("LUT", table, sizeof(table));
+        lut = FXResourceRegistry::Acquire<LUT>(key, [&]{ return new LUT(table); }, [](LUT* l){ delete l; });
+*/
+
+#ifndef FXRESOURCES_H
+#define FXRESOURCES_H
+
+#include <map>
+#include <mutex>
+#include <functional>
+
+#include "fxpluginstructures.h"
+
+struct FXRESOURCESTATS {
+    long acquires;
+    long made;
+    long destroyed;
+    int live;                   // resources held right now
+    int references;             // Acquires not yet Released
+};
+
+class FXResourceRegistry
+{
+    public:
+        // made is set true when this call made it
+        template<class T> static T* Acquire(const string& key, std::function<T*()> create,
+                                            std::function<void(T*)> destroy, bool* made = 0) {
+            return (T*)AcquireResource(key, [create]() -> void* { return create(); },
+                                       [destroy](void* p) { destroy((T*)p); }, made);
+        }
+        // true if that was the last reference (destroy has been called), false if not or not ours
+        static bool Release(const void* resource);
+
+        static int Refs(const string& key);
+        // kind + the bytes as they are (compared in full on lookup, no hash to collide)
+        static string Key(const string& kind, const void* data, size_t size);
+        static FXRESOURCESTATS Stats();
+    protected:
+    private:
+        struct Entry {
+            void* resource;
+            std::function<void(void*)> destroy;
+            int refs;
+        };
+
+        // function statics, so an Acquire from another file's static init still finds them made
+        static std::recursive_mutex& Lock();
+        static std::map<string, Entry>& Table();
+        static FXRESOURCESTATS& Counts();
+
+        static void* AcquireResource(const string& key, std::function<void*()> create,
+                                     std::function<void(void*)> destroy, bool* made);
+};
+
+#endif // FXRESOURCES_H
@@ -0,0 +1,502 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background shader compiles (see fxshadercompiler.h)
+*/
+
+#include "fxshadercompiler.h"
+#include "fxresources.h"
+
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <EGL/egl.h>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+static int64_t NowNs() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static bool HasGLExtension(const char* name) {
+    GLint n = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+    for (GLint i = 0; i < n; i++) {
+        const char* e = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (e && !strcmp(e, name)) return true;
+    }
+    return false;
+}
+
+/**
+    the worker's context, EGL is looked up at run time so the plugin doesn't have to link it
+    (it's only there when the host made its context with EGL)
+*/
+struct FXShaderCompiler::Context {
+    bool egl;
+    // EGL
+    void* display;
+    void* context;
+    void* surface;
+    EGLBoolean (*makeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+    EGLBoolean (*bindAPI)(EGLenum);
+    EGLBoolean (*destroyContext)(EGLDisplay, EGLContext);
+    EGLBoolean (*destroySurface)(EGLDisplay, EGLSurface);
+    // GLX
+    Display* xdisplay;
+    GLXContext xcontext;
+    GLXPbuffer xpbuffer;
+};
+
+FXShaderCompiler* FXShaderCompiler::Acquire() {
+    return FXResourceRegistry::Acquire<FXShaderCompiler>("FXShaderCompiler", []{ return new FXShaderCompiler(); }, [](FXShaderCompiler* c){ delete c; });
+}
+
+// last one out stops the worker and deletes anything unclaimed, call while the context is current
+void FXShaderCompiler::Release(FXShaderCompiler* compiler) {
+    FXResourceRegistry::Release(compiler);
+}
+
+const char* FXShaderCompiler::PathName(FXCOMPILEPATH p) {
+    switch (p) {
+        case FXCOMPILE_KHR: return "khr";
+        case FXCOMPILE_THREAD: return "thread";
+        case FXCOMPILE_SYNC: return "sync";
+        default: return "auto";
+    }
+}
+
+FXShaderCompiler::FXShaderCompiler() {
+    nextJob = 1;
+    context = 0;
+    stopping = false;
+
+    FXCOMPILEPATH want = FXCOMPILE_AUTO;
+    const char* env = getenv("FXSHADER_ASYNC");
+    if (env && !strcmp(env, "khr")) want = FXCOMPILE_KHR;
+    if (env && !strcmp(env, "thread")) want = FXCOMPILE_THREAD;
+    if (env && !strcmp(env, "sync")) want = FXCOMPILE_SYNC;
+
+    path = FXCOMPILE_SYNC;
+    if (want == FXCOMPILE_AUTO || want == FXCOMPILE_KHR) {
+        if (HasGLExtension("GL_KHR_parallel_shader_compile")) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);      // as many as the driver likes
+            path = FXCOMPILE_KHR;
+        }else if (HasGLExtension("GL_ARB_parallel_shader_compile")) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+            path = FXCOMPILE_KHR;
+        }
+    }
+    if (path == FXCOMPILE_SYNC && (want == FXCOMPILE_AUTO || want == FXCOMPILE_THREAD)) {
+        if (StartWorker(want == FXCOMPILE_THREAD)) path = FXCOMPILE_THREAD;
+    }
+    cache.Open(FXProgramCache::DefaultDir());
+}
+
+FXShaderCompiler::~FXShaderCompiler() {
+    if (context) {
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+        if (context->egl) {
+            context->destroyContext(context->display, context->context);
+            if (context->surface) context->destroySurface(context->display, context->surface);
+        }else {
+            glXDestroyContext(context->xdisplay, context->xcontext);
+            glXDestroyPbuffer(context->xdisplay, context->xpbuffer);
+        }
+        delete context;
+        context = 0;
+    }
+    for (std::map<int, Job>::iterator i = jobs.begin(); i != jobs.end(); ++i) {
+        if (i->second.program) glDeleteProgram(i->second.program);
+        if (i->second.vs) glDeleteShader(i->second.vs);
+        if (i->second.fs) glDeleteShader(i->second.fs);
+    }
+}
+
+/**
+    a context in the host's share group, made here (the host's is current) and used by the worker
+*/
+bool FXShaderCompiler::StartWorker(bool allowGLX) {
+    Context c;
+    memset(&c, 0, sizeof(c));
+
+    typedef EGLContext (*GetCurrentContext)();
+    typedef EGLDisplay (*GetCurrentDisplay)();
+    GetCurrentContext eglGetCurrentContext_ = (GetCurrentContext)dlsym(RTLD_DEFAULT, "eglGetCurrentContext");
+    GetCurrentDisplay eglGetCurrentDisplay_ = (GetCurrentDisplay)dlsym(RTLD_DEFAULT, "eglGetCurrentDisplay");
+    EGLContext current = eglGetCurrentContext_ ? eglGetCurrentContext_() : EGL_NO_CONTEXT;
+
+    if (current != EGL_NO_CONTEXT) {
+        EGLBoolean (*queryContext)(EGLDisplay, EGLContext, EGLint, EGLint*) =
+            (EGLBoolean (*)(EGLDisplay, EGLContext, EGLint, EGLint*))dlsym(RTLD_DEFAULT, "eglQueryContext");
+        EGLBoolean (*chooseConfig)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*) =
+            (EGLBoolean (*)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*))dlsym(RTLD_DEFAULT, "eglChooseConfig");
+        EGLContext (*createContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint*) =
+            (EGLContext (*)(EGLDisplay, EGLConfig, EGLContext, const EGLint*))dlsym(RTLD_DEFAULT, "eglCreateContext");
+        EGLSurface (*createPbuffer)(EGLDisplay, EGLConfig, const EGLint*) =
+            (EGLSurface (*)(EGLDisplay, EGLConfig, const EGLint*))dlsym(RTLD_DEFAULT, "eglCreatePbufferSurface");
+        const char* (*queryString)(EGLDisplay, EGLint) = (const char* (*)(EGLDisplay, EGLint))dlsym(RTLD_DEFAULT, "eglQueryString");
+        c.makeCurrent = (EGLBoolean (*)(EGLDisplay, EGLSurface, EGLSurface, EGLContext))dlsym(RTLD_DEFAULT, "eglMakeCurrent");
+        c.bindAPI = (EGLBoolean (*)(EGLenum))dlsym(RTLD_DEFAULT, "eglBindAPI");
+        c.destroyContext = (EGLBoolean (*)(EGLDisplay, EGLContext))dlsym(RTLD_DEFAULT, "eglDestroyContext");
+        c.destroySurface = (EGLBoolean (*)(EGLDisplay, EGLSurface))dlsym(RTLD_DEFAULT, "eglDestroySurface");
+        if (!queryContext || !chooseConfig || !createContext || !createPbuffer || !queryString ||
+            !c.makeCurrent || !c.bindAPI || !c.destroyContext || !c.destroySurface) return false;
+
+        EGLDisplay display = eglGetCurrentDisplay_();
+        EGLint configId = 0;
+        EGLConfig config = EGL_NO_CONFIG_KHR;
+        EGLint found = 0;
+        queryContext(display, current, EGL_CONFIG_ID, &configId);
+        if (configId > 0) {
+            EGLint want[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+            chooseConfig(display, want, &config, 1, &found);
+        }
+        EGLContext ctx = createContext(display, config, current, 0);
+        if (ctx == EGL_NO_CONTEXT) return false;
+
+        // no surface needed to compile, a 1x1 pbuffer if the display insists
+        const char* ext = queryString(display, EGL_EXTENSIONS);
+        EGLSurface surface = EGL_NO_SURFACE;
+        if (!ext || !strstr(ext, "EGL_KHR_surfaceless_context")) {
+            EGLint size[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            if (found) surface = createPbuffer(display, config, size);
+            if (surface == EGL_NO_SURFACE) {
+                c.destroyContext(display, ctx);
+                return false;
+            }
+        }
+        c.egl = true;
+        c.display = display;
+        c.context = ctx;
+        c.surface = surface;
+    }else if (allowGLX && glXGetCurrentContext()) {
+        Display* dpy = glXGetCurrentDisplay();
+        GLXContext share = glXGetCurrentContext();
+        int configId = 0;
+        glXQueryContext(dpy, share, GLX_FBCONFIG_ID, &configId);
+        int want[] = {GLX_FBCONFIG_ID, configId, None};
+        int found = 0;
+        GLXFBConfig* configs = glXChooseFBConfig(dpy, DefaultScreen(dpy), want, &found);
+        if (!configs || found < 1) return false;
+        int size[] = {GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None};
+        c.xpbuffer = glXCreatePbuffer(dpy, configs[0], size);
+        c.xcontext = glXCreateNewContext(dpy, configs[0], GLX_RGBA_TYPE, share, True);
+        XFree(configs);
+        if (!c.xcontext) {
+            glXDestroyPbuffer(dpy, c.xpbuffer);
+            return false;
+        }
+        c.xdisplay = dpy;
+    }else {
+        return false;
+    }
+
+    context = new Context(c);
+    worker = std::thread(&FXShaderCompiler::WorkerLoop, this);
+    return true;
+}
+
+void FXShaderCompiler::WorkerLoop() {
+    if (context->egl) {
+        context->bindAPI(EGL_OPENGL_API);
+        context->makeCurrent(context->display, context->surface, context->surface, context->context);
+    }else {
+        glXMakeContextCurrent(context->xdisplay, context->xpbuffer, context->xpbuffer, context->xcontext);
+    }
+
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    while (true) {
+        while (!stopping && queue.empty()) wake.wait(lock);
+        if (stopping) break;
+        int id = queue.front();
+        queue.pop_front();
+        string vert = jobs[id].vert;
+        string frag = jobs[id].frag;
+        lock.unlock();
+
+        string log;
+        GLuint p = Build(vert, frag, log);
+        // done on this context before the render thread can use it
+        glFinish();
+
+        lock.lock();
+        Job& j = jobs[id];
+        if (j.cancelled) {
+            if (p) glDeleteProgram(p);
+            jobs.erase(id);
+            continue;
+        }
+        j.program = p;
+        j.log = log;
+        j.state = p ? FXCOMPILE_READY : FXCOMPILE_FAILED;
+    }
+
+    if (context->egl) {
+        context->makeCurrent(context->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }else {
+        glXMakeContextCurrent(context->xdisplay, None, None, 0);
+    }
+}
+
+// compile and link, waiting on the result
+GLuint FXShaderCompiler::Build(const string& vert, const string& frag, string& log) {
+    const char* src[2] = {vert.c_str(), frag.c_str()};
+    GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    GLuint s[2] = {0, 0};
+    bool ok = true;
+    for (int i = 0; i < 2 && ok; i++) {
+        s[i] = glCreateShader(types[i]);
+        glShaderSource(s[i], 1, &src[i], 0);
+        glCompileShader(s[i]);
+        GLint compiled = 0;
+        glGetShaderiv(s[i], GL_COMPILE_STATUS, &compiled);
+        if (!compiled) {
+            char buffer[1024];
+            glGetShaderInfoLog(s[i], sizeof(buffer), 0, buffer);
+            log = buffer;
+            ok = false;
+        }
+    }
+    GLuint p = 0;
+    if (ok) {
+        p = glCreateProgram();
+        glAttachShader(p, s[0]);
+        glAttachShader(p, s[1]);
+        FXProgramCache::PrepareLink(p);
+        glLinkProgram(p);
+        GLint linked = 0;
+        glGetProgramiv(p, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char buffer[1024];
+            glGetProgramInfoLog(p, sizeof(buffer), 0, buffer);
+            log = buffer;
+            glDeleteProgram(p);
+            p = 0;
+        }
+    }
+    for (int i = 0; i < 2; i++) if (s[i]) glDeleteShader(s[i]);
+    return p;
+}
+
+int FXShaderCompiler::Submit(const string& vert, const string& frag) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    int id = nextJob++;
+    Job& j = jobs[id];
+    j.vs = j.fs = j.program = 0;
+    j.state = FXCOMPILE_PENDING;
+    j.cancelled = false;
+    j.key = cache.Key(vert, frag);
+    j.program = cache.Load(j.key);
+    j.cached = j.program != 0;
+
+    if (j.cached) {
+        j.state = FXCOMPILE_READY;
+    }else if (path == FXCOMPILE_THREAD) {
+        j.vert = vert;
+        j.frag = frag;
+        queue.push_back(id);
+        wake.notify_one();
+    }else if (path == FXCOMPILE_KHR) {
+        // everything queued with the driver, nothing here asks for a status until Poll
+        const char* vs = vert.c_str();
+        const char* fs = frag.c_str();
+        j.vs = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(j.vs, 1, &vs, 0);
+        glCompileShader(j.vs);
+        j.fs = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(j.fs, 1, &fs, 0);
+        glCompileShader(j.fs);
+        j.program = glCreateProgram();
+        glAttachShader(j.program, j.vs);
+        glAttachShader(j.program, j.fs);
+        FXProgramCache::PrepareLink(j.program);
+        glLinkProgram(j.program);
+    }else {
+        j.program = Build(vert, frag, j.log);
+        j.state = j.program ? FXCOMPILE_READY : FXCOMPILE_FAILED;
+    }
+    return id;
+}
+
+// KHR: finished yet? then did it work
+void FXShaderCompiler::Check(Job& j) {
+    GLint done = 0;
+    glGetProgramiv(j.program, GL_COMPLETION_STATUS_KHR, &done);
+    if (!done) return;
+
+    GLint linked = 0;
+    glGetProgramiv(j.program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char buffer[1024];
+        GLint compiled = 0;
+        glGetShaderiv(j.fs, GL_COMPILE_STATUS, &compiled);
+        if (!compiled) glGetShaderInfoLog(j.fs, sizeof(buffer), 0, buffer);
+        else glGetProgramInfoLog(j.program, sizeof(buffer), 0, buffer);
+        j.log = buffer;
+        glDeleteProgram(j.program);
+        j.program = 0;
+    }
+    glDeleteShader(j.vs);
+    glDeleteShader(j.fs);
+    j.vs = j.fs = 0;
+    j.state = linked ? FXCOMPILE_READY : FXCOMPILE_FAILED;
+}
+
+FXCOMPILESTATE FXShaderCompiler::Poll(int job) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    std::map<int, Job>::iterator i = jobs.find(job);
+    if (i == jobs.end()) return FXCOMPILE_FAILED;
+    if (i->second.state == FXCOMPILE_PENDING && path == FXCOMPILE_KHR) Check(i->second);
+    return i->second.state;
+}
+
+GLuint FXShaderCompiler::Take(int job, string* log) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    std::map<int, Job>::iterator i = jobs.find(job);
+    if (i == jobs.end() || i->second.state == FXCOMPILE_PENDING) return 0;
+    GLuint p = i->second.program;
+    if (log) *log = i->second.log;
+    // linked on the worker's context is fine too, it was finished before the job was ready
+    if (p && !i->second.cached) cache.Store(i->second.key, p);
+    jobs.erase(i);
+    return p;
+}
+
+void FXShaderCompiler::Cancel(int job) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    std::map<int, Job>::iterator i = jobs.find(job);
+    if (i == jobs.end()) return;
+    Job& j = i->second;
+    if (path == FXCOMPILE_THREAD && j.state == FXCOMPILE_PENDING) {
+        std::deque<int>::iterator q = std::find(queue.begin(), queue.end(), job);
+        if (q == queue.end()) {
+            // being built right now, the worker deletes it
+            j.cancelled = true;
+            return;
+        }
+        queue.erase(q);
+    }
+    if (j.program) glDeleteProgram(j.program);
+    if (j.vs) glDeleteShader(j.vs);
+    if (j.fs) glDeleteShader(j.fs);
+    jobs.erase(i);
+}
+
+FXPROGRAMCACHESTATS FXShaderCompiler::CacheStats() {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    return cache.Stats();
+}
+
+int FXShaderCompiler::Pending() {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    int n = 0;
+    for (std::map<int, Job>::iterator i = jobs.begin(); i != jobs.end(); ++i) {
+        if (i->second.state == FXCOMPILE_PENDING) n++;
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------------
+
+FXFileWatch::FXFileWatch() {
+    workers = 0;
+    interval = 500000000LL;
+    lastCheck = 0;
+}
+
+FXFileWatch::~FXFileWatch() {
+    Close();
+}
+
+void FXFileWatch::Open(string filename, FXWorkerPool* pool, int intervalMs) {
+    Close();
+    path = filename;
+    workers = pool;
+    interval = (int64_t)intervalMs * 1000000LL;
+    lastCheck = 0;
+    state = std::make_shared<State>();
+    state->busy = false;
+    state->changed = false;
+    state->mtime = state->size = -1;
+}
+
+// a check still running just finishes on its own (it holds the state)
+void FXFileWatch::Close() {
+    workers = 0;
+    state.reset();
+}
+
+bool FXFileWatch::Poll(string& text) {
+    if (!workers) return false;
+
+    std::shared_ptr<State> s = state;
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->changed) {
+            s->changed = false;
+            text.swap(s->text);
+            return true;
+        }
+        if (s->busy) return false;
+    }
+
+    int64_t now = NowNs();
+    if (now - lastCheck < interval) return false;
+    lastCheck = now;
+
+    // stat and read on a worker, a slow disk/network share never holds up a frame
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->busy = true;
+    }
+    string filename = path;
+    workers->Submit([s, filename]() {
+        struct stat st;
+        string text;
+        bool changed = false;
+        if (stat(filename.c_str(), &st) == 0) {
+            long long mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+            std::unique_lock<std::mutex> lock(s->mutex);
+            changed = mtime != s->mtime || (long long)st.st_size != s->size;
+            lock.unlock();
+            if (changed) {
+                FILE* f = fopen(filename.c_str(), "rb");
+                if (f) {
+                    char buffer[4096];
+                    size_t n;
+                    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) text.append(buffer, n);
+                    fclose(f);
+                    lock.lock();
+                    s->mtime = mtime;
+                    s->size = st.st_size;
+                    lock.unlock();
+                }else {
+                    changed = false;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (changed) {
+            s->text = text;
+            s->changed = true;
+        }
+        s->busy = false;
+    });
+    return false;
+}
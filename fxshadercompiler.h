@@ -0,0 +1,146 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Background shader compiles
+
+    A big fragment shader can take hundreds of ms to compile/link, FXShaderCompiler builds
+    programs without the render thread waiting on them:
+
+        KHR     GL_KHR_parallel_shader_compile (or the ARB one), the driver compiles on its own
+                threads, Poll just asks GL_COMPLETION_STATUS_KHR so never blocks
+        THREAD  a worker thread with its own context sharing objects with the host's,
+                programs are linked there and finished (glFinish) before Poll sees them
+                (EGL hosts, or GLX when asked for, the host's Xlib must be XInitThreads safe)
+        SYNC    built in Submit like before, for drivers with neither
+
+    AUTO picks KHR, then THREAD over EGL, then SYNC, FXSHADER_ASYNC=khr/thread/sync overrides it.
+    One compiler per process shared by all instances, Acquire while the context is current.
+
+    Programs go through an FXProgramCache in FXProgramCache::DefaultDir(), Submit loads a cached
+    binary when there is one (the job is ready straight away) and Take stores what was linked
+    from source, so only the first start on a machine pays for the compiles.
+
+    usage:
+        int job = compiler->Submit(vert, frag);
+        ... each frame
+        if (compiler->Poll(job) != FXCOMPILE_PENDING) program = compiler->Take(job, &log);   // 0 if it failed
+
+    FXFileWatch is for shader development, it checks a file a couple of times a second on the
+    worker pool and hands back the new text when it changes (eg into FXShaderVariants::Reload),
+    FXSHADER_WATCH=path/frag.glsl turns it on in the example plugin.
+*/
+
+#ifndef FXSHADERCOMPILER_H
+#define FXSHADERCOMPILER_H
+
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "fxpluginstructures.h"
+#include "fxworkers.h"
+#include "fxprogramcache.h"
+
+enum FXCOMPILEPATH {
+    FXCOMPILE_AUTO,
+    FXCOMPILE_KHR,
+    FXCOMPILE_THREAD,
+    FXCOMPILE_SYNC
+};
+
+enum FXCOMPILESTATE {
+    FXCOMPILE_PENDING,
+    FXCOMPILE_READY,
+    FXCOMPILE_FAILED
+};
+
+class FXShaderCompiler
+{
+    public:
+        // one compiler per process, shared between instances (context must be current)
+        static FXShaderCompiler* Acquire();
+        static void Release(FXShaderCompiler* compiler);
+
+        int Submit(const string& vert, const string& frag);
+        FXCOMPILESTATE Poll(int job);
+        // the linked program (now the caller's) or 0, the job is forgotten either way
+        GLuint Take(int job, string* log = 0);
+        // not wanted any more, the program is deleted whenever it turns up
+        void Cancel(int job);
+
+        int Pending();
+        FXCOMPILEPATH Path() { return path; }
+        FXPROGRAMCACHESTATS CacheStats();
+        static const char* PathName(FXCOMPILEPATH p);
+    protected:
+    private:
+        FXShaderCompiler();
+        virtual ~FXShaderCompiler();
+
+        struct Job {
+            string vert, frag;
+            GLuint vs, fs;
+            GLuint program;
+            FXCOMPILESTATE state;
+            bool cancelled;
+            string log;
+            uint64_t key;
+            bool cached;            // loaded from the cache, nothing to store
+        };
+
+        FXCOMPILEPATH path;
+        FXProgramCache cache;
+        std::map<int, Job> jobs;
+        int nextJob;
+
+        // THREAD
+        struct Context;
+        Context* context;
+        std::thread worker;
+        std::mutex jobsMutex;
+        std::condition_variable wake;
+        std::deque<int> queue;
+        bool stopping;
+
+        bool StartWorker(bool allowGLX);
+        void WorkerLoop();
+        static GLuint Build(const string& vert, const string& frag, string& log);
+        static void Check(Job& j);
+};
+
+class FXFileWatch
+{
+    public:
+        FXFileWatch();
+        virtual ~FXFileWatch();
+
+        void Open(string filename, FXWorkerPool* pool, int intervalMs = 500);
+        void Close();
+        bool Watching() { return workers != 0; }
+        string Filename() { return path; }
+
+        // true once per change, text is the whole file
+        bool Poll(string& text);
+    protected:
+    private:
+        struct State {
+            std::mutex mutex;
+            bool busy;
+            bool changed;
+            long long mtime;
+            long long size;
+            string text;
+        };
+
+        string path;
+        FXWorkerPool* workers;
+        std::shared_ptr<State> state;
+        int64_t interval;
+        int64_t lastCheck;
+};
+
+#endif // FXSHADERCOMPILER_H
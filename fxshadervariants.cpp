@@ -0,0 +1,242 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Shader variants (see fxshadervariants.h)
+*/
+
+#include "fxshadervariants.h"
+
+#include <time.h>
+#include <string.h>
+#include <algorithm>
+
+map<uint64_t, FXShaderVariants::Entry> FXShaderVariants::entries;
+
+static uint64_t Hash64(const string& s, uint64_t h = 14695981039346656037ULL) {
+    for (size_t i = 0; i <= s.size(); i++) h = (h ^ (unsigned char)s.c_str()[i]) * 1099511628211ULL;
+    return h;
+}
+
+static int64_t NowNs() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+FXShaderVariants::FXShaderVariants() {
+    base = 0;
+    compiler = 0;
+    combinations = 1;
+    active = prewarmed = ready = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+FXShaderVariants::~FXShaderVariants() {
+    // empty, programs are released in Deinit while the context is still current
+}
+
+void FXShaderVariants::Init(const FXSHADER* programShader, string fragText, string vertText) {
+    Drop(built, compiler);
+    Drop(previous, compiler);
+    base = programShader;
+    frag = fragText;
+    vert = vertText;
+    keys.clear();
+    combinations = 1;
+    active = prewarmed = ready = false;
+    built.assign(1, (Entry*)0);
+    previous.assign(1, (Entry*)0);
+    queue.clear();
+    error = "";
+}
+
+void FXShaderVariants::Deinit() {
+    Drop(built, compiler);
+    Drop(previous, compiler);
+    queue.clear();
+    FXShaderCompiler::Release(compiler);
+    compiler = 0;
+    base = 0;
+}
+
+int FXShaderVariants::AddKey(string define, int states) {
+    if (states < 1 || (int)keys.size() >= FXVARIANT_MAXKEYS || combinations * states > FXVARIANT_MAXCOMBINATIONS) return -1;
+    // the combination numbering changes, so anything built so far is let go
+    Drop(built, compiler);
+    Drop(previous, compiler);
+    queue.clear();
+    Key k;
+    k.define = define;
+    k.states = states;
+    k.value = 0;
+    keys.push_back(k);
+    combinations *= states;
+    built.assign(combinations, (Entry*)0);
+    previous.assign(combinations, (Entry*)0);
+    active = true;
+    return (int)keys.size() - 1;
+}
+
+void FXShaderVariants::Set(int key, int value) {
+    if (key < 0 || key >= (int)keys.size()) return;
+    keys[key].value = max(0, min(value, keys[key].states - 1));
+}
+
+// mixed radix, key 0 is the lowest digit
+int FXShaderVariants::Combination() {
+    int c = 0;
+    for (int k = (int)keys.size() - 1; k >= 0; k--) c = c * keys[k].states + keys[k].value;
+    return c;
+}
+
+string FXShaderVariants::Text(int combination) {
+    string defines;
+    for (unsigned int k = 0; k < keys.size(); k++) {
+        char line[128];
+        snprintf(line, sizeof(line), "#define %s %d\n", keys[k].define.c_str(), combination % keys[k].states);
+        defines += line;
+        combination /= keys[k].states;
+    }
+    // defines have to go after #version
+    size_t at = 0;
+    if (frag.compare(0, 8, "#version") == 0) {
+        at = frag.find('\n');
+        at = at == string::npos ? frag.size() : at + 1;
+    }
+    return frag.substr(0, at) + defines + frag.substr(at);
+}
+
+void FXShaderVariants::Reload(string fragText) {
+    if (fragText == frag) return;
+    // whatever has linked stays on screen until its replacement has
+    for (int c = 0; c < combinations; c++) {
+        Entry* e = built[c];
+        if (!e) continue;
+        if (e->state == FXCOMPILE_READY) {
+            vector<Entry*> one(1, previous[c]);
+            Drop(one, compiler);
+            previous[c] = e;
+        }else {
+            vector<Entry*> one(1, e);
+            Drop(one, compiler);
+        }
+        built[c] = 0;
+    }
+    queue.clear();
+    frag = fragText;
+    active = true;
+    stats.reloads++;
+    if (prewarmed) Prewarm();
+}
+
+FXSHADER* FXShaderVariants::Select() {
+    ready = false;
+    if (!base || !active) return 0;
+    if (!compiler) compiler = FXShaderCompiler::Acquire();
+
+    int c = Combination();
+    if (!built[c]) {
+        // wanted now, goes ahead of anything prewarming (and is the only submit this frame)
+        queue.erase(std::remove(queue.begin(), queue.end(), c), queue.end());
+        built[c] = Build(c);
+    }else {
+        while (!queue.empty() && built[queue.front()]) queue.pop_front();
+        if (!queue.empty()) {
+            int next = queue.front();
+            queue.pop_front();
+            built[next] = Build(next);
+        }
+    }
+
+    // anything in flight (cheap, a status query each)
+    for (int i = 0; i < combinations; i++) {
+        if (built[i] && built[i]->state == FXCOMPILE_PENDING) Finish(built[i]);
+    }
+
+    Entry* e = built[c];
+    if (e->state == FXCOMPILE_READY) {
+        if (previous[c]) {
+            vector<Entry*> one(1, previous[c]);
+            Drop(one, compiler);
+            previous[c] = 0;
+        }
+        ready = true;
+        return &e->shader;
+    }
+    // reloaded text still compiling (or broken), keep the last good one
+    if (previous[c]) return &previous[c]->shader;
+    return 0;
+}
+
+void FXShaderVariants::Prewarm() {
+    prewarmed = true;
+    for (int c = 0; c < combinations; c++) {
+        if (!built[c] && std::find(queue.begin(), queue.end(), c) == queue.end()) queue.push_back(c);
+    }
+}
+
+FXShaderVariants::Entry* FXShaderVariants::Build(int combination) {
+    string text = Text(combination);
+    uint64_t key = Hash64(text, Hash64(vert));
+
+    map<uint64_t, Entry>::iterator found = entries.find(key);
+    if (found != entries.end()) {
+        found->second.refs++;
+        stats.shared++;
+        return &found->second;
+    }
+
+    int64_t start = NowNs();
+    Entry& e = entries[key];
+    e.refs = 1;
+    e.key = key;
+    e.program = 0;
+    e.state = FXCOMPILE_PENDING;
+    e.submitted = start;
+    e.job = compiler->Submit(vert, text);
+
+    int64_t took = NowNs() - start;
+    stats.submitNs += took;
+    stats.maxSubmitNs = max(stats.maxSubmitNs, took);
+    Finish(&e);     // the sync path is already done
+    return &e;
+}
+
+void FXShaderVariants::Finish(Entry* e) {
+    if (compiler->Poll(e->job) == FXCOMPILE_PENDING) return;
+
+    string log;
+    e->program = compiler->Take(e->job, &log);
+    e->job = 0;
+    stats.maxWaitNs = max(stats.maxWaitNs, NowNs() - e->submitted);
+    if (!e->program) {
+        e->state = FXCOMPILE_FAILED;
+        stats.failed++;
+        error = log;
+        return;
+    }
+
+    // a copy of the program entry, pointing at this program
+    e->shader = *base;
+    e->shader.t = 2;
+    e->shader.id = e->program;
+    e->shader.error = false;
+    for (int i = 0; i < e->shader.paramCount; i++) {
+        e->shader.params[i].id = glGetUniformLocation(e->program, e->shader.params[i].name.c_str());
+    }
+    e->state = FXCOMPILE_READY;
+    stats.compiled++;
+}
+
+// last set using a program deletes it (or cancels the build), so call while the context is current
+void FXShaderVariants::Drop(vector<Entry*>& list, FXShaderCompiler* compiler) {
+    for (unsigned int c = 0; c < list.size(); c++) {
+        Entry* e = list[c];
+        list[c] = 0;
+        if (!e || --e->refs > 0) continue;
+        if (e->state == FXCOMPILE_PENDING && compiler) compiler->Cancel(e->job);
+        if (e->program) glDeleteProgram(e->program);
+        entries.erase(e->key);
+    }
+}
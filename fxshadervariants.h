@@ -0,0 +1,143 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Shader variants
+
+    Toggles and selectors that only change when the user flips them don't need a branch in
+    the fragment shader. Each one becomes a key, its value a #define (0..states-1) inserted
+    after the #version line, and every combination is its own program:
+
+        #if MIRROR
+          uv = abs(mod(uv + 1.0, 2.0) - 1.0);
+        #endif
+
+    Combinations are submitted to FXShaderCompiler when first selected (Prewarm queues the rest,
+    one submitted per frame after that) and shared between instances by text, so the second
+    instance never compiles anything. Each variant carries its own copy of the program's
+    FXSHADER with the uniform locations looked up, so FXUniforms and params[].id work as usual.
+
+    Select() returns 0 until the variant has linked (or if it failed), draw with the host compiled
+    program meanwhile (the same text with the keys as uniforms, or the defaults). With no keys
+    Activate() builds the text as is, so a heavy shader can be built in the background with a cheap
+    host program as the stand in. Reload swaps in new text (see FXFileWatch), the old programs
+    keep drawing until the new ones link, and for good if they don't.
+
+    usage:
+        CreateShaders: variants.Init(&fx->shaders[1], fx->shaders[0].text);
+                       mirrorKey = variants.AddKey("MIRROR", 2);
+        Update:        if (fx->interfaceparams[p].update) variants.Set(mirrorKey, fx->interfaceparams[p].curValue);
+        Process:       FXSHADER* s = variants.Select();
+                       if (!s) s = &fx->shaders[1];            // or pass the source through
+                       uniforms.Attach(s); gl->UseProgram(s->id); uniforms.Apply();
+        Deinit:        variants.Deinit();      // context current
+*/
+
+#ifndef FXSHADERVARIANTS_H
+#define FXSHADERVARIANTS_H
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <map>
+
+#include "fxpluginstructures.h"
+#include "fxshadercompiler.h"
+
+#define FXVARIANT_MAXKEYS 8
+#define FXVARIANT_MAXCOMBINATIONS 256
+
+// same as the host's 000-1TextureVert, for #version 120 frag shaders drawn with DrawQuad
+#define FXVARIANT_VERT120 \
+    "#version 120\n" \
+    "void main(){\n" \
+    "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n" \
+    "  gl_TexCoord[0] = gl_MultiTexCoord0;\n" \
+    "}\n"
+
+struct FXVARIANTSTATS {
+    long compiled;              // linked by this set (not found in the shared cache)
+    long shared;                // already linked/submitted by another instance
+    long failed;
+    long reloads;
+    int64_t submitNs;           // render thread time spent submitting (all of the build on the sync path)
+    int64_t maxSubmitNs;        // worst single submit (the frame it was on)
+    int64_t maxWaitNs;          // longest submit to linked, frames went on meanwhile
+};
+
+class FXShaderVariants
+{
+    public:
+        FXShaderVariants();
+        virtual ~FXShaderVariants();
+
+        // programShader is only read for its param names (at link time, so params added later count)
+        void Init(const FXSHADER* programShader, string fragText, string vertText = FXVARIANT_VERT120);
+        void Deinit();
+
+        // returns the key index, -1 if it would take the set past FXVARIANT_MAXCOMBINATIONS
+        int AddKey(string define, int states);
+        void Set(int key, int value);
+        int Get(int key) { return key >= 0 && key < (int)keys.size() ? keys[key].value : 0; }
+        int Keys() { return (int)keys.size(); }
+        int Combinations() { return combinations; }
+        int Combination();
+
+        // build the text even with no keys
+        void Activate() { active = true; }
+        // new frag text, the previous programs are used until the new ones have linked
+        void Reload(string fragText);
+
+        // program for the current key values, 0 until it has linked (or if it failed)
+        FXSHADER* Select();
+        // current combination linked, only valid after Select
+        bool Ready() { return ready; }
+        // queue every combination, submitted one per Select after the current one
+        void Prewarm();
+        int Pending() { return (int)queue.size(); }
+        FXCOMPILEPATH CompilePath() { return compiler ? compiler->Path() : FXCOMPILE_AUTO; }
+
+        // the frag text of a combination, defines in
+        string Text(int combination);
+        string Error() { return error; }
+        FXVARIANTSTATS Stats() { return stats; }
+    protected:
+    private:
+        struct Key {
+            string define;
+            int states;
+            int value;
+        };
+        // one linked program, shared by every set with the same text
+        struct Entry {
+            int refs;
+            uint64_t key;
+            int job;                    // compiler job while pending
+            int64_t submitted;
+            FXCOMPILESTATE state;
+            GLuint program;
+            FXSHADER shader;
+        };
+
+        const FXSHADER* base;
+        FXShaderCompiler* compiler;     // acquired on the first Select (context current)
+        string vert, frag;
+        vector<Key> keys;
+        int combinations;
+        bool active;
+        bool prewarmed;
+        bool ready;
+        vector<Entry*> built;           // per combination, 0 until submitted
+        vector<Entry*> previous;        // before the last Reload, drawn until built[] links
+        std::deque<int> queue;
+        string error;
+        FXVARIANTSTATS stats;
+
+        static map<uint64_t, Entry> entries;
+
+        Entry* Build(int combination);
+        void Finish(Entry* e);
+        static void Drop(vector<Entry*>& list, FXShaderCompiler* compiler);
+};
+
+#endif // FXSHADERVARIANTS_H
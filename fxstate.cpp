@@ -0,0 +1,132 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    State snapshots (see fxstate.h)
+*/
+
+#include "fxstate.h"
+
+#include <string.h>
+
+#define FIELD_HEADER 6      // uint32 tag + uint16 length
+
+FXStateWriter::FXStateWriter(vector<unsigned char>& b, int v, uint32_t hash) {
+    buffer = &b;
+    version = v;
+    schemaHash = hash;
+    fieldCount = 0;
+    buffer->resize(sizeof(FXSTATEHEADER));
+}
+
+void FXStateWriter::PutBytes(uint32_t tag, const void* data, unsigned int size) {
+    if (size > 0xFFFF) return;
+    size_t pos = buffer->size();
+    buffer->resize(pos + FIELD_HEADER + size);
+    unsigned char* p = &(*buffer)[pos];
+    uint16_t length = (uint16_t)size;
+    memcpy(p, &tag, 4);
+    memcpy(p + 4, &length, 2);
+    if (size) memcpy(p + FIELD_HEADER, data, size);
+    fieldCount++;
+}
+
+void FXStateWriter::PutInt(uint32_t tag, int32_t value) {
+    PutBytes(tag, &value, sizeof(value));
+}
+
+void FXStateWriter::PutFloat(uint32_t tag, float value) {
+    PutBytes(tag, &value, sizeof(value));
+}
+
+void FXStateWriter::PutDouble(uint32_t tag, double value) {
+    PutBytes(tag, &value, sizeof(value));
+}
+
+const void* FXStateWriter::Data() {
+    FXSTATEHEADER header;
+    header.magic = FXSTATE_MAGIC;
+    header.version = (uint16_t)version;
+    header.fieldCount = (uint16_t)fieldCount;
+    header.schemaHash = schemaHash;
+    header.size = (uint32_t)buffer->size();
+    memcpy(&(*buffer)[0], &header, sizeof(header));
+    return &(*buffer)[0];
+}
+
+//----------------------------------------------------------------------------
+
+FXStateReader::FXStateReader() {
+    data = 0;
+    memset(&header, 0, sizeof(header));
+}
+
+bool FXStateReader::Open(const void* d, int size) {
+    data = 0;
+    if (!d || size < (int)sizeof(FXSTATEHEADER)) return false;
+    memcpy(&header, d, sizeof(header));
+    if (header.magic != FXSTATE_MAGIC || header.size != (uint32_t)size) return false;
+
+    // walk the fields once so Find never has to bounds check
+    const unsigned char* p = (const unsigned char*)d + sizeof(FXSTATEHEADER);
+    const unsigned char* end = (const unsigned char*)d + size;
+    for (int i = 0; i < header.fieldCount; i++) {
+        if (end - p < FIELD_HEADER) return false;
+        uint16_t length;
+        memcpy(&length, p + 4, 2);
+        p += FIELD_HEADER + length;
+        if (p > end) return false;
+    }
+    data = (const unsigned char*)d;
+    return true;
+}
+
+const unsigned char* FXStateReader::Find(uint32_t tag, unsigned int& size) {
+    if (!data) return 0;
+    const unsigned char* p = data + sizeof(FXSTATEHEADER);
+    for (int i = 0; i < header.fieldCount; i++) {
+        uint32_t t;
+        uint16_t length;
+        memcpy(&t, p, 4);
+        memcpy(&length, p + 4, 2);
+        if (t == tag) {
+            size = length;
+            return p + FIELD_HEADER;
+        }
+        p += FIELD_HEADER + length;
+    }
+    return 0;
+}
+
+bool FXStateReader::Has(uint32_t tag) {
+    unsigned int size;
+    return Find(tag, size) != 0;
+}
+
+const void* FXStateReader::GetBytes(uint32_t tag, unsigned int& size) {
+    return Find(tag, size);
+}
+
+bool FXStateReader::GetInt(uint32_t tag, int32_t& value) {
+    unsigned int size;
+    const unsigned char* p = Find(tag, size);
+    if (!p || size != sizeof(value)) return false;
+    memcpy(&value, p, sizeof(value));
+    return true;
+}
+
+bool FXStateReader::GetFloat(uint32_t tag, float& value) {
+    unsigned int size;
+    const unsigned char* p = Find(tag, size);
+    if (!p || size != sizeof(value)) return false;
+    memcpy(&value, p, sizeof(value));
+    return true;
+}
+
+bool FXStateReader::GetDouble(uint32_t tag, double& value) {
+    unsigned int size;
+    const unsigned char* p = Find(tag, size);
+    if (!p || size != sizeof(value)) return false;
+    memcpy(&value, p, sizeof(value));
+    return true;
+}
@@ -0,0 +1,164 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    State snapshots
+
+    A small tagged binary format for GetState/SetState:
+
+        FXSTATEHEADER       magic, version, field count, schema hash, total size
+        fields              uint32 tag, uint16 length, length bytes (no padding, little endian)
+
+    Tags are hashes of the field names (FXStateTag("Red")), so fields can be added, removed
+    or reordered without breaking older snapshots, anything missing just keeps its value.
+    The schema hash says which layout wrote it (eg FXParamTable::schemaHash).
+
+    FXStateStore keeps the plugin's own buffers per instance, so they stop touching the heap
+    once they have grown to size:
+        Snapshot/Publish    writes into a staging buffer, then hands the host a new[] copy of
+                            exactly the blob (the host keeps and frees it, as it always has)
+        Upgrade             runs an older snapshot through the plugin's migration table (each
+                            step writes the next version into a scratch buffer) and returns a
+                            reader on the result, current snapshots are read where they are
+*/
+
+#ifndef FXSTATE_H
+#define FXSTATE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "fxpluginstructures.h"
+
+#define FXSTATE_MAGIC 0x54534656    // "VFST"
+#define FXSTATE_MAXMIGRATIONS 32    // steps before giving up (a loop in the table)
+
+struct FXSTATEHEADER {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t fieldCount;
+    uint32_t schemaHash;
+    uint32_t size;              // whole blob including this header
+};
+
+// FNV-1a, compile time when used on a literal
+constexpr uint32_t FXStateHash(const char* s, uint32_t h = 2166136261u) {
+    return *s ? FXStateHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+constexpr uint32_t FXStateHashInt(uint32_t v, uint32_t h, int bytes = 4) {
+    return bytes ? FXStateHashInt(v >> 8, (h ^ (v & 0xFF)) * 16777619u, bytes - 1) : h;
+}
+constexpr uint32_t FXStateTag(const char* name) {
+    return FXStateHash(name);
+}
+
+class FXStateWriter
+{
+    public:
+        // starts a new blob in buffer, keeping its capacity
+        FXStateWriter(vector<unsigned char>& buffer, int version, uint32_t schemaHash);
+
+        void PutInt(uint32_t tag, int32_t value);
+        void PutFloat(uint32_t tag, float value);
+        void PutDouble(uint32_t tag, double value);
+        void PutBytes(uint32_t tag, const void* data, unsigned int size);
+
+        int Version() { return version; }
+        // finishes the header
+        const void* Data();
+        int Size() { return (int)buffer->size(); }
+    protected:
+    private:
+        vector<unsigned char>* buffer;
+        int version;
+        uint32_t schemaHash;
+        int fieldCount;
+};
+
+class FXStateReader
+{
+    public:
+        FXStateReader();
+
+        // checks the header and that every field fits, nothing is copied
+        bool Open(const void* data, int size);
+
+        int Version() { return header.version; }
+        uint32_t SchemaHash() { return header.schemaHash; }
+        int FieldCount() { return header.fieldCount; }
+
+        bool Has(uint32_t tag);
+        bool GetInt(uint32_t tag, int32_t& value);
+        bool GetFloat(uint32_t tag, float& value);
+        bool GetDouble(uint32_t tag, double& value);
+        const void* GetBytes(uint32_t tag, unsigned int& size);
+    protected:
+    private:
+        const unsigned char* data;
+        FXSTATEHEADER header;
+
+        const unsigned char* Find(uint32_t tag, unsigned int& size);
+};
+
+/**
+    per instance snapshot buffers and migrations, T is the plugin class
+
+    migration table entries upgrade fromVersion to toVersion, eg
+        { 1, 3, &PluginPrivateObject::MigrateState1 },
+        { 2, 3, &PluginPrivateObject::MigrateState2 }
+    a step reads the old FXSTATE (raw struct or an older tagged blob) and writes the new fields
+*/
+template<class T> class FXStateStore
+{
+    public:
+        struct Migration {
+            int fromVersion;
+            int toVersion;
+            bool (T::*migrate)(const FXSTATE& in, FXStateWriter& out);
+        };
+
+        FXStateWriter Snapshot(int version, uint32_t schemaHash) {
+            return FXStateWriter(staging, version, schemaHash);
+        }
+
+        // the host owns state.data from here on (DO NOT delete/free it in the plugin)
+        void Publish(FXStateWriter& w, FXSTATE& state) {
+            const void* data = w.Data();
+            unsigned char* copy = new unsigned char[w.Size()];
+            memcpy(copy, data, w.Size());
+            state.version = w.Version();
+            state.size = w.Size();
+            state.data = (void*)copy;
+        }
+
+        bool Upgrade(T* owner, const FXSTATE* in, int currentVersion, const Migration* table, int count, FXStateReader& out) {
+            if (!in || !in->data) return false;
+
+            FXSTATE cur = *in;
+            int steps = 0;
+            int s = 0;
+            while (cur.version != currentVersion) {
+                const Migration* m = 0;
+                for (int i = 0; i < count; i++) {
+                    if (table[i].fromVersion == cur.version) m = &table[i];
+                }
+                if (!m || ++steps > FXSTATE_MAXMIGRATIONS) return false;
+
+                // ping pong between the scratch buffers, the host's blob is never written to
+                FXStateWriter w(scratch[s], m->toVersion, 0);
+                s ^= 1;
+                if (!(owner->*(m->migrate))(cur, w)) return false;
+                cur.data = (void*)w.Data();
+                cur.size = w.Size();
+                cur.version = m->toVersion;
+            }
+            return out.Open(cur.data, cur.size) && out.Version() == currentVersion;
+        }
+    protected:
+    private:
+        vector<unsigned char> staging;
+        vector<unsigned char> scratch[2];
+};
+
+#endif // FXSTATE_H
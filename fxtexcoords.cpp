@@ -0,0 +1,58 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Texcoord remap (see fxtexcoords.h)
+*/
+
+#include "fxtexcoords.h"
+
+FXTexCoords::FXTexCoords() {
+    wrap = FXWRAP_CLAMP;
+    fit = FXFIT_STRETCH;
+    tile[0] = tile[1] = 1.0f;
+    pan[0] = pan[1] = 0.0f;
+    Update(1, 1, 1.0f, 1.0f, 1, 1);
+}
+
+void FXTexCoords::SetTile(float x, float y, float panX, float panY) {
+    tile[0] = x;
+    tile[1] = y;
+    pan[0] = panX;
+    pan[1] = panY;
+}
+
+void FXTexCoords::Update(const FXSOURCE& source, int targetWidth, int targetHeight) {
+    // w/h are the whole texture (0 when a source plugin is rendering as the source, that's a full
+    // texture at the output size), the image is tx2/ty2 of it
+    if (!source.w || !source.h) Update(targetWidth, targetHeight, 1.0f, 1.0f, targetWidth, targetHeight);
+    else Update((int)(source.w * source.tx2 + 0.5f), (int)(source.h * source.ty2 + 0.5f), source.tx2, source.ty2, targetWidth, targetHeight);
+}
+
+void FXTexCoords::Update(int width, int height, float tx2, float ty2, int targetWidth, int targetHeight) {
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    if (targetWidth < 1) targetWidth = 1;
+    if (targetHeight < 1) targetHeight = 1;
+
+    // how much of the image one target width/height covers
+    float sx = 1.0f, sy = 1.0f;
+    float aspect = ((float)width / height) / ((float)targetWidth / targetHeight);
+    if (fit == FXFIT_CONTAIN) {
+        if (aspect > 1.0f) sy = aspect;
+        else sx = 1.0f / aspect;
+    }else if (fit == FXFIT_COVER) {
+        if (aspect > 1.0f) sx = 1.0f / aspect;
+        else sy = aspect;
+    }
+    // centred, then tiled/panned
+    values[0] = sx * tile[0];
+    values[1] = sy * tile[1];
+    values[2] = 0.5f - 0.5f * values[0] + pan[0];
+    values[3] = 0.5f - 0.5f * values[1] + pan[1];
+    values[4] = tx2;
+    values[5] = ty2;
+    values[6] = 0.5f * tx2 / width;
+    values[7] = 0.5f * ty2 / height;
+    values[8] = (float)wrap;
+}
@@ -0,0 +1,97 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Texcoord remap
+
+    Sources come in as the bottom left w x h of a bigger texture (tx2/ty2 < 1), so a shader that
+    wants 0-1 texcoords, GL_REPEAT/GL_MIRRORED_REPEAT or its own aspect used to copy the source into
+    bufferA first (a full screen read and write every frame). FXTEXCOORDS_GLSL does it in the shader
+    instead, from one float[] uniform:
+
+        fit     stretch, contain (letterboxed, whole image) or cover (cropped, no borders), from the
+                source and target aspect, plus an optional tile/pan on top
+        wrap    clamp, repeat, mirrored repeat or border (transparent outside), done on the 0-1
+                image coords so the unused part of the texture is never touched
+        tx2/ty2 the 0-1 result scaled into the used part, clamped half a texel in so linear
+                filtering doesn't pick up whatever is beyond it
+
+    With nearest filtering it's the same texel the copy would have given. Linear is within a bit or
+    two (the GPU rounds filter weights per texture size), except repeat/border along the seam where
+    the copy's hardware wrap blended across the edge, fxbench -uvcheck compares the two.
+
+    usage (see CreateTexCoordParams/ApplyTexCoords in pluginprivateobject.cpp):
+        InitPlugin: CreateTexCoordParams(id); and FXTEXCOORDS_GLSL in the frag text
+                    texCoords.SetWrap(FXWRAP_MIRROR); texCoords.SetFit(FXFIT_COVER);
+        Process:    ApplyTexCoords(); before uniforms.Apply(), draw the quad with 0-1 texcoords
+    shader:
+        vec4 c = fxTexture(tex0, gl_TexCoord[0].xy);    // or texture2D(tex0, fxRemapUV(uv)) for the coords
+*/
+
+#ifndef FXTEXCOORDS_H
+#define FXTEXCOORDS_H
+
+#include "fxpluginstructures.h"
+
+enum FXTEXWRAP {
+    FXWRAP_CLAMP,
+    FXWRAP_REPEAT,
+    FXWRAP_MIRROR,
+    FXWRAP_BORDER
+};
+
+enum FXTEXFIT {
+    FXFIT_STRETCH,
+    FXFIT_CONTAIN,
+    FXFIT_COVER
+};
+
+#define FXTEXCOORDS_FLOATS 9
+
+// fxUV[0-3] scale/offset to image coords, [4-5] tx2/ty2, [6-7] half a texel, [8] wrap
+#define FXTEXCOORDS_GLSL \
+    "uniform float fxUV[9];\n" \
+    "vec2 fxImageUV(vec2 uv) { return uv * vec2(fxUV[0], fxUV[1]) + vec2(fxUV[2], fxUV[3]); }\n" \
+    "vec2 fxRemapUV(vec2 uv) {\n" \
+    "  uv = fxImageUV(uv);\n" \
+    "  if (fxUV[8] > 1.5 && fxUV[8] < 2.5) uv = 1.0 - abs(mod(uv, 2.0) - 1.0);\n" \
+    "  else if (fxUV[8] > 0.5 && fxUV[8] < 1.5) uv = fract(uv);\n" \
+    "  vec2 used = vec2(fxUV[4], fxUV[5]);\n" \
+    "  vec2 inset = vec2(fxUV[6], fxUV[7]);\n" \
+    "  return clamp(uv * used, inset, used - inset);\n" \
+    "}\n" \
+    "vec4 fxTexture(sampler2D t, vec2 uv) {\n" \
+    "  vec4 c = texture2D(t, fxRemapUV(uv));\n" \
+    "  if (fxUV[8] > 2.5) {\n" \
+    "    vec2 p = fxImageUV(uv);\n" \
+    "    if (any(lessThan(p, vec2(0.0))) || any(greaterThan(p, vec2(1.0)))) c = vec4(0.0);\n" \
+    "  }\n" \
+    "  return c;\n" \
+    "}\n"
+
+class FXTexCoords
+{
+    public:
+        FXTexCoords();
+
+        void SetWrap(FXTEXWRAP mode) { wrap = mode; }
+        void SetFit(FXTEXFIT mode) { fit = mode; }
+        // repeats across the target and where the first one starts (in image widths), on top of the fit
+        void SetTile(float x, float y, float panX = 0.0f, float panY = 0.0f);
+        FXTEXWRAP Wrap() { return wrap; }
+        FXTEXFIT Fit() { return fit; }
+
+        // works out fxUV for a source drawn at targetWidth x targetHeight, width/height are the image (not the texture)
+        void Update(const FXSOURCE& source, int targetWidth, int targetHeight);
+        void Update(int width, int height, float tx2, float ty2, int targetWidth, int targetHeight);
+
+        const float* Values() { return values; }
+    protected:
+    private:
+        FXTEXWRAP wrap;
+        FXTEXFIT fit;
+        float tile[2], pan[2];
+        float values[FXTEXCOORDS_FLOATS];
+};
+
+#endif // FXTEXCOORDS_H
@@ -0,0 +1,112 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Integer time base (see fxtime.h)
+*/
+
+#include "fxtime.h"
+
+FXTime::FXTime() {
+    rateNum = 25;
+    rateDen = 1;
+    now = delta = 0;
+    mediaNs = prevMediaNs = 0;
+    speedCarry = 0;
+    started = false;
+    lastEffectStart = -1;
+    ResetStats();
+}
+
+void FXTime::SetFrameRate(int num, int den) {
+    if (num <= 0 || den <= 0) return;
+    rateNum = num;
+    rateDen = den;
+}
+
+void FXTime::Reset(const FXOBJECT* fx) {
+    now = ToNs(fx->curTime);
+    delta = 0;
+    mediaNs = prevMediaNs = 0;
+    speedCarry = 0;
+    started = true;
+}
+
+void FXTime::Tick(const FXOBJECT* fx) {
+    int64_t t = ToNs(fx->curTime);
+    if (!started) Reset(fx);
+
+    delta = t - now;
+    if (delta < 0) {
+        // never run the media clock backwards off the host clock, only globalReverse does that
+        backwards++;
+        delta = 0;
+    }
+    now = max(now, t);
+
+    // speed as 8.24, the bits shifted out are kept for the next tick so nothing is lost
+    int64_t speed = (int64_t)llround(fabs(fx->globalSpeed) * (1 << FXTIME_SPEEDBITS));
+    int64_t scaled = min(delta, (int64_t)FXTIME_MAXSTEP_NS) * speed + speedCarry;
+    int64_t step = scaled >> FXTIME_SPEEDBITS;
+    speedCarry = scaled - (step << FXTIME_SPEEDBITS);
+
+    prevMediaNs = mediaNs;
+    mediaNs += fx->globalReverse ? -step : step;
+
+    // welford, only over real steps (not the first tick after a reset)
+    if (delta > 0) {
+        ticks++;
+        minNs = ticks == 1 ? delta : min(minNs, delta);
+        maxNs = max(maxNs, delta);
+        if (ticks > 8 && delta > mean * 1.5) late++;
+        double d = delta - mean;
+        mean += d / ticks;
+        m2 += d * (delta - mean);
+    }
+}
+
+// a new trigger, once it's due (the host sets it to curTime on the frame the effect starts)
+bool FXTime::EffectStarted(const FXOBJECT* fx, int source) {
+    double stamp = fx->source[source].effectStartTimestamp;
+    if (stamp <= 0 || stamp == lastEffectStart) return false;
+    if (ToNs(stamp) > ToNs(fx->curTime) + FXTIME_MATCH_NS) return false;
+    lastEffectStart = stamp;
+    return true;
+}
+
+// floor, so reverse steps back through frame -1, -2..
+int64_t FXTime::FrameAt(int64_t ns) {
+    int64_t n = ns * rateNum;
+    int64_t d = 1000000000LL * rateDen;
+    int64_t f = n / d;
+    if (n % d < 0) f--;
+    return f;
+}
+
+double FXTime::FramePosition() {
+    int64_t f = FrameAt(mediaNs);
+    int64_t rest = mediaNs * rateNum - f * 1000000000LL * rateDen;
+    return f + (double)rest / (1000000000.0 * rateDen);
+}
+
+double FXTime::FramesTravelledExact() {
+    return (double)(mediaNs - prevMediaNs) * rateNum / (1000000000.0 * rateDen);
+}
+
+FXTIMESTATS FXTime::Stats() {
+    FXTIMESTATS s;
+    s.ticks = ticks;
+    s.minNs = minNs;
+    s.maxNs = maxNs;
+    s.meanNs = mean;
+    s.jitterNs = ticks > 1 ? sqrt(m2 / (ticks - 1)) : 0;
+    s.backwards = backwards;
+    s.late = late;
+    return s;
+}
+
+void FXTime::ResetStats() {
+    ticks = backwards = late = 0;
+    minNs = maxNs = 0;
+    mean = m2 = 0;
+}
@@ -0,0 +1,92 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Integer time base
+
+    fx->curTime as int64 nanoseconds (a double of ns since the epoch is ~1.7e18, past 2^53,
+    so it only has ~256ns steps and never compares exactly), plus a media clock that follows
+    globalSpeed/globalReverse without drifting:
+
+        Tick            once per frame, real ns since the last tick go through the speed as
+                        8.24 fixed point, the fraction is carried to the next tick
+        MediaNs/Frame   position since Reset, frames are worked out from the total each time
+                        (never summed), so a 10 hour show is still on the exact frame
+        FramesTravelled whole frames this tick (negative in reverse), the exact version keeps
+                        the fraction for smooth motion
+        EffectStarted   true once for each new effectStartTimestamp (within FXTIME_MATCH_NS of
+                        curTime, the host's double can't be compared exactly)
+        Stats           real frame time min/max/mean/jitter, backwards steps and late frames
+
+    usage:
+        InitPlugin:     clock.SetFrameRate(25); clock.Reset(fx);
+        Process:        if (clock.EffectStarted(fx)) clock.Reset(fx);
+                        clock.Tick(fx); offset += clock.FramesTravelledExact() * speed;
+*/
+
+#ifndef FXTIME_H
+#define FXTIME_H
+
+#include <stdint.h>
+
+#include "fxpluginstructures.h"
+
+#define FXTIME_MATCH_NS 1024        // a few steps of a double timestamp
+#define FXTIME_SPEEDBITS 24        // speed fraction, as fine as the float it comes from
+#define FXTIME_MAXSTEP_NS 10000000000LL     // longer gaps (a stall/pause) only move the media clock this far
+
+struct FXTIMESTATS {
+    long ticks;
+    int64_t minNs, maxNs;           // real time between ticks
+    double meanNs;
+    double jitterNs;                // standard deviation
+    long backwards;                 // host time went back (ignored, counted here)
+    long late;                      // ticks over 1.5x the mean (dropped/stalled frames)
+};
+
+class FXTime
+{
+    public:
+        FXTime();
+
+        // frame length is exactly 1E9 * den / num ns (eg 30000/1001)
+        void SetFrameRate(int num, int den = 1);
+        // media clock back to 0 at fx->curTime
+        void Reset(const FXOBJECT* fx);
+        void Tick(const FXOBJECT* fx);
+
+        bool EffectStarted(const FXOBJECT* fx, int source = 0);
+
+        int64_t Now() { return now; }
+        int64_t Delta() { return delta; }
+        int64_t MediaNs() { return mediaNs; }
+        int64_t Frame() { return FrameAt(mediaNs); }
+        double FramePosition();
+        int64_t FramesTravelled() { return FrameAt(mediaNs) - FrameAt(prevMediaNs); }
+        double FramesTravelledExact();
+        int64_t FrameNs() { return (1000000000LL * rateDen) / rateNum; }
+
+        FXTIMESTATS Stats();
+        void ResetStats();
+
+        static int64_t ToNs(const struct timespec& t) { return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec; }
+        static int64_t ToNs(double ns) { return (int64_t)llround(ns); }
+    protected:
+    private:
+        int64_t rateNum, rateDen;
+        int64_t now;
+        int64_t delta;
+        int64_t mediaNs, prevMediaNs;
+        int64_t speedCarry;         // fraction of a ns left over from the fixed point speed
+        bool started;
+        double lastEffectStart;
+
+        // stats
+        long ticks, backwards, late;
+        int64_t minNs, maxNs;
+        double mean, m2;
+
+        int64_t FrameAt(int64_t ns);
+};
+
+#endif // FXTIME_H
@@ -0,0 +1,197 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Cached shader uniforms (see fxuniforms.h)
+*/
+
+#include "fxuniforms.h"
+
+#include <sstream>
+#include <algorithm>
+
+map<GLuint, FXUniforms::ProgramShadow> FXUniforms::shadows;
+
+FXUniforms::FXUniforms() {
+    shader = 0;
+    program = 0;
+    shadow = 0;
+    anyDirty = false;
+    uploads = 0;
+}
+
+FXUniforms::~FXUniforms() {
+    Detach();
+}
+
+// same shader again is a no-op, so it can be called every frame (eg with the selected variant)
+void FXUniforms::Attach(FXSHADER* programShader) {
+    if (programShader == shader) return;
+    Detach();
+    shader = programShader;
+}
+
+void FXUniforms::Detach() {
+    if (shadow) {
+        if (shadow->owner == this) shadow->owner = 0;
+        if (--shadow->refs == 0) shadows.erase(program);
+    }
+    shadow = 0;
+    program = 0;
+    shader = 0;
+}
+
+/**
+    (re)connect to the shadow of the program the host gave us
+*/
+void FXUniforms::Resolve() {
+    FXSHADER* s = shader;
+    Detach();
+    shader = s;
+
+    program = shader->id;
+    shadow = &shadows[program];
+    shadow->refs++;
+
+    // new program, everything we hold has to go up at least once
+    for (unsigned int p = 0; p < values.size(); p++) values[p].dirty = true;
+    anyDirty = true;
+}
+
+FXUniforms::Value& FXUniforms::Slot(int param, int type) {
+    if ((int)values.size() <= param) {
+        Value empty;
+        empty.type = type;
+        empty.dirty = false;
+        values.resize(param + 1, empty);
+    }
+    values[param].type = type;
+    return values[param];
+}
+
+void FXUniforms::Set1i(int param, int value) {
+    Value& s = Slot(param, 0);
+    if (s.v.size() == 1 && s.v[0] == (float)value) return;
+    s.v.assign(1, (float)value);
+    s.dirty = anyDirty = true;
+}
+
+void FXUniforms::Set1f(int param, float value) {
+    Value& s = Slot(param, 1);
+    if (s.v.size() == 1 && s.v[0] == value) return;
+    s.v.assign(1, value);
+    s.dirty = anyDirty = true;
+}
+
+void FXUniforms::Set1fv(int param, int index, float value) {
+    Value& s = Slot(param, 1);
+    if ((int)s.v.size() > index && s.v[index] == value) return;
+    if ((int)s.v.size() <= index) s.v.resize(index + 1, 0.0f);
+    s.v[index] = value;
+    s.dirty = anyDirty = true;
+}
+
+void FXUniforms::Set1fv(int param, int count, const float* v) {
+    Value& s = Slot(param, 1);
+    if ((int)s.v.size() == count && equal(s.v.begin(), s.v.end(), v)) return;
+    s.v.assign(v, v + count);
+    s.dirty = anyDirty = true;
+}
+
+void FXUniforms::Apply() {
+    if (!shader || shader->id == 0) return;
+    if ((GLuint)shader->id != program || !shadow) Resolve();
+
+    // nothing changed and nobody else has touched the program since our last upload
+    bool foreign = shadow->owner != this;
+    if (!anyDirty && !foreign) return;
+
+    for (unsigned int p = 0; p < values.size() && (int)p < shader->paramCount; p++) {
+        Value& s = values[p];
+        if (!s.dirty && !foreign) continue;
+        s.dirty = false;
+
+        GLint loc = shader->params[p].id;
+        if (loc < 0 || s.v.empty()) continue;
+
+        vector<float>& up = shadow->uploaded[loc];
+        if (up == s.v) continue;
+
+        if (s.type == 0) {
+            if (s.v.size() == 1) {
+                glUniform1i(loc, (int)s.v[0]);
+            }else {
+                vector<GLint> ints(s.v.begin(), s.v.end());
+                glUniform1iv(loc, ints.size(), &ints[0]);
+            }
+        }else {
+            glUniform1fv(loc, s.v.size(), &s.v[0]);
+        }
+        up = s.v;
+        uploads++;
+    }
+
+    shadow->owner = this;
+    anyDirty = false;
+}
+
+//----------------------------------------------------------------------------
+
+FXUniformBuffer::FXUniformBuffer(string blockName, int vec4Count, GLuint bindingPoint) {
+    name = blockName;
+    binding = bindingPoint;
+    ubo = 0;
+    data.assign(vec4Count * 4, 0.0f);
+    dirtyMin = 0;
+    dirtyMax = data.size() - 1;
+}
+
+FXUniformBuffer::~FXUniformBuffer() {
+    // empty, the buffer is released in Deinit while the context is still current
+}
+
+void FXUniformBuffer::Deinit() {
+    if (ubo) glDeleteBuffers(1, &ubo);
+    ubo = 0;
+}
+
+string FXUniformBuffer::Declaration(string arrayName) {
+    std::stringstream s;
+    s << "layout(std140) uniform " << name << " { vec4 " << arrayName << "[" << (data.size() / 4) << "]; };\n";
+    return s.str();
+}
+
+void FXUniformBuffer::Attach(GLuint program) {
+    GLuint index = glGetUniformBlockIndex(program, name.c_str());
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, binding);
+}
+
+void FXUniformBuffer::Set(int index, float value) {
+    if (index < 0 || index >= (int)data.size() || data[index] == value) return;
+    data[index] = value;
+    if (dirtyMin > dirtyMax) {
+        dirtyMin = dirtyMax = index;
+    }else {
+        if (index < dirtyMin) dirtyMin = index;
+        if (index > dirtyMax) dirtyMax = index;
+    }
+}
+
+void FXUniformBuffer::Apply() {
+    if (!ubo) {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, data.size() * sizeof(float), &data[0], GL_DYNAMIC_DRAW);
+        dirtyMin = 1;
+        dirtyMax = 0;
+    }else if (dirtyMin <= dirtyMax) {
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, dirtyMin * sizeof(float), (dirtyMax - dirtyMin + 1) * sizeof(float), &data[dirtyMin]);
+        dirtyMin = 1;
+        dirtyMax = 0;
+    }
+
+    // other instances use the same binding point, so always rebind ours
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,102 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Cached shader uniforms
+
+    FXUniforms wraps the params of one FXSHADER program (as set up with CreateShaderParam).
+    Values are set when they change (ie from Update) and Apply() only uploads what is dirty,
+    so a frame where nothing changed costs no glUniform calls at all.
+
+    Shaders with the same name are shared by all instances, so the values last uploaded to each
+    program are shadowed per program (not per instance). When another instance has used the
+    program since our last Apply, only the values that differ from the shadow are uploaded.
+
+    FXUniformBuffer is the optional uniform buffer object version for #version 140+ shaders:
+    one block per instance that any number of its programs read, uploaded with a single
+    glBufferSubData of the changed range.
+
+    usage:
+        InitPlugin:    uniforms.Attach(&fx->shaders[1]); uniforms.Set1i(0, 0);
+        Update:        if (fx->interfaceparams[p].update) uniforms.Set1fv(1, 0, value);
+        Process:       gl->UseProgram(fx->shaders[1].id); uniforms.Apply();
+*/
+
+#ifndef FXUNIFORMS_H
+#define FXUNIFORMS_H
+
+#include <vector>
+#include <map>
+
+#include "fxpluginstructures.h"
+
+class FXUniforms
+{
+    public:
+        FXUniforms();
+        virtual ~FXUniforms();
+
+        void Attach(FXSHADER* programShader);   // params[].id can still be unset (host compiles after Init)
+        void Detach();
+
+        // param is the index used in CreateShaderParam
+        void Set1i(int param, int value);
+        void Set1f(int param, float value);
+        void Set1fv(int param, int index, float value);         // one element of a float[] uniform
+        void Set1fv(int param, int count, const float* values);
+
+        // the program must already be bound
+        void Apply();
+
+        unsigned long UploadCount() { return uploads; }
+    protected:
+    private:
+        struct Value {
+            int type;               // 0-int, 1-float (as FXSHADERPARAMS)
+            vector<float> v;
+            bool dirty;
+        };
+        // last values uploaded to a program, whoever uploaded them
+        struct ProgramShadow {
+            const FXUniforms* owner;
+            int refs;
+            map<GLint, vector<float> > uploaded;
+        };
+
+        FXSHADER* shader;
+        GLuint program;             // program the shadow below belongs to
+        ProgramShadow* shadow;
+        vector<Value> values;
+        bool anyDirty;
+        unsigned long uploads;
+
+        static map<GLuint, ProgramShadow> shadows;
+
+        Value& Slot(int param, int type);
+        void Resolve();
+};
+
+class FXUniformBuffer
+{
+    public:
+        // vec4Count vec4s in the block (params are addressed as floats, 4 to a vec4)
+        FXUniformBuffer(string blockName, int vec4Count, GLuint bindingPoint);
+        virtual ~FXUniformBuffer();
+
+        // shader text for the block, eg "layout(std140) uniform FXParams { vec4 fxp[8]; };"
+        string Declaration(string arrayName);
+
+        void Attach(GLuint program);            // once per program after the host has compiled it
+        void Set(int index, float value);
+        void Apply();                           // upload changed range and bind to the binding point
+        void Deinit();
+    protected:
+    private:
+        string name;
+        GLuint binding;
+        GLuint ubo;
+        vector<float> data;
+        int dirtyMin, dirtyMax;
+};
+
+#endif // FXUNIFORMS_H
@@ -0,0 +1,102 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Worker pool (see fxworkers.h)
+*/
+
+#include "fxworkers.h"
+#include "fxresources.h"
+
+FXWorkerPool* FXWorkerPool::Acquire() {
+    return FXResourceRegistry::Acquire<FXWorkerPool>("FXWorkerPool", []{
+        int cores = (int)std::thread::hardware_concurrency();
+        return new FXWorkerPool(cores > 2 ? cores - 1 : 1);
+    }, [](FXWorkerPool* p){ delete p; });
+}
+
+// last one out waits for the queue to drain and stops the threads
+void FXWorkerPool::Release(FXWorkerPool* pool) {
+    FXResourceRegistry::Release(pool);
+}
+
+FXWorkerPool::FXWorkerPool(int threadCount) {
+    busy = 0;
+    stopping = false;
+    for (int i = 0; i < threadCount; i++) threads.push_back(std::thread(&FXWorkerPool::WorkerLoop, this));
+}
+
+FXWorkerPool::~FXWorkerPool() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueWake.notify_all();
+    for (unsigned int i = 0; i < threads.size(); i++) threads[i].join();
+}
+
+void FXWorkerPool::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(job);
+    }
+    queueWake.notify_one();
+}
+
+int FXWorkerPool::Queued() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return (int)queue.size() + busy;
+}
+
+void FXWorkerPool::Wait() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    idleWake.wait(lock, [this]{ return queue.empty() && busy == 0; });
+}
+
+void FXWorkerPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    for (;;) {
+        queueWake.wait(lock, [this]{ return stopping || !queue.empty(); });
+        if (queue.empty()) return;   // stopping
+
+        std::function<void()> job = queue.front();
+        queue.pop_front();
+        busy++;
+        lock.unlock();
+        job();
+        lock.lock();
+        busy--;
+        if (queue.empty() && busy == 0) idleWake.notify_all();
+    }
+}
+
+// takes job indices until there are none left, helpers that start late just find nothing to do
+void FXWorkerPool::Work(std::shared_ptr<Batch> batch) {
+    int i;
+    while ((i = batch->next.fetch_add(1)) < batch->jobs) {
+        batch->job(i);
+        batch->done.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void FXWorkerPool::Run(int jobs, std::function<void(int)> job) {
+    if (jobs <= 0) return;
+    if (jobs == 1 || threads.empty()) {
+        for (int i = 0; i < jobs; i++) job(i);
+        return;
+    }
+
+    std::shared_ptr<Batch> batch(new Batch());
+    batch->job = job;
+    batch->jobs = jobs;
+    batch->next = 0;
+    batch->done = 0;
+
+    int helpers = min(jobs - 1, (int)threads.size());
+    for (int h = 0; h < helpers; h++) Submit([batch]{ Work(batch); });
+
+    // the caller does its share rather than sleeping, so a Run from a worker can't deadlock
+    Work(batch);
+    while (batch->done.load(std::memory_order_acquire) < jobs) std::this_thread::yield();
+}
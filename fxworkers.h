@@ -0,0 +1,70 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Worker pool
+
+    A handful of threads shared by all instances (one per core less one, the render thread
+    keeps its own core). Two ways to use it:
+
+    Submit : fire and forget, eg compressing and writing a captured frame
+    Run    : parallel for over n jobs, the calling thread works on the jobs too and only
+             returns once all of them are done, safe to call from inside a Submit job
+
+    Never call GL from a job, there is no context on the worker threads.
+*/
+
+#ifndef FXWORKERS_H
+#define FXWORKERS_H
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+#include "fxpluginstructures.h"
+
+class FXWorkerPool
+{
+    public:
+        // one pool per process, shared between instances
+        static FXWorkerPool* Acquire();
+        static void Release(FXWorkerPool* pool);
+
+        void Submit(std::function<void()> job);
+        void Run(int jobs, std::function<void(int)> job);
+
+        // waits for everything submitted so far
+        void Wait();
+
+        int Threads() { return (int)threads.size(); }
+        int Queued();
+    protected:
+    private:
+        FXWorkerPool(int threadCount);
+        virtual ~FXWorkerPool();
+
+        struct Batch {
+            std::function<void(int)> job;
+            int jobs;
+            std::atomic<int> next;
+            std::atomic<int> done;
+        };
+
+        vector<std::thread> threads;
+        std::deque< std::function<void()> > queue;
+        std::mutex queueMutex;
+        std::condition_variable queueWake;
+        std::condition_variable idleWake;
+        int busy;
+        bool stopping;
+
+        void WorkerLoop();
+        static void Work(std::shared_ptr<Batch> batch);
+};
+
+#endif // FXWORKERS_H
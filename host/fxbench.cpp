@@ -0,0 +1,972 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    fxbench - frame latency benchmark over a matrix of output and source sizes
+
+    For every output size x source size it runs the plugin in the headless host and reports
+    p50/p95/p99/max wall and GPU time for Update, Process and any internal stages
+    (build the plugin with -DFX_PROFILE to see Process120Example etc).
+
+    Results can be written as JSON and/or CSV so runs can be diffed.
+
+    -codec n adds the capture suite: the plugin output at each output size is written raw,
+    encoded with fxcodec, encoded+written and decoded n times each, reported as ms per frame
+    plus MB/s of raw frame data (writes are fdatasync'd, into -codecdir, default the current dir).
+    -audio n adds the audio suite: fxaudio analysis of n host SynthAudio updates on each code path
+    (scalar/sse2/avx2, whichever the CPU has) plus a cached lookup, each path checked against scalar.
+    -coldstart n adds the start suite: StartInstance plus the first frame n times each with every
+    shader compiled from source, with an empty program cache (compile + store) and a warm one
+    (binaries loaded), cache in -shadercache dir (default ./fxbench-shadercache, emptied after).
+    Mesa keeps its own shader cache too, MESA_SHADER_CACHE_DISABLE=true shows true source
+    compiles (but then has no binary formats, so the cache rows are skipped).
+    -uvcheck n compares FXTEXCOORDS_GLSL against the squaring copy it replaced (first source drawn
+    at the first output size), every wrap/fit/filter pixel for pixel, then times both n times,
+    exits 1 if they don't match (nearest exactly, linear within 2/255 off the seam).
+    -mixer n times FXLayerMixer's one pass against a pass per layer at the biggest output size,
+    n times each, with the two results compared.
+    -noise n adds the noise suite: fxnoise white noise on each path (checked against scalar), perlin
+    and blue noise generation n times each, then a blue noise tile through the library made with an
+    empty disk cache, loaded back from it n times (checked against the one made) and shared n times,
+    cache in -noisecache dir (default ./fxbench-noisecache, emptied after).
+    -frames 0 skips the frame timings.
+    (also needs ../fxcodec.cpp ../fxworkers.cpp ../fxaudio.cpp ../fxprogramcache.cpp ../fxtexcoords.cpp ../fxmixer.cpp ../fxglstate.cpp
+     ../fxnoise.cpp ../fxresources.cpp)
+
+    usage: fxbench plugin.so [-frames n] [-warmup n] [-outputs WxH,WxH..] [-sources WxH,WxH..]
+                             [-codec n] [-codecdir dir] [-audio n] [-coldstart n] [-shadercache dir]
+                             [-uvcheck n] [-mixer n] [-noise n] [-noisecache dir] [-json file] [-csv file]
+*/
+
+#include "fxheadlesshost.h"
+#include "../fxcodec.h"
+#include "../fxworkers.h"
+#include "../fxaudio.h"
+#include "../fxtexcoords.h"
+#include "../fxmixer.h"
+#include "../fxnoise.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+// one line of results
+struct FXBENCHROW {
+    string suite;
+    string output;
+    string source;
+    float tx2, ty2;
+    string name;
+    unsigned int count;
+    double wall[4];         // p50, p95, p99, max (ms)
+    double gpu[4];          // same, -1 if not measured
+    double mbps;            // codec suite only, raw MB per second at p50, else -1
+    double ratio;           // codec suite only, raw size / stored size, else -1
+};
+
+static const char* defaultOutputs = "256x256,512x512,1280x720,1920x1080,2560x1440,3840x2160";
+// same image sizes VIDIFOLD sees from video files, so the tx2/ty2 ratios differ per row
+static const char* defaultSources = "720x576,1280x720,1024x1024,1920x1080,3840x2160";
+
+static void Usage() {
+    printf("usage: fxbench plugin.so [-frames n] [-warmup n] [-outputs WxH,WxH..] [-sources WxH,WxH..]\n"
+           "                         [-codec n] [-codecdir dir] [-audio n] [-coldstart n] [-shadercache dir]\n"
+           "                         [-uvcheck n] [-mixer n] [-noise n] [-noisecache dir] [-json file] [-csv file]\n");
+}
+
+static bool ParseSizes(string list, vector< pair<unsigned int,unsigned int> >& sizes) {
+    sizes.clear();
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) end = list.size();
+        unsigned int w, h;
+        if (sscanf(list.substr(start, end - start).c_str(), "%ux%u", &w, &h) != 2 || !w || !h) return false;
+        sizes.push_back(make_pair(w, h));
+        start = end + 1;
+    }
+    return !sizes.empty();
+}
+
+static string SizeLabel(unsigned int w, unsigned int h) {
+    char buf[32];
+    sprintf(buf, "%ux%u", w, h);
+    return buf;
+}
+
+/**
+    nearest rank percentiles of the samples, converted to ms
+    (fills -1 if there are no samples)
+*/
+static void Percentiles(vector<double> samples, double out[4]) {
+    if (samples.empty()) {
+        for (int i = 0; i < 4; i++) out[i] = -1;
+        return;
+    }
+    sort(samples.begin(), samples.end());
+    const double p[3] = {0.50, 0.95, 0.99};
+    for (int i = 0; i < 3; i++) {
+        size_t rank = (size_t)ceil(p[i] * samples.size());
+        if (rank < 1) rank = 1;
+        out[i] = samples[rank - 1] / 1E6;
+    }
+    out[3] = samples.back() / 1E6;
+}
+
+static void AddRow(vector<FXBENCHROW>& rows, const FXBENCHROW& base, const FXCALLTIMING& t) {
+    if (t.wallNs.empty()) return;
+    FXBENCHROW row = base;
+    row.name = t.name;
+    row.count = t.wallNs.size();
+    Percentiles(t.wallNs, row.wall);
+    Percentiles(t.gpuNs, row.gpu);
+    rows.push_back(row);
+}
+
+static bool WriteFile(string filename, const unsigned char* data, size_t size) {
+    FILE* f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, size, f) == size && fflush(f) == 0 && fdatasync(fileno(f)) == 0;
+    return (fclose(f) == 0) && ok;
+}
+
+/**
+    capture suite for one frame: raw write vs fxcodec encode, encode+write and decode
+*/
+static void CodecRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, const vector<unsigned char>& frame,
+                      unsigned int w, unsigned int h, long iterations, string dir, FXWorkerPool* pool) {
+    string tmp = dir + "/fxbench-codec.tmp";
+    vector<unsigned char> packed, decoded;
+    FXCALLTIMING t[4];
+    t[0].name = "raw write";
+    t[1].name = "fxq encode";
+    t[2].name = "fxq encode+write";
+    t[3].name = "fxq decode";
+
+    for (long i = 0; i < iterations; i++) {
+        double start = FXHeadlessHost::NowNs();
+        WriteFile(tmp, &frame[0], frame.size());
+        t[0].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+
+        start = FXHeadlessHost::NowNs();
+        FXCodec::Encode(&frame[0], w, h, packed, pool);
+        t[1].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+
+        start = FXHeadlessHost::NowNs();
+        FXCodec::Encode(&frame[0], w, h, packed, pool);
+        WriteFile(tmp, &packed[0], packed.size());
+        t[2].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+
+        start = FXHeadlessHost::NowNs();
+        unsigned int dw, dh;
+        bool ok = FXCodec::Decode(&packed[0], packed.size(), decoded, dw, dh, pool);
+        t[3].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+        if (!ok || decoded != frame) printf("fxbench: fxq round trip FAILED at %ux%u\n", w, h);
+    }
+    unlink(tmp.c_str());
+
+    for (int i = 0; i < 4; i++) {
+        size_t first = rows.size();
+        AddRow(rows, base, t[i]);
+        if (rows.size() == first) continue;
+        FXBENCHROW& r = rows.back();
+        r.mbps = r.wall[0] > 0 ? (frame.size() / 1E6) / (r.wall[0] / 1E3) : -1;
+        r.ratio = i == 0 ? 1.0 : (double)frame.size() / packed.size();
+    }
+}
+
+/**
+    start suite: every shader from source, then through an empty and a warm program cache
+    (the host keeps compiled programs between instances, so they are dropped each time)
+*/
+static bool StartRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, FXHeadlessHost& host,
+                      pair<unsigned int,unsigned int> output, pair<unsigned int,unsigned int> source,
+                      long iterations, string cacheDir) {
+    const char* names[3] = {"start source", "start cold cache", "start warm cache"};
+    FXProgramCache wipe;
+    bool cacheAvailable = wipe.Open(cacheDir);
+    if (!cacheAvailable) printf("fxbench: no program binary formats on this driver, cache rows skipped\n");
+
+    for (int mode = 0; mode < (cacheAvailable ? 3 : 1); mode++) {
+        FXCALLTIMING t;
+        t.name = names[mode];
+        FXHOSTSETUP setup = FXHeadlessHost::DefaultSetup();
+        setup.outputWidth = output.first;
+        setup.outputHeight = output.second;
+        setup.sourceWidth = source.first;
+        setup.sourceHeight = source.second;
+        setup.programCache = mode == 0 ? "" : cacheDir;
+
+        for (long i = 0; i < iterations; i++) {
+            host.ClearShaders();
+            if (mode == 1) wipe.Clear();
+            double start = FXHeadlessHost::NowNs();
+            if (!host.StartInstance(setup)) return false;
+            host.RunFrame();
+            glFinish();
+            t.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+            host.StopInstance();
+        }
+        AddRow(rows, base, t);
+    }
+    wipe.Clear();
+    rmdir(cacheDir.c_str());
+    return true;
+}
+
+/**
+    audio suite: Analyse on every path over the same updates, results compared to the scalar path
+*/
+static void AudioRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, long iterations, float bpm) {
+    // 60fps worth of overlapping buffers, made up front so only the analysis is timed
+    vector< vector<int16_t> > buffers(iterations);
+    for (long i = 0; i < iterations; i++) {
+        buffers[i].resize(FXHOST_AUDIOFRAMES * 2);
+        FXHeadlessHost::SynthAudio(&buffers[i][0], FXHOST_AUDIOFRAMES, (long long)(i * FXHOST_AUDIORATE / 60), bpm);
+    }
+
+    FXAudioAnalyser* analyser = FXAudioAnalyser::Acquire();
+    vector<FXAUDIOANALYSIS> reference;
+    FXCALLTIMING cachedTiming;
+    cachedTiming.name = "audio cached";
+
+    for (int p = FXAUDIO_SCALAR; p <= FXAUDIO_AVX2; p++) {
+        analyser->SetPath((FXAUDIOPATH)p);
+        if (analyser->Path() != p) continue;
+
+        FXCALLTIMING t;
+        t.name = string("audio ") + FXAudioAnalyser::PathName((FXAUDIOPATH)p);
+        FXAUDIODETAILS audio;
+        memset(&audio, 0, sizeof(audio));
+        audio.active = true;
+        audio.bytes = FXHOST_AUDIOFRAMES * 4;
+        long onsets = 0;
+        float worst = 0;
+        // a silent update first so every path starts from the same previous spectrum
+        audio.lastUpdateTime = -1;
+        analyser->Analyse(audio);
+
+        for (long i = 0; i < iterations; i++) {
+            audio.dataBuffer = &buffers[i][0];
+            audio.lastUpdateTime = i / 60.0;
+            double start = FXHeadlessHost::NowNs();
+            const FXAUDIOANALYSIS& a = analyser->Analyse(audio);
+            t.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+
+            start = FXHeadlessHost::NowNs();
+            analyser->Analyse(audio);
+            if (p == FXAUDIO_SCALAR) cachedTiming.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+
+            onsets += a.onset;
+            if (p == FXAUDIO_SCALAR) {
+                reference.push_back(a);
+                continue;
+            }
+            const FXAUDIOANALYSIS& ref = reference[i];
+            for (int c = 0; c < 3; c++) worst = max(worst, max(fabsf(a.rms[c] - ref.rms[c]), fabsf(a.peak[c] - ref.peak[c])));
+            for (int k = 0; k < FXAUDIO_BINS; k++) worst = max(worst, fabsf(a.spectrum[k] - ref.spectrum[k]));
+        }
+        if (worst > 1E-4f) printf("fxbench: audio %s differs from scalar by %g\n", FXAudioAnalyser::PathName((FXAUDIOPATH)p), worst);
+        printf("audio %s: %ld onsets in %.1fs at %.0f bpm (expect about %.0f)\n", FXAudioAnalyser::PathName((FXAUDIOPATH)p),
+            onsets, iterations / 60.0, bpm, iterations / 60.0 * bpm / 60.0 * 2);
+        AddRow(rows, base, t);
+    }
+    AddRow(rows, base, cachedTiming);
+    FXAudioAnalyser::Release(analyser);
+}
+
+/**
+    noise suite: a 1024x1024 RGBA tile of white noise on every path, each compared to scalar, perlin
+    (256 RGBA, 4 octaves) and blue noise (128, one channel) generation, then a 256 blue noise tile
+    through the library: made on a worker with nothing on disk, loaded back from the disk cache and
+    requested again while another handle holds it (shared, no work at all)
+*/
+static bool NoiseRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, long iterations, string cacheDir) {
+    bool ok = true;
+    const int words = 1024 * 1024;
+    vector<uint32_t> reference(words), out(words);
+    FXNoise::White(FXNOISE_SCALAR, 1, 0, words, &reference[0]);
+    for (int p = FXNOISE_SCALAR; p <= FXNoise::BestPath(); p++) {
+        FXCALLTIMING t;
+        t.name = string("white ") + FXNoise::PathName((FXNOISEPATH)p);
+        for (long i = 0; i < iterations; i++) {
+            double start = FXHeadlessHost::NowNs();
+            FXNoise::White((FXNOISEPATH)p, 1, 0, words, &out[0]);
+            t.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+        }
+        if (out != reference) {
+            printf("fxbench: white noise on %s differs from scalar\n", FXNoise::PathName((FXNOISEPATH)p));
+            ok = false;
+        }
+        AddRow(rows, base, t);
+    }
+
+    FXWorkerPool* workers = FXWorkerPool::Acquire();
+    FXNOISEPARAMS made[2] = {FXNoise::Params(FXNOISE_PERLIN, 256, 4), FXNoise::Params(FXNOISE_BLUE, 128)};
+    const char* names[2] = {"perlin 256 rgba", "blue 128"};
+    for (int k = 0; k < 2; k++) {
+        FXCALLTIMING t;
+        t.name = names[k];
+        vector<unsigned char> tile(FXNoise::Bytes(made[k]));
+        for (long i = 0; i < iterations; i++) {
+            double start = FXHeadlessHost::NowNs();
+            FXNoise::Generate(made[k], &tile[0], workers);
+            t.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+        }
+        AddRow(rows, base, t);
+    }
+    FXWorkerPool::Release(workers);
+
+    FXNoise* noise = FXNoise::Acquire();
+    noise->SetCacheDir(cacheDir);
+    FXNOISEPARAMS blue = FXNoise::Params(FXNOISE_BLUE, 256);
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.fxnz", (unsigned long long)FXNoise::Key(blue));
+    string cached = cacheDir + name;
+    unlink(cached.c_str());
+
+    FXCALLTIMING cold, warm, shared;
+    cold.name = "blue 256 made";
+    warm.name = "blue 256 from disk";
+    shared.name = "blue 256 shared";
+    double start = FXHeadlessHost::NowNs();
+    int held = noise->Request(blue);
+    noise->Wait(held);
+    noise->Texture(held);
+    cold.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+    vector<unsigned char> first(noise->Data(held), noise->Data(held) + FXNoise::Bytes(blue));
+    noise->Drop(held);
+
+    for (long i = 0; i < iterations; i++) {
+        start = FXHeadlessHost::NowNs();
+        int h = noise->Request(blue);
+        noise->Wait(h);
+        noise->Texture(h);
+        warm.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+        if (memcmp(noise->Data(h), &first[0], first.size())) ok = false;
+        noise->Drop(h);
+    }
+    held = noise->Request(blue);
+    noise->Wait(held);
+    noise->Texture(held);
+    for (long i = 0; i < iterations; i++) {
+        start = FXHeadlessHost::NowNs();
+        int h = noise->Request(blue);
+        noise->Texture(h);
+        shared.wallNs.push_back(FXHeadlessHost::NowNs() - start);
+        noise->Drop(h);
+    }
+    noise->Drop(held);
+
+    FXNOISESTATS s = noise->Stats();
+    printf("\nnoise library: %ld requests, %ld shared, %ld made (%.1fms), %ld from disk%s\n",
+        s.requests, s.shared, s.generated, s.generateMs, s.loaded, ok ? "" : "  FAILED");
+    AddRow(rows, base, cold);
+    AddRow(rows, base, warm);
+    AddRow(rows, base, shared);
+    FXNoise::Release(noise);
+    unlink(cached.c_str());
+    rmdir(cacheDir.c_str());
+    return ok;
+}
+
+/**
+    shaders/targets for the suites that draw themselves (uv, mixer), quads go straight to clip space
+*/
+#define BENCH_VERT "#version 120\nvoid main(){ gl_Position = gl_Vertex; gl_TexCoord[0] = gl_MultiTexCoord0; }\n"
+
+static GLuint BenchProgram(string frag) {
+    const char* text[2] = {BENCH_VERT, frag.c_str()};
+    GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    GLuint program = glCreateProgram();
+    for (int i = 0; i < 2; i++) {
+        GLuint s = glCreateShader(types[i]);
+        glShaderSource(s, 1, &text[i], 0);
+        glCompileShader(s);
+        glAttachShader(program, s);
+        glDeleteShader(s);
+    }
+    glLinkProgram(program);
+    GLint ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[2048];
+        glGetProgramInfoLog(program, sizeof(log), 0, log);
+        printf("fxbench: bench shader failed %s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static GLuint BenchTarget(unsigned int w, unsigned int h, GLuint& fbo) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    return tex;
+}
+
+static void BenchDraw(GLuint fbo, unsigned int w, unsigned int h, float tx2, float ty2) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, w, h);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0, 0);     glVertex2f(-1, -1);
+    glTexCoord2f(tx2, 0);   glVertex2f(1, -1);
+    glTexCoord2f(tx2, ty2); glVertex2f(1, 1);
+    glTexCoord2f(0, ty2);   glVertex2f(-1, 1);
+    glEnd();
+}
+
+/**
+    uv suite: the old squaring copy (source into a full texture, sampled with the hardware wrap)
+    against FXTEXCOORDS_GLSL sampling the source directly, every wrap x fit x filter compared
+    pixel for pixel (the unused part of the source is filled with magenta so any bleed shows),
+    then both timed. Nearest must match exactly. Linear is allowed 2/255 (the filter weights are
+    rounded per texture size, and the source is bigger than the copy was), plus repeat/border
+    along the seam where the copy's hardware wrap blends across the image edge.
+*/
+static bool UVRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, pair<unsigned int,unsigned int> output,
+                   pair<unsigned int,unsigned int> source, long iterations) {
+    unsigned int w = source.first, h = source.second;
+    unsigned int tw = output.first, th = output.second;
+    unsigned int sq = 1;
+    while (sq < max(w, h)) sq <<= 1;
+    float tx2 = (float)w / sq, ty2 = (float)h / sq;
+
+    // noise in the image, magenta in the rest of the texture
+    vector<unsigned char> pixels(sq * sq * 4);
+    uint32_t seed = 12345;
+    for (unsigned int y = 0; y < sq; y++) {
+        for (unsigned int x = 0; x < sq; x++) {
+            unsigned char* p = &pixels[(y * sq + x) * 4];
+            seed = seed * 1664525u + 1013904223u;
+            bool inside = x < w && y < h;
+            p[0] = inside ? seed >> 24 : 255;
+            p[1] = inside ? seed >> 16 : 0;
+            p[2] = inside ? seed >> 8 : 255;
+            p[3] = 255;
+        }
+    }
+    GLuint src;
+    glGenTextures(1, &src);
+    glBindTexture(GL_TEXTURE_2D, src);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, sq, sq, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLuint squareFBO, outFBO;
+    GLuint square = BenchTarget(w, h, squareFBO);
+    GLuint out = BenchTarget(tw, th, outFBO);
+    const float border[4] = {0, 0, 0, 0};
+    glBindTexture(GL_TEXTURE_2D, square);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+
+    GLuint copy = BenchProgram("#version 120\nuniform sampler2D t;\nvoid main(){ gl_FragColor = texture2D(t, gl_TexCoord[0].xy); }\n");
+    GLuint wrapped = BenchProgram("#version 120\nuniform sampler2D t;\nuniform float fxUV[9];\n"
+        "void main(){ gl_FragColor = texture2D(t, gl_TexCoord[0].xy * vec2(fxUV[0], fxUV[1]) + vec2(fxUV[2], fxUV[3])); }\n");
+    GLuint remap = BenchProgram(string("#version 120\nuniform sampler2D t;\n") + FXTEXCOORDS_GLSL +
+        "void main(){ gl_FragColor = fxTexture(t, gl_TexCoord[0].xy); }\n");
+    bool ok = copy && wrapped && remap;
+
+    const char* wrapNames[4] = {"clamp", "repeat", "mirror", "border"};
+    const GLint hardware[4] = {GL_CLAMP_TO_EDGE, GL_REPEAT, GL_MIRRORED_REPEAT, GL_CLAMP_TO_BORDER};
+    const char* fitNames[3] = {"stretch", "contain", "cover"};
+    FXTexCoords tc;
+    // zoomed out a bit and off centre, so every wrap mode has something to do
+    tc.SetTile(1.37f, 1.21f, 0.113f, -0.071f);
+    vector<unsigned char> a(tw * th * 4), b(tw * th * 4);
+    FXCALLTIMING timing[2];
+    timing[0].name = "uv copy+sample";
+    timing[1].name = "uv remap";
+
+    printf("\nuv remap vs squaring copy (%ux%u of a %ux%u texture drawn at %ux%u)\n", w, h, sq, sq, tw, th);
+    for (int filter = 0; filter < 2 && ok; filter++) {
+        GLint f = filter ? GL_LINEAR : GL_NEAREST;
+        for (int wrap = FXWRAP_CLAMP; wrap <= FXWRAP_BORDER; wrap++) {
+            for (int fit = FXFIT_STRETCH; fit <= FXFIT_COVER; fit++) {
+                tc.SetWrap((FXTEXWRAP)wrap);
+                tc.SetFit((FXTEXFIT)fit);
+                tc.Update(w, h, tx2, ty2, tw, th);
+                bool timed = wrap == FXWRAP_MIRROR && fit == FXFIT_COVER && filter;
+                long n = timed ? max(iterations, 1L) : 1;
+
+                // old: copy the image into a texture of its own, then let GL wrap it
+                for (long i = 0; i < n; i++) {
+                    double start = FXHeadlessHost::NowNs();
+                    glUseProgram(copy);
+                    glBindTexture(GL_TEXTURE_2D, src);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                    BenchDraw(squareFBO, w, h, tx2, ty2);
+                    glUseProgram(wrapped);
+                    glUniform1fv(glGetUniformLocation(wrapped, "fxUV"), FXTEXCOORDS_FLOATS, tc.Values());
+                    glBindTexture(GL_TEXTURE_2D, square);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, f);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, f);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, hardware[wrap]);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, hardware[wrap]);
+                    BenchDraw(outFBO, tw, th, 1, 1);
+                    glFinish();
+                    if (timed) timing[0].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+                }
+                glReadPixels(0, 0, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, &a[0]);
+
+                // new: straight from the source
+                for (long i = 0; i < n; i++) {
+                    double start = FXHeadlessHost::NowNs();
+                    glUseProgram(remap);
+                    glUniform1fv(glGetUniformLocation(remap, "fxUV"), FXTEXCOORDS_FLOATS, tc.Values());
+                    glBindTexture(GL_TEXTURE_2D, src);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, f);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, f);
+                    BenchDraw(outFBO, tw, th, 1, 1);
+                    glFinish();
+                    if (timed) timing[1].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+                }
+                glReadPixels(0, 0, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, &b[0]);
+
+                // repeat/border can differ within a texel of an image edge (the seam), anything else is
+                // a real difference, bar the last bit or two of linear (its weights are rounded per texture size)
+                bool seams = filter && (wrap == FXWRAP_REPEAT || wrap == FXWRAP_BORDER);
+                int tolerance = filter ? 2 : 0;
+                const float* v = tc.Values();
+                long differ = 0;
+                int worst = 0, worstOffSeam = 0;
+                for (unsigned int y = 0; y < th; y++) {
+                    for (unsigned int x = 0; x < tw; x++) {
+                        size_t p = (y * tw + x) * 4;
+                        int d = 0;
+                        for (int c = 0; c < 4; c++) d = max(d, abs(a[p + c] - b[p + c]));
+                        if (!d) continue;
+                        differ++;
+                        worst = max(worst, d);
+                        float ix = (x + 0.5f) / tw * v[0] + v[2];
+                        float iy = (y + 0.5f) / th * v[1] + v[3];
+                        bool seam = seams && (fabsf(ix - roundf(ix)) * w < 1.0f || fabsf(iy - roundf(iy)) * h < 1.0f);
+                        if (!seam) worstOffSeam = max(worstOffSeam, d);
+                    }
+                }
+                bool pass = worstOffSeam <= tolerance;
+                printf("uv %-6s %-7s %-7s: %7ld of %u pixels differ, max %3d (%d off the seam)%s\n", wrapNames[wrap], fitNames[fit],
+                    filter ? "linear" : "nearest", differ, tw * th, worst, worstOffSeam, pass ? "" : "  FAILED");
+                ok = ok && pass;
+            }
+        }
+    }
+    AddRow(rows, base, timing[0]);
+    AddRow(rows, base, timing[1]);
+
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteProgram(copy);
+    glDeleteProgram(wrapped);
+    glDeleteProgram(remap);
+    glDeleteFramebuffers(1, &squareFBO);
+    glDeleteFramebuffers(1, &outFBO);
+    glDeleteTextures(1, &square);
+    glDeleteTextures(1, &out);
+    glDeleteTextures(1, &src);
+    return ok;
+}
+
+/**
+    mixer suite: FXLayerMixer blending every layer in one draw against the layer by layer way,
+    a pass per layer into ping-pong buffers (the same shader with the last result as the bottom
+    layer), both the same image bar the 8 bit rounding of each in between result. Ten layers with
+    two of them not supplied, so the packing is in there too.
+*/
+static bool MixerRows(vector<FXBENCHROW>& rows, const FXBENCHROW& base, pair<unsigned int,unsigned int> output,
+                      pair<unsigned int,unsigned int> source, long iterations) {
+    unsigned int w = source.first, h = source.second;
+    unsigned int tw = output.first, th = output.second;
+    unsigned int sq = 1;
+    while (sq < max(w, h)) sq <<= 1;
+
+    // source[1..10] like a mixer in an output slot, 4 and 9 missing
+    FXSOURCE sources[MAXFXSOURCES];
+    memset(sources, 0, sizeof(sources));
+    vector<unsigned char> pixels(sq * sq * 4, 0);
+    vector<GLuint> textures;
+    FXLayerMixer mixer;
+    for (int i = 1; i <= FXMIXER_MAXLAYERS; i++) {
+        mixer.AddLayer(i, 0.35f + 0.065f * i, (FXBLENDMODE)(i % FXBLEND_COUNT));
+        if (i == 4 || i == 9) continue;
+        uint32_t seed = i * 7919;
+        for (unsigned int y = 0; y < h; y++) {
+            for (unsigned int x = 0; x < w; x++) {
+                unsigned char* p = &pixels[(y * sq + x) * 4];
+                seed = seed * 1664525u + 1013904223u;
+                p[0] = (x * 255) / w;
+                p[1] = seed >> 24;
+                p[2] = ((x >> 4) ^ (y >> 4) ^ i) & 1 ? 255 : (y * 255) / h;
+                p[3] = i & 1 ? 255 : (x * 255) / w;     // some with alpha for the normal blends
+            }
+        }
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, sq, sq, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        textures.push_back(tex);
+        sources[i].id = tex;
+        sources[i].tx2 = (float)w / sq;
+        sources[i].ty2 = (float)h / sq;
+        sources[i].w = sq;
+        sources[i].h = sq;
+    }
+
+    GLuint program = BenchProgram(FXLayerMixer::ShaderText());
+    if (!program) return false;
+    glUseProgram(program);
+    for (int k = 0; k < FXMIXER_MAXLAYERS; k++) {
+        char name[16];
+        sprintf(name, "fxLayer%d", k);
+        glUniform1i(glGetUniformLocation(program, name), k);
+    }
+    GLint mixLoc = glGetUniformLocation(program, "fxMix");
+    GLint countLoc = glGetUniformLocation(program, "fxMixCount");
+
+    GLuint fbo[2];
+    GLuint target[2] = {BenchTarget(tw, th, fbo[0]), BenchTarget(tw, th, fbo[1])};
+    int layers = mixer.Gather(sources);
+    vector<unsigned char> single(tw * th * 4), passes(tw * th * 4);
+    FXCALLTIMING t[2];
+    char name[32];
+    t[0].name = "mix 1 pass";
+    sprintf(name, "mix %d passes", layers);
+    t[1].name = name;
+
+    // one untimed draw each first, the driver finishes the program on its first use
+    for (long i = -1; i < max(iterations, 1L); i++) {
+        double start = FXHeadlessHost::NowNs();
+        mixer.Gather(sources);
+        mixer.Bind();
+        glUniform1fv(mixLoc, FXMIXER_FLOATS, mixer.Values());
+        glUniform1f(countLoc, (float)mixer.Count());
+        BenchDraw(fbo[0], tw, th, 1, 1);
+        glFinish();
+        if (i >= 0) t[0].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+    }
+    glReadPixels(0, 0, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, &single[0]);
+
+    // each layer over the last result, which goes in as a normal layer at full opacity
+    int last = 0;
+    for (long i = -1; i < max(iterations, 1L); i++) {
+        double start = FXHeadlessHost::NowNs();
+        const float* all = mixer.Values();
+        for (int k = 0; k < layers; k++) {
+            FXSOURCE pair[3];
+            memset(pair, 0, sizeof(pair));
+            pair[1].id = target[last];
+            pair[1].tx2 = pair[1].ty2 = 1.0f;
+            pair[2].id = mixer.Texture(k);
+            pair[2].tx2 = all[k * 4 + 2];
+            pair[2].ty2 = all[k * 4 + 3];
+            FXLayerMixer step;
+            if (k) step.AddLayer(1);
+            step.AddLayer(2, all[k * 4], (FXBLENDMODE)(int)all[k * 4 + 1]);
+            step.Gather(pair);
+            step.Bind();
+            glUniform1fv(mixLoc, FXMIXER_FLOATS, step.Values());
+            glUniform1f(countLoc, (float)step.Count());
+            last = 1 - last;
+            BenchDraw(fbo[last], tw, th, 1, 1);
+        }
+        glFinish();
+        if (i >= 0) t[1].wallNs.push_back(FXHeadlessHost::NowNs() - start);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo[last]);
+    glReadPixels(0, 0, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, &passes[0]);
+
+    int worst = 0;
+    long differ = 0;
+    for (size_t p = 0; p < single.size(); p++) {
+        int d = abs(single[p] - passes[p]);
+        if (d) differ++;
+        worst = max(worst, d);
+    }
+    // every in between result rounds to 8 bits, at most one step each
+    bool ok = worst <= layers;
+    printf("\nmixer at %ux%u: %d of %d layers supplied, one pass vs %d, %ld values differ (max %d)%s\n",
+        tw, th, layers, mixer.Layers(), layers, differ, worst, ok ? "" : "  FAILED");
+    AddRow(rows, base, t[0]);
+    AddRow(rows, base, t[1]);
+
+    glUseProgram(0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteProgram(program);
+    glDeleteFramebuffers(2, fbo);
+    glDeleteTextures(2, target);
+    glDeleteTextures(textures.size(), &textures[0]);
+    return ok;
+}
+
+static void PrintRow(const FXBENCHROW& r) {
+    if (r.suite == "codec") {
+        // no gpu side, show throughput instead (and frames per second for the decode)
+        printf("%-10s %-10s %-18s %6u | %8.3f %8.3f %8.3f %8.3f | %8.1f MB/s  ratio %5.2f  %7.1f fps\n",
+            r.output.c_str(), r.source.c_str(), r.name.c_str(), r.count,
+            r.wall[0], r.wall[1], r.wall[2], r.wall[3], r.mbps, r.ratio, r.wall[0] > 0 ? 1000.0 / r.wall[0] : 0);
+        return;
+    }
+    printf("%-10s %-10s %-18s %6u | %8.3f %8.3f %8.3f %8.3f | %8.3f %8.3f %8.3f %8.3f\n",
+        r.output.c_str(), r.source.c_str(), r.name.c_str(), r.count,
+        r.wall[0], r.wall[1], r.wall[2], r.wall[3], r.gpu[0], r.gpu[1], r.gpu[2], r.gpu[3]);
+}
+
+static bool WriteCSV(string filename, const vector<FXBENCHROW>& rows) {
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "suite,output,source,tx2,ty2,name,count,wall_p50_ms,wall_p95_ms,wall_p99_ms,wall_max_ms,"
+               "gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,gpu_max_ms,mb_per_s,ratio\n");
+    for (unsigned int i = 0; i < rows.size(); i++) {
+        const FXBENCHROW& r = rows[i];
+        fprintf(f, "%s,%s,%s,%.6f,%.6f,%s,%u,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%.3f\n",
+            r.suite.c_str(), r.output.c_str(), r.source.c_str(), r.tx2, r.ty2, r.name.c_str(), r.count,
+            r.wall[0], r.wall[1], r.wall[2], r.wall[3], r.gpu[0], r.gpu[1], r.gpu[2], r.gpu[3], r.mbps, r.ratio);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool WriteJSON(string filename, string plugin, string renderer, const vector<FXBENCHROW>& rows) {
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"plugin\": \"%s\",\n  \"renderer\": \"%s\",\n  \"results\": [\n", plugin.c_str(), renderer.c_str());
+    for (unsigned int i = 0; i < rows.size(); i++) {
+        const FXBENCHROW& r = rows[i];
+        fprintf(f, "    {\"suite\": \"%s\", \"output\": \"%s\", \"source\": \"%s\", \"tx2\": %.6f, \"ty2\": %.6f, "
+                   "\"name\": \"%s\", \"count\": %u, "
+                   "\"wall_ms\": {\"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f}, "
+                   "\"gpu_ms\": {\"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f}, "
+                   "\"mb_per_s\": %.3f, \"ratio\": %.3f}%s\n",
+            r.suite.c_str(), r.output.c_str(), r.source.c_str(), r.tx2, r.ty2, r.name.c_str(), r.count,
+            r.wall[0], r.wall[1], r.wall[2], r.wall[3], r.gpu[0], r.gpu[1], r.gpu[2], r.gpu[3],
+            r.mbps, r.ratio, i + 1 < rows.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        Usage();
+        return 1;
+    }
+
+    string pluginFile = argv[1];
+    string jsonFile, csvFile;
+    long frames = 200;
+    long warmup = 20;
+    long codecIterations = 0;
+    string codecDir = ".";
+    long audioIterations = 0;
+    long startIterations = 0;
+    string shaderCacheDir = "./fxbench-shadercache";
+    long uvIterations = 0;
+    long mixerIterations = 0;
+    long noiseIterations = 0;
+    string noiseCacheDir = "./fxbench-noisecache";
+    vector< pair<unsigned int,unsigned int> > outputs, sources;
+    ParseSizes(defaultOutputs, outputs);
+    ParseSizes(defaultSources, sources);
+
+    for (int a = 2; a < argc; a++) {
+        bool more = a + 1 < argc;
+        if (!strcmp(argv[a], "-frames") && more) frames = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-warmup") && more) warmup = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-outputs") && more) {
+            if (!ParseSizes(argv[++a], outputs)) { Usage(); return 1; }
+        }else if (!strcmp(argv[a], "-sources") && more) {
+            if (!ParseSizes(argv[++a], sources)) { Usage(); return 1; }
+        }else if (!strcmp(argv[a], "-json") && more) jsonFile = argv[++a];
+        else if (!strcmp(argv[a], "-csv") && more) csvFile = argv[++a];
+        else if (!strcmp(argv[a], "-codec") && more) codecIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-codecdir") && more) codecDir = argv[++a];
+        else if (!strcmp(argv[a], "-audio") && more) audioIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-coldstart") && more) startIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-shadercache") && more) shaderCacheDir = argv[++a];
+        else if (!strcmp(argv[a], "-uvcheck") && more) uvIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-mixer") && more) mixerIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-noise") && more) noiseIterations = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-noisecache") && more) noiseCacheDir = argv[++a];
+        else {
+            Usage();
+            return 1;
+        }
+    }
+
+    FXHeadlessHost host;
+    if (!host.CreateContext() || !host.LoadPlugin(pluginFile)) {
+        printf("fxbench: %s\n", host.errorMessage.c_str());
+        return 1;
+    }
+    printf("fxbench: %s on %s\n\n", pluginFile.c_str(), host.glRenderer.c_str());
+    printf("%-10s %-10s %-18s %6s | %8s %8s %8s %8s | %8s %8s %8s %8s\n", "output", "source", "name", "count",
+        "wall p50", "p95", "p99", "max", "gpu p50", "p95", "p99", "max");
+
+    vector<FXBENCHROW> rows;
+
+    for (unsigned int o = 0; o < outputs.size() && frames > 0; o++) {
+        for (unsigned int s = 0; s < sources.size(); s++) {
+            FXHOSTSETUP setup = FXHeadlessHost::DefaultSetup();
+            setup.outputWidth = outputs[o].first;
+            setup.outputHeight = outputs[o].second;
+            setup.sourceWidth = sources[s].first;
+            setup.sourceHeight = sources[s].second;
+            setup.gpuTiming = true;
+
+            if (!host.StartInstance(setup)) {
+                printf("fxbench: %s\n", host.errorMessage.c_str());
+                return 1;
+            }
+
+            for (long f = 0; f < warmup; f++) host.RunFrame();
+            host.ClearTimings();
+            for (long f = 0; f < frames; f++) host.RunFrame();
+
+            FXBENCHROW base;
+            base.suite = "frames";
+            base.output = SizeLabel(setup.outputWidth, setup.outputHeight);
+            base.source = SizeLabel(setup.sourceWidth, setup.sourceHeight);
+            base.tx2 = host.fx->source[0].tx2;
+            base.ty2 = host.fx->source[0].ty2;
+            base.mbps = -1;
+            base.ratio = -1;
+
+            size_t first = rows.size();
+            AddRow(rows, base, host.timings[FXCALL_UPDATE]);
+            AddRow(rows, base, host.timings[FXCALL_PROCESS]);
+            for (unsigned int t = 0; t < host.stageTimings.size(); t++) AddRow(rows, base, host.stageTimings[t]);
+            for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+
+            host.StopInstance();
+        }
+    }
+
+    if (codecIterations > 0) {
+        // what the plugin actually renders, after warmup so it isn't a blank frame
+        FXWorkerPool* pool = FXWorkerPool::Acquire();
+        printf("\ncapture (%d worker threads, %ld iterations)\n", pool->Threads(), codecIterations);
+        for (unsigned int o = 0; o < outputs.size(); o++) {
+            FXHOSTSETUP setup = FXHeadlessHost::DefaultSetup();
+            setup.outputWidth = outputs[o].first;
+            setup.outputHeight = outputs[o].second;
+            setup.sourceWidth = sources[0].first;
+            setup.sourceHeight = sources[0].second;
+            if (!host.StartInstance(setup)) {
+                printf("fxbench: %s\n", host.errorMessage.c_str());
+                return 1;
+            }
+            for (long f = 0; f < max(warmup, 1L); f++) host.RunFrame();
+            vector<unsigned char> frame;
+            host.ReadOutput(frame);
+            host.StopInstance();
+
+            FXBENCHROW base;
+            base.suite = "codec";
+            base.output = SizeLabel(setup.outputWidth, setup.outputHeight);
+            base.source = SizeLabel(setup.sourceWidth, setup.sourceHeight);
+            base.tx2 = base.ty2 = 0;
+
+            size_t first = rows.size();
+            CodecRows(rows, base, frame, setup.outputWidth, setup.outputHeight, codecIterations, codecDir, pool);
+            for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+        }
+        FXWorkerPool::Release(pool);
+    }
+
+    if (startIterations > 0) {
+        printf("\nstart (%ld iterations, StartInstance + first frame)\n", startIterations);
+        FXBENCHROW base;
+        base.suite = "start";
+        base.output = SizeLabel(outputs[0].first, outputs[0].second);
+        base.source = SizeLabel(sources[0].first, sources[0].second);
+        base.tx2 = base.ty2 = 0;
+        base.mbps = base.ratio = -1;
+        size_t first = rows.size();
+        if (!StartRows(rows, base, host, outputs[0], sources[0], startIterations, shaderCacheDir)) {
+            printf("fxbench: %s\n", host.errorMessage.c_str());
+            return 1;
+        }
+        for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+    }
+
+    if (uvIterations > 0) {
+        FXBENCHROW base;
+        base.suite = "uv";
+        base.output = SizeLabel(outputs[0].first, outputs[0].second);
+        base.source = SizeLabel(sources[0].first, sources[0].second);
+        base.tx2 = base.ty2 = 0;
+        base.mbps = base.ratio = -1;
+        size_t first = rows.size();
+        bool matched = UVRows(rows, base, outputs[0], sources[0], uvIterations);
+        for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+        if (!matched) {
+            printf("fxbench: uv remap does not match the squaring copy\n");
+            return 1;
+        }
+    }
+
+    if (mixerIterations > 0) {
+        // at the biggest output, 4K with the default sizes
+        pair<unsigned int,unsigned int> biggest = outputs[0];
+        for (unsigned int o = 1; o < outputs.size(); o++) {
+            if (outputs[o].first * outputs[o].second > biggest.first * biggest.second) biggest = outputs[o];
+        }
+        FXBENCHROW base;
+        base.suite = "mixer";
+        base.output = SizeLabel(biggest.first, biggest.second);
+        base.source = SizeLabel(sources[0].first, sources[0].second);
+        base.tx2 = base.ty2 = 0;
+        base.mbps = base.ratio = -1;
+        size_t first = rows.size();
+        bool matched = MixerRows(rows, base, biggest, sources[0], mixerIterations);
+        for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+        if (!matched) {
+            printf("fxbench: one pass mix does not match the layer by layer passes\n");
+            return 1;
+        }
+    }
+
+    if (audioIterations > 0) {
+        printf("\naudio analysis (%ld updates of %d frames)\n", audioIterations, FXHOST_AUDIOFRAMES);
+        FXBENCHROW base;
+        base.suite = "audio";
+        base.output = base.source = "-";
+        base.tx2 = base.ty2 = 0;
+        base.mbps = base.ratio = -1;
+        size_t first = rows.size();
+        AudioRows(rows, base, audioIterations, FXHeadlessHost::DefaultSetup().bpm);
+        for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+    }
+
+    if (noiseIterations > 0) {
+        printf("\nnoise generation (%ld of each)\n", noiseIterations);
+        FXBENCHROW base;
+        base.suite = "noise";
+        base.output = base.source = "-";
+        base.tx2 = base.ty2 = 0;
+        base.mbps = base.ratio = -1;
+        size_t first = rows.size();
+        bool matched = NoiseRows(rows, base, noiseIterations, noiseCacheDir);
+        for (size_t r = first; r < rows.size(); r++) PrintRow(rows[r]);
+        if (!matched) {
+            printf("fxbench: noise paths or the disk cache don't match what was made\n");
+            return 1;
+        }
+    }
+
+    if (!jsonFile.empty() && !WriteJSON(jsonFile, pluginFile, host.glRenderer, rows)) printf("fxbench: could not write %s\n", jsonFile.c_str());
+    if (!csvFile.empty() && !WriteCSV(csvFile, rows)) printf("fxbench: could not write %s\n", csvFile.c_str());
+    return 0;
+}
@@ -0,0 +1,723 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Headless reference host (see fxheadlesshost.h)
+*/
+
+#include "fxheadlesshost.h"
+
+#include <dlfcn.h>
+#include <time.h>
+#include <string.h>
+
+#include <EGL/eglext.h>
+
+/**
+    the default host vert shaders a plugin can refer to by name
+    (see the notes above PluginPrivateObject::CreateShaders)
+*/
+static const char* hostVertShaders[][2] = {
+    {"000-0TextureVert",
+        "#version 120\n"
+        "void main(){\n"
+        "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+        "}\n"},
+    {"000-1TextureVert",
+        "#version 120\n"
+        "void main(){\n"
+        "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+        "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "}\n"},
+    {"000-2TextureVert",
+        "#version 120\n"
+        "void main(){\n"
+        "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+        "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "  gl_TexCoord[1] = gl_MultiTexCoord1;\n"
+        "}\n"},
+    {"000-3TextureVert",
+        "#version 120\n"
+        "void main(){\n"
+        "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+        "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "  gl_TexCoord[1] = gl_MultiTexCoord1;\n"
+        "  gl_TexCoord[2] = gl_MultiTexCoord2;\n"
+        "}\n"},
+    {"000-4TextureVert",
+        "#version 120\n"
+        "void main(){\n"
+        "  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+        "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "  gl_TexCoord[1] = gl_MultiTexCoord1;\n"
+        "  gl_TexCoord[2] = gl_MultiTexCoord2;\n"
+        "  gl_TexCoord[3] = gl_MultiTexCoord3;\n"
+        "}\n"},
+    {"000-1TextureVert330",
+        "#version 330\n"
+        "layout(location = 0) in vec3 vertexPosition;\n"
+        "layout(location = 1) in vec2 vertexUV;\n"
+        "out vec2 UV;\n"
+        "uniform mat4 MVP;\n"
+        "void main(){\n"
+        "  gl_Position = MVP * vec4(vertexPosition,1.0);\n"
+        "  UV = vertexUV;\n"
+        "}\n"},
+};
+
+FXHeadlessHost::FXHeadlessHost() {
+    fx = 0;
+    frame = 0;
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    library = 0;
+    instance = 0;
+    setup = DefaultSetup();
+
+    fnSystemVersion = 0;
+    fnCreateInstance = 0;
+    fnInit = 0;
+    fnUpdate = 0;
+    fnProcess = 0;
+    fnRandom = 0;
+    fnGetState = 0;
+    fnSetState = 0;
+    fnDeinit = 0;
+    fnProfileStages = 0;
+    fnDynamicResolution = 0;
+    gpuQuery = 0;
+
+    timings[FXCALL_CREATEINSTANCE].name = "CreateInstance";
+    timings[FXCALL_INIT].name = "Init";
+    timings[FXCALL_UPDATE].name = "Update";
+    timings[FXCALL_PROCESS].name = "Process";
+    timings[FXCALL_RANDOM].name = "Random";
+    timings[FXCALL_GETSTATE].name = "GetState";
+    timings[FXCALL_SETSTATE].name = "SetState";
+    timings[FXCALL_DEINIT].name = "Deinit";
+}
+
+FXHeadlessHost::~FXHeadlessHost() {
+    StopInstance();
+    UnloadPlugin();
+    DestroyContext();
+}
+
+FXHOSTSETUP FXHeadlessHost::DefaultSetup() {
+    FXHOSTSETUP s;
+    s.outputWidth = 1920;
+    s.outputHeight = 1080;
+    s.sourceWidth = 1920;
+    s.sourceHeight = 1080;
+    s.sourceCount = 1;
+    s.fps = 60;
+    s.bpm = 120;
+    s.finishEachCall = true;
+    s.gpuTiming = false;
+    s.randomEvery = 0;
+    s.stateEvery = 0;
+    s.audio = false;
+    s.programCache = "";
+    return s;
+}
+
+double FXHeadlessHost::NowNs() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec * 1E9) + t.tv_nsec;
+}
+
+bool FXHeadlessHost::Fail(string message) {
+    errorMessage = message;
+    return false;
+}
+
+/**
+    surfaceless context, no window or X server needed
+    compatibility profile as the plugins use the fixed function matrix stack
+*/
+bool FXHeadlessHost::CreateContext() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY) return Fail("no EGL display");
+
+    EGLint major, minor;
+    if (!eglInitialize(display, &major, &minor)) return Fail("eglInitialize failed");
+    if (!eglBindAPI(EGL_OPENGL_API)) return Fail("eglBindAPI(EGL_OPENGL_API) failed");
+
+    EGLint attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs);
+    if (context == EGL_NO_CONTEXT) return Fail("eglCreateContext failed (EGL_KHR_no_config_context required)");
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) return Fail("eglMakeCurrent failed");
+
+    glRenderer = string((const char*)glGetString(GL_RENDERER)) + " / " + (const char*)glGetString(GL_VERSION);
+    glGenQueries(1, &gpuQuery);
+    return true;
+}
+
+void FXHeadlessHost::DestroyContext() {
+    if (display == EGL_NO_DISPLAY) return;
+
+    ClearShaders();
+    if (gpuQuery) glDeleteQueries(1, &gpuQuery);
+    gpuQuery = 0;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+    eglTerminate(display);
+    context = EGL_NO_CONTEXT;
+    display = EGL_NO_DISPLAY;
+}
+
+void FXHeadlessHost::ClearShaders() {
+    map<string,GLuint>::iterator it;
+    for (it = programs.begin(); it != programs.end(); ++it) glDeleteProgram(it->second);
+    for (it = vertShaders.begin(); it != vertShaders.end(); ++it) glDeleteShader(it->second);
+    for (it = fragShaders.begin(); it != fragShaders.end(); ++it) glDeleteShader(it->second);
+    programs.clear();
+    vertShaders.clear();
+    fragShaders.clear();
+    vertTexts.clear();
+    fragTexts.clear();
+}
+
+void* FXHeadlessHost::Resolve(const char* name, bool required) {
+    void* f = dlsym(library, name);
+    if (!f && required) errorMessage = string("missing required function ") + name;
+    return f;
+}
+
+bool FXHeadlessHost::LoadPlugin(string filename) {
+    UnloadPlugin();
+
+    library = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library) return Fail(string("dlopen failed: ") + dlerror());
+
+    fnSystemVersion = (FXSystemVersionFuncPtr)Resolve("FXSystemVersionFunc", true);
+    if (!fnSystemVersion) return false;
+    int version = fnSystemVersion();
+    if (version != FXHOST_SYSTEM_VERSION) {
+        char buf[100];
+        sprintf(buf, "plugin version %d does not match host version %d", version, FXHOST_SYSTEM_VERSION);
+        return Fail(buf);
+    }
+
+    fnCreateInstance = (FXCreateInstancePtr)Resolve("CreateInstance", true);
+    fnInit = (FXInitPtr)Resolve("Init", true);
+    fnUpdate = (FXPointerFuncPtr)Resolve("Update", true);
+    fnProcess = (FXPointerFuncPtr)Resolve("Process", true);
+    fnGetState = (FXPointerFuncPtr)Resolve("GetState", true);
+    fnSetState = (FXSetStatePtr)Resolve("SetState", true);
+    fnDeinit = (FXPointerFuncPtr)Resolve("Deinit", true);
+    fnRandom = (FXPointerFuncPtr)Resolve("Random", false);   // optional (recently added)
+    fnProfileStages = (FXProfileStagesPtr)Resolve("ProfileStages", false);  // optional (FX_PROFILE builds)
+    fnDynamicResolution = (FXDynamicResolutionPtr)Resolve("DynamicResolution", false);   // optional (newer plugin base)
+
+    if (!fnCreateInstance || !fnInit || !fnUpdate || !fnProcess
+        || !fnGetState || !fnSetState || !fnDeinit) return false;
+
+    return true;
+}
+
+void FXHeadlessHost::UnloadPlugin() {
+    if (library) dlclose(library);
+    library = 0;
+}
+
+void FXHeadlessHost::ClearTimings() {
+    for (int c = 0; c < FXCALL_COUNT; c++) {
+        timings[c].wallNs.clear();
+        timings[c].gpuNs.clear();
+    }
+    stageTimings.clear();
+    stageRuns.clear();
+}
+
+// times a single entry point call, optionally waiting for the GPU to finish
+#define FXHOST_TIMED(CALL, STATEMENT) {                                 \
+        double _t0 = NowNs();                                           \
+        STATEMENT;                                                      \
+        if (setup.finishEachCall) glFinish();                           \
+        timings[CALL].wallNs.push_back(NowNs() - _t0);                  \
+    }
+
+// as above plus GPU time, the query result is read straight away (benchmark only)
+#define FXHOST_GPUTIMED(CALL, STATEMENT) {                              \
+        if (setup.gpuTiming) glBeginQuery(GL_TIME_ELAPSED, gpuQuery);   \
+        FXHOST_TIMED(CALL, STATEMENT);                                  \
+        if (setup.gpuTiming) {                                          \
+            GLuint64 _gpu = 0;                                          \
+            glEndQuery(GL_TIME_ELAPSED);                                \
+            glGetQueryObjectui64v(gpuQuery, GL_QUERY_RESULT, &_gpu);    \
+            timings[CALL].gpuNs.push_back((double)_gpu);                \
+        }                                                               \
+    }
+
+bool FXHeadlessHost::StartInstance(const FXHOSTSETUP& s) {
+    if (!library) return Fail("no plugin loaded");
+    StopInstance();
+
+    setup = s;
+    frame = 0;
+    clock_gettime(CLOCK_REALTIME, &startTime);
+
+    fx = new FXOBJECT();
+    fx->info.paramCount = 0;
+    fx->info.shaderCount = 0;
+    fx->info.fboCount = 0;
+    fx->info.specialTexturesRequested = TEXREQ_NONE;
+    fx->error = false;
+    fx->bypass = false;
+    fx->state.version = 0;
+    fx->state.size = 0;
+    fx->state.data = 0;
+    fx->curTime = startTime;
+    fx->globalSpeed = 1.0f;
+    fx->globalReverse = false;
+    fx->hemidemisemiQuaverCount = 0;
+    fx->bpm = setup.bpm;
+    fx->bar = 0;
+    fx->displayWidth = setup.outputWidth;
+    fx->displayHeight = setup.outputHeight;
+    fx->pluginLevel = 1.0f;
+    fx->pluginPos = 0;
+    fx->mutableLevel = 0.5f;
+    fx->rawSource = 0;
+    fx->rawSourceW = fx->rawSourceH = fx->rawSourceD = 0;
+    fx->audioData.active = setup.audio;
+    fx->audioData.lastUpdateTime = 0;
+    fx->audioData.bytes = 0;
+    fx->audioData.dataBuffer = 0;
+    if (setup.audio) {
+        audioBuffer.assign(FXHOST_AUDIOFRAMES * 2, 0);
+        fx->audioData.bytes = FXHOST_AUDIOFRAMES * 4;
+        fx->audioData.dataBuffer = &audioBuffer[0];
+    }
+    fx->audioData.lowFilterState = fx->audioData.midLFilterState = false;
+    fx->audioData.midHFilterState = fx->audioData.highFilterState = false;
+    for (int i = 0; i < MAXFXSOURCES; i++) {
+        memset(&fx->source[i], 0, sizeof(FXSOURCE));
+        fx->source[i].playbackPrecentage = -1;
+    }
+    for (int i = 0; i < MAXFXFBOBUFFERS; i++) memset(&fx->requestedBuffers[i], 0, sizeof(FXBUFFERDETAILS));
+
+    FXHOST_TIMED(FXCALL_CREATEINSTANCE, instance = fnCreateInstance());
+    FXHOST_TIMED(FXCALL_INIT, fnInit(instance, fx));
+    if (fx->error) return Fail("plugin Init error: " + fx->errorMessage);
+
+    programCache.Open(setup.programCache);
+    if (!CompileShaders()) return false;
+
+    // Init sets the buffer defaults, the host then supplies the real ones
+    if (!CreateBuffer(fx->outputBuffer, setup.outputWidth, setup.outputHeight, false)
+        || !CreateBuffer(fx->bufferA, setup.outputWidth, setup.outputHeight, false)
+        || !CreateBuffer(fx->bufferB, setup.outputWidth, setup.outputHeight, false)
+        || !CreateBuffer(fx->bufferC, setup.outputWidth, setup.outputHeight, false)) return false;
+
+    for (unsigned int i = 0; i < fx->info.fboCount && i < MAXFXFBOBUFFERS; i++) {
+        FXBUFFERDETAILS& b = fx->requestedBuffers[i];
+        unsigned int w = b.width ? b.width : setup.outputWidth;
+        unsigned int h = b.height ? b.height : setup.outputHeight;
+        if (!CreateBuffer(b, w, h, b.DepthID != 0)) return false;
+    }
+
+    CreateSources();
+    FillSpecialTextures();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void FXHeadlessHost::StopInstance() {
+    if (!fx) return;
+
+    if (instance) FXHOST_TIMED(FXCALL_DEINIT, fnDeinit(instance));
+    instance = 0;
+
+    DestroyBuffer(fx->outputBuffer);
+    DestroyBuffer(fx->bufferA);
+    DestroyBuffer(fx->bufferB);
+    DestroyBuffer(fx->bufferC);
+    for (unsigned int i = 0; i < MAXFXFBOBUFFERS; i++) DestroyBuffer(fx->requestedBuffers[i]);
+
+    if (!sourceTextures.empty()) glDeleteTextures(sourceTextures.size(), &sourceTextures[0]);
+    sourceTextures.clear();
+
+    delete fx;
+    fx = 0;
+}
+
+/**
+    one host render loop step (see README Host behaviour 5-7)
+*/
+void FXHeadlessHost::RunFrame() {
+    if (!fx || !instance) return;
+
+    AdvanceClock();
+
+    FXHOST_GPUTIMED(FXCALL_UPDATE, fnUpdate(instance));
+    FXHOST_GPUTIMED(FXCALL_PROCESS, fnProcess(instance));
+    CollectStages();
+
+    if (fnRandom && setup.randomEvery > 0 && (frame % setup.randomEvery) == setup.randomEvery - 1) {
+        FXHOST_TIMED(FXCALL_RANDOM, fnRandom(instance));
+    }
+
+    if (setup.stateEvery > 0 && (frame % setup.stateEvery) == setup.stateEvery - 1) {
+        FXHOST_TIMED(FXCALL_GETSTATE, fnGetState(instance));
+        FXSTATE snap = fx->state;
+        FXHOST_TIMED(FXCALL_SETSTATE, fnSetState(instance, &snap));
+        // the snapshot is the host's to free (the plugin hands over a new[] copy)
+        delete[] (unsigned char*)snap.data;
+        fx->state.data = 0;
+        fx->state.size = 0;
+    }
+
+    // host clears these after process
+    for (unsigned int i = 0; i < fx->info.paramCount; i++) {
+        fx->interfaceparams[i].update = false;
+        fx->interfaceparams[i].displayValueUpdate = false;
+    }
+
+    frame++;
+}
+
+bool FXHeadlessHost::DynamicResolution(FXDYNRESSTATS& stats) {
+    if (!fnDynamicResolution || !instance) return false;
+    return fnDynamicResolution(instance, &stats);
+}
+
+/**
+    internal stages that ran this frame get a sample each
+*/
+void FXHeadlessHost::CollectStages() {
+    if (!fnProfileStages) return;
+
+    FXPROFILESAMPLE samples[FXPROFILE_MAXSTAGES];
+    int n = fnProfileStages(instance, samples, FXPROFILE_MAXSTAGES);
+
+    for (int i = 0; i < n; i++) {
+        unsigned int t = 0;
+        while (t < stageTimings.size() && stageTimings[t].name != samples[i].name) t++;
+        if (t == stageTimings.size()) {
+            stageTimings.push_back(FXCALLTIMING());
+            stageTimings[t].name = samples[i].name;
+            stageRuns.push_back(0);
+        }
+        if (samples[i].runs == stageRuns[t]) continue;   // did not run this frame
+        stageRuns[t] = samples[i].runs;
+
+        stageTimings[t].wallNs.push_back(samples[i].wallNs);
+        if (samples[i].gpuNs >= 0) stageTimings[t].gpuNs.push_back(samples[i].gpuNs);
+    }
+}
+
+/**
+    fixed step clock so runs are repeatable
+*/
+void FXHeadlessHost::AdvanceClock() {
+    long long stepNs = (long long)(1E9 / setup.fps);
+    long long ns = (long long)startTime.tv_nsec + (frame * stepNs);
+
+    fx->curTime.tv_sec = startTime.tv_sec + (ns / 1000000000LL);
+    fx->curTime.tv_nsec = ns % 1000000000LL;
+
+    // 64 hemidemisemiquavers to a beat, 4 beats to a bar, 64 bars
+    double hdsq = (frame * stepNs / 1E9) * (fx->bpm / 60.0) * 64.0;
+    fx->hemidemisemiQuaverCount = fmod(hdsq, 256.0);
+    fx->bar = ((unsigned long)(hdsq / 256.0)) % 64;
+
+    // the last FXHOST_AUDIOFRAMES up to now, so consecutive buffers overlap like a capture callback
+    if (setup.audio) {
+        long long now = (long long)(frame * stepNs / 1E9 * FXHOST_AUDIORATE);
+        SynthAudio(&audioBuffer[0], FXHOST_AUDIOFRAMES, now - FXHOST_AUDIOFRAMES, fx->bpm);
+        fx->audioData.lastUpdateTime = frame * stepNs / 1E9;
+    }
+}
+
+void FXHeadlessHost::SynthAudio(int16_t* out, int frames, long long firstSample, float bpm) {
+    double beat = 60.0 / bpm;
+    for (int i = 0; i < frames; i++) {
+        double t = (double)(firstSample + i) / FXHOST_AUDIORATE;
+        if (t < 0) t = 0;
+        double sinceBeat = fmod(t, beat);
+        double sinceOff = fmod(t + beat * 0.5, beat);
+
+        double kick = 0.6 * sin(2.0 * M_PI * 55.0 * sinceBeat) * exp(-sinceBeat * 18.0);
+        // hash of the sample index as noise, so runs repeat
+        uint32_t n = (uint32_t)(firstSample + i) * 2654435761u;
+        n ^= n >> 15;
+        double hat = 0.15 * ((n & 0xFFFF) / 32768.0 - 1.0) * exp(-sinceOff * 60.0);
+
+        double l = 0.2 * sin(2.0 * M_PI * 220.0 * t) + kick + hat;
+        double r = 0.2 * sin(2.0 * M_PI * 330.0 * t) + kick + hat;
+        out[i * 2] = (int16_t)(max(-1.0, min(1.0, l)) * 32767);
+        out[i * 2 + 1] = (int16_t)(max(-1.0, min(1.0, r)) * 32767);
+    }
+}
+
+GLuint FXHeadlessHost::CompileShader(GLenum type, const string& name, const string& text) {
+    GLuint s = glCreateShader(type);
+    const char* src = text.c_str();
+    glShaderSource(s, 1, &src, 0);
+    glCompileShader(s);
+
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[2048];
+        glGetShaderInfoLog(s, sizeof(log), 0, log);
+        errorMessage = "shader " + name + " failed: " + log;
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+bool FXHeadlessHost::VertText(const string& name, string& text) {
+    if (vertTexts.count(name)) {
+        text = vertTexts[name];
+        return true;
+    }
+    for (unsigned int i = 0; i < sizeof(hostVertShaders) / sizeof(hostVertShaders[0]); i++) {
+        if (name == hostVertShaders[i][0]) {
+            text = hostVertShaders[i][1];
+            return true;
+        }
+    }
+    return false;
+}
+
+GLuint FXHeadlessHost::FindVertShader(const string& name) {
+    if (vertShaders.count(name)) return vertShaders[name];
+
+    string text;
+    if (!VertText(name, text)) return 0;
+    GLuint s = CompileShader(GL_VERTEX_SHADER, name, text);
+    if (s) vertShaders[name] = s;
+    return s;
+}
+
+GLuint FXHeadlessHost::FindFragShader(const string& name) {
+    if (fragShaders.count(name)) return fragShaders[name];
+    if (!fragTexts.count(name)) return 0;
+    GLuint s = CompileShader(GL_FRAGMENT_SHADER, name, fragTexts[name]);
+    if (s) fragShaders[name] = s;
+    return s;
+}
+
+/**
+    same rules as VIDIFOLD, shaders are taken in order so a program
+    can use any vert/frag declared before it
+
+    with a program cache the vert/frag shaders are only compiled when a program has
+    to be linked from source (a cache hit leaves their FXSHADER id at 0)
+*/
+bool FXHeadlessHost::CompileShaders() {
+    bool lazy = programCache.Enabled();
+
+    for (unsigned int i = 0; i < fx->info.shaderCount; i++) {
+        FXSHADER& sh = fx->shaders[i];
+        sh.error = false;
+
+        if (sh.t == 0) {
+            if (!vertTexts.count(sh.vertShaderName)) vertTexts[sh.vertShaderName] = sh.text;
+            if (!lazy) {
+                sh.id = FindVertShader(sh.vertShaderName);
+                if (!sh.id) { sh.error = true; return Fail(errorMessage); }
+            }else sh.id = vertShaders.count(sh.vertShaderName) ? vertShaders[sh.vertShaderName] : 0;
+
+        }else if (sh.t == 1) {
+            if (!fragTexts.count(sh.fragShaderName)) fragTexts[sh.fragShaderName] = sh.text;
+            if (!lazy) {
+                sh.id = FindFragShader(sh.fragShaderName);
+                if (!sh.id) { sh.error = true; return Fail(errorMessage); }
+            }else sh.id = fragShaders.count(sh.fragShaderName) ? fragShaders[sh.fragShaderName] : 0;
+
+        }else if (sh.t == 2) {
+            if (!programs.count(sh.programShaderName)) {
+                string vertText;
+                if (!VertText(sh.vertShaderName, vertText) || !fragTexts.count(sh.fragShaderName)) {
+                    sh.error = true;
+                    return Fail("program " + sh.programShaderName + " missing vert/frag shader");
+                }
+                uint64_t key = programCache.Key(vertText, fragTexts[sh.fragShaderName]);
+                GLuint p = programCache.Load(key);
+
+                if (!p) {
+                    GLuint vs = FindVertShader(sh.vertShaderName);
+                    GLuint fs = vs ? FindFragShader(sh.fragShaderName) : 0;
+                    if (!vs || !fs) {
+                        sh.error = true;
+                        return Fail(errorMessage);
+                    }
+
+                    p = glCreateProgram();
+                    glAttachShader(p, vs);
+                    glAttachShader(p, fs);
+                    if (programCache.Enabled()) FXProgramCache::PrepareLink(p);
+                    glLinkProgram(p);
+
+                    GLint ok = 0;
+                    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+                    if (!ok) {
+                        char log[2048];
+                        glGetProgramInfoLog(p, sizeof(log), 0, log);
+                        glDeleteProgram(p);
+                        sh.error = true;
+                        return Fail("program " + sh.programShaderName + " failed: " + log);
+                    }
+                    programCache.Store(key, p);
+                }
+                programs[sh.programShaderName] = p;
+            }
+            sh.id = programs[sh.programShaderName];
+
+            for (int j = 0; j < sh.paramCount; j++) {
+                sh.params[j].id = glGetUniformLocation(sh.id, sh.params[j].name.c_str());
+            }
+        }
+    }
+    return true;
+}
+
+static unsigned int NextPowerOfTwo(unsigned int v) {
+    unsigned int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+bool FXHeadlessHost::CreateBuffer(FXBUFFERDETAILS& b, unsigned int width, unsigned int height, bool depth) {
+    b.width = width;
+    b.height = height;
+    b.sqsize = NextPowerOfTwo(width > height ? width : height);
+    b.orthRatioX = 1.0f / width;
+    b.orthRatioY = 1.0f / height;
+    b.fboBufferSize = width * height * 4;
+
+    glGenTextures(1, &b.TextureID);
+    glBindTexture(GL_TEXTURE_2D, b.TextureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    glGenFramebuffers(1, &b.FBOID);
+    glBindFramebuffer(GL_FRAMEBUFFER, b.FBOID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, b.TextureID, 0);
+
+    if (depth) {
+        glGenTextures(1, &b.DepthID);
+        glBindTexture(GL_TEXTURE_2D, b.DepthID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, b.DepthID, 0);
+    }
+
+    b.status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (b.status != GL_FRAMEBUFFER_COMPLETE) return Fail("incomplete framebuffer");
+    return true;
+}
+
+void FXHeadlessHost::DestroyBuffer(FXBUFFERDETAILS& b) {
+    if (b.FBOID) glDeleteFramebuffers(1, &b.FBOID);
+    if (b.TextureID) glDeleteTextures(1, &b.TextureID);
+    if (b.DepthID) glDeleteTextures(1, &b.DepthID);
+    b.FBOID = 0;
+    b.TextureID = 0;
+    b.DepthID = 0;
+}
+
+/**
+    source textures are power of 2 with the image in the bottom left corner,
+    so tx2/ty2 = image size / sqsize (same as the video sources in VIDIFOLD)
+*/
+void FXHeadlessHost::CreateSources() {
+    unsigned int w = setup.sourceWidth;
+    unsigned int h = setup.sourceHeight;
+    unsigned int sq = NextPowerOfTwo(w > h ? w : h);
+    unsigned int count = setup.sourceCount;
+    if (count < 1) count = 1;
+    if (count > MAXFXSOURCES) count = MAXFXSOURCES;
+
+    vector<unsigned char> pixels(sq * sq * 4, 0);
+    double startNs = (startTime.tv_sec * 1E9) + startTime.tv_nsec;
+
+    for (unsigned int i = 0; i < count; i++) {
+        // gradient with a checker so each source is different and filtering shows
+        for (unsigned int y = 0; y < h; y++) {
+            for (unsigned int x = 0; x < w; x++) {
+                unsigned char* p = &pixels[(y * sq + x) * 4];
+                bool check = ((x >> 5) ^ (y >> 5) ^ i) & 1;
+                p[0] = (x * 255) / w;
+                p[1] = (y * 255) / h;
+                p[2] = check ? 255 : (i * 40) & 0xFF;
+                p[3] = 255;
+            }
+        }
+
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, sq, sq, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        sourceTextures.push_back(tex);
+
+        FXSOURCE& src = fx->source[i];
+        src.id = tex;
+        src.tx2 = (float)w / sq;
+        src.ty2 = (float)h / sq;
+        src.w = sq;
+        src.h = sq;
+        src.d = 4;
+        src.startTimestamp = startNs;
+        src.effectStartTimestamp = startNs;
+        src.length = 0;
+        src.playbackPrecentage = -1;
+        src.localSpeed = 1;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/**
+    TEXREQ_ textures are supplied in bufferA
+    the reference host just fills it with white noise for any of them
+*/
+void FXHeadlessHost::FillSpecialTextures() {
+    int req = fx->info.specialTexturesRequested;
+    if (!(req & (TEXREQ_WHITE_NOISE | TEXREQ_PERLIN_NOISE | TEXREQ_BLUE_NOISE))) return;
+
+    unsigned int w = fx->bufferA.width;
+    unsigned int h = fx->bufferA.height;
+    vector<unsigned char> pixels(w * h * 4);
+    unsigned int seed = 0x9E3779B9;
+    for (unsigned int i = 0; i < pixels.size(); i++) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        pixels[i] = seed & 0xFF;
+    }
+    glBindTexture(GL_TEXTURE_2D, fx->bufferA.TextureID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool FXHeadlessHost::ReadOutput(vector<unsigned char>& pixels) {
+    if (!fx) return false;
+    pixels.resize(fx->outputBuffer.width * fx->outputBuffer.height * 4);
+    glBindFramebuffer(GL_FRAMEBUFFER, fx->outputBuffer.FBOID);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, fx->outputBuffer.width, fx->outputBuffer.height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
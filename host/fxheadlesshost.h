@@ -0,0 +1,171 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    Headless reference host
+
+    Loads a built plugin (.so) and drives it the same way VIDIFOLD does, but on a
+    surfaceless EGL context (Mesa/llvmpipe is fine) so plugins can be run and timed
+    outside of the real host.
+
+    1 - dlopens the plugin and checks FXSystemVersionFunc against FXHOST_SYSTEM_VERSION
+    2 - resolves the required extern "C" entry points (Random is optional)
+    3 - CreateInstance, supplies an FXOBJECT and calls Init
+    4 - compiles shaders[] (including the default 000-xTextureVert host shaders)
+    5 - creates output/bufferA/B/C and any requestedBuffers, fills source[] textures
+    6 - per frame: advances the clock, calls Update then Process
+
+    Every entry point call is timed (wall clock ns and optionally GPU ns with GL_TIME_ELAPSED),
+    plugins built with -DFX_PROFILE also report their internal stages (see fxprofile.h).
+*/
+
+#ifndef FXHEADLESSHOST_H
+#define FXHEADLESSHOST_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <EGL/egl.h>
+
+#include "../fxpluginstructures.h"
+#include "../fxprofile.h"
+#include "../fxdynres.h"
+#include "../fxprogramcache.h"
+
+#define FXHOST_SYSTEM_VERSION 9
+#define FXHOST_AUDIORATE 44100
+#define FXHOST_AUDIOFRAMES 1024     // a full FXAUDIODETAILS buffer
+
+// entry points the host times
+enum FXHOSTCALL {
+    FXCALL_CREATEINSTANCE,
+    FXCALL_INIT,
+    FXCALL_UPDATE,
+    FXCALL_PROCESS,
+    FXCALL_RANDOM,
+    FXCALL_GETSTATE,
+    FXCALL_SETSTATE,
+    FXCALL_DEINIT,
+    FXCALL_COUNT
+};
+
+// what the host sets up before Init
+struct FXHOSTSETUP {
+    unsigned int outputWidth, outputHeight;     // output/bufferA/B/C size (also display size)
+    unsigned int sourceWidth, sourceHeight;     // image size inside source[0] (tx2/ty2 = size/sqsize)
+    unsigned int sourceCount;                   // how many of source[0..] get a texture (mixers want up to 11)
+    float fps;                                  // host clock step per frame
+    float bpm;
+    bool finishEachCall;                        // glFinish after each call so wall time includes the GPU work
+    bool gpuTiming;                             // GL_TIME_ELAPSED query around each Update/Process call
+    int randomEvery;                            // call Random every n frames (0 = never)
+    int stateEvery;                             // GetState/SetState round trip every n frames (0 = never)
+    bool audio;                                 // feed audioData with SynthAudio (44.1k, 1024 frames per update)
+    string programCache;                        // program binary cache dir, "" = always compile (see fxprogramcache.h)
+};
+
+// raw per call samples in ns
+struct FXCALLTIMING {
+    string name;
+    vector<double> wallNs;
+    vector<double> gpuNs;
+};
+
+// signatures from main.cpp
+typedef int (*FXSystemVersionFuncPtr)(void);
+typedef void* (*FXCreateInstancePtr)(void);
+typedef void (*FXInitPtr)(void*,void*);
+typedef void (*FXPointerFuncPtr)(void*);
+typedef bool (*FXSetStatePtr)(void*,void*);
+typedef int (*FXProfileStagesPtr)(void*,void*,int);
+typedef bool (*FXDynamicResolutionPtr)(void*,void*);
+
+class FXHeadlessHost
+{
+    public:
+        FXHeadlessHost();
+        virtual ~FXHeadlessHost();
+
+        bool CreateContext();
+        void DestroyContext();
+
+        bool LoadPlugin(string filename);
+        void UnloadPlugin();
+
+        bool StartInstance(const FXHOSTSETUP& setup);
+        void RunFrame();
+        void StopInstance();
+
+        void ClearTimings();
+        // forget every compiled shader/program (they are normally kept for the next instance)
+        void ClearShaders();
+        bool ReadOutput(vector<unsigned char>& pixels);
+        // the plugin's dynamic resolution state, false if it has none (or it's off)
+        bool DynamicResolution(FXDYNRESSTATS& stats);
+
+        static FXHOSTSETUP DefaultSetup();
+        static double NowNs();
+        // test signal: a tone per channel, a kick on every beat and a hat on the off beats
+        static void SynthAudio(int16_t* out, int frames, long long firstSample, float bpm);
+
+        FXOBJECT* fx;
+        FXCALLTIMING timings[FXCALL_COUNT];
+        FXProgramCache programCache;
+        vector<FXCALLTIMING> stageTimings;      // plugin internal stages (FX_PROFILE builds only)
+        long frame;
+        string errorMessage;
+        string glRenderer;
+
+    protected:
+    private:
+        EGLDisplay display;
+        EGLContext context;
+
+        void* library;
+        void* instance;
+        FXHOSTSETUP setup;
+
+        FXSystemVersionFuncPtr fnSystemVersion;
+        FXCreateInstancePtr fnCreateInstance;
+        FXInitPtr fnInit;
+        FXPointerFuncPtr fnUpdate;
+        FXPointerFuncPtr fnProcess;
+        FXPointerFuncPtr fnRandom;
+        FXPointerFuncPtr fnGetState;
+        FXSetStatePtr fnSetState;
+        FXPointerFuncPtr fnDeinit;
+        FXProfileStagesPtr fnProfileStages;
+        FXDynamicResolutionPtr fnDynamicResolution;
+        GLuint gpuQuery;
+        vector<long> stageRuns;
+
+        // shaders with the same name are only created once for all instances (same as VIDIFOLD)
+        map<string,GLuint> vertShaders;
+        map<string,GLuint> fragShaders;
+        map<string,GLuint> programs;
+        // source of each named shader, programs are looked up in the cache by it
+        map<string,string> vertTexts;
+        map<string,string> fragTexts;
+
+        vector<GLuint> sourceTextures;
+        vector<int16_t> audioBuffer;
+        struct timespec startTime;
+
+        bool CompileShaders();
+        GLuint CompileShader(GLenum type, const string& name, const string& text);
+        GLuint FindVertShader(const string& name);
+        GLuint FindFragShader(const string& name);
+        bool VertText(const string& name, string& text);
+        bool CreateBuffer(FXBUFFERDETAILS& b, unsigned int width, unsigned int height, bool depth);
+        void DestroyBuffer(FXBUFFERDETAILS& b);
+        void CreateSources();
+        void FillSpecialTextures();
+        void AdvanceClock();
+        void CollectStages();
+        void* Resolve(const char* name, bool required);
+        bool Fail(string message);
+};
+
+#endif // FXHEADLESSHOST_H
@@ -0,0 +1,130 @@
+/**
+    This is part of the example/base plugin files for creating FXPlugins for VIDIFOLD.
+    see README.md for further notes.
+
+    fxhost - runs a plugin headless for N frames and prints per call timings
+
+    usage: fxhost plugin.so [-frames n] [-size WxH] [-source WxH] [-sources n] [-fps f]
+                            [-random n] [-state n] [-nofinish] [-dump file.raw] [-record dir] [-audio]
+                            [-shadercache dir]
+*/
+
+#include "fxheadlesshost.h"
+
+#include <string.h>
+#include <algorithm>
+
+static void Usage() {
+    printf("usage: fxhost plugin.so [-frames n] [-size WxH] [-source WxH] [-sources n] [-fps f]\n"
+           "                        [-random n] [-state n] [-nofinish] [-dump file.raw] [-record dir] [-audio]\n"
+           "                        [-shadercache dir]\n");
+}
+
+static bool ParseSize(const char* s, unsigned int& w, unsigned int& h) {
+    return sscanf(s, "%ux%u", &w, &h) == 2 && w > 0 && h > 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        Usage();
+        return 1;
+    }
+
+    string pluginFile = argv[1];
+    string dumpFile;
+    long frames = 300;
+    FXHOSTSETUP setup = FXHeadlessHost::DefaultSetup();
+
+    for (int a = 2; a < argc; a++) {
+        bool more = a + 1 < argc;
+        if (!strcmp(argv[a], "-frames") && more) frames = atol(argv[++a]);
+        else if (!strcmp(argv[a], "-size") && more) {
+            if (!ParseSize(argv[++a], setup.outputWidth, setup.outputHeight)) { Usage(); return 1; }
+        }else if (!strcmp(argv[a], "-source") && more) {
+            if (!ParseSize(argv[++a], setup.sourceWidth, setup.sourceHeight)) { Usage(); return 1; }
+        }else if (!strcmp(argv[a], "-sources") && more) setup.sourceCount = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "-fps") && more) setup.fps = atof(argv[++a]);
+        else if (!strcmp(argv[a], "-random") && more) setup.randomEvery = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "-state") && more) setup.stateEvery = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "-nofinish")) setup.finishEachCall = false;
+        else if (!strcmp(argv[a], "-dump") && more) dumpFile = argv[++a];
+        else if (!strcmp(argv[a], "-audio")) setup.audio = true;      // synthetic audio feed
+        else if (!strcmp(argv[a], "-shadercache") && more) setup.programCache = argv[++a];
+        else if (!strcmp(argv[a], "-record") && more) setenv("FXRECORD_DIR", argv[++a], 1);   // picked up by the plugin base
+        else {
+            Usage();
+            return 1;
+        }
+    }
+
+    FXHeadlessHost host;
+    double startNs = 0;
+    if (!host.CreateContext() || !host.LoadPlugin(pluginFile)) {
+        printf("fxhost: %s\n", host.errorMessage.c_str());
+        return 1;
+    }
+    startNs = FXHeadlessHost::NowNs();
+    if (!host.StartInstance(setup)) {
+        printf("fxhost: %s\n", host.errorMessage.c_str());
+        return 1;
+    }
+    startNs = FXHeadlessHost::NowNs() - startNs;
+
+    printf("fxhost: %s (%s) on %s\n", host.fx->info.canonicalName.c_str(), pluginFile.c_str(), host.glRenderer.c_str());
+    printf("output %ux%u source %ux%u (tx2 %.4f ty2 %.4f) %ld frames\n\n",
+        setup.outputWidth, setup.outputHeight, setup.sourceWidth, setup.sourceHeight,
+        host.fx->source[0].tx2, host.fx->source[0].ty2, frames);
+    if (!setup.programCache.empty()) {
+        FXPROGRAMCACHESTATS c = host.programCache.Stats();
+        printf("start %.2f ms, program cache %s: %ld hits %ld misses %ld rejected %ld stored\n\n", startNs / 1E6,
+            host.programCache.Enabled() ? setup.programCache.c_str() : "unavailable (no binary formats)",
+            c.hits, c.misses, c.rejected, c.stored);
+    }else {
+        printf("start %.2f ms\n\n", startNs / 1E6);
+    }
+
+    FXDYNRESSTATS dynres;
+    float scale = 1.0f;
+    for (long f = 0; f < frames; f++) {
+        host.RunFrame();
+        if (host.fx->error) {
+            printf("fxhost: plugin error at frame %ld: %s\n", f, host.fx->errorMessage.c_str());
+            break;
+        }
+        // plugins with dynamic resolution on (see fxdynres.h), each step as it happens
+        if (host.DynamicResolution(dynres) && dynres.scale != scale) {
+            printf("frame %ld: resolution scale %.3f (gpu %.2f ms average, %.2f ms budget)\n", f, dynres.scale, dynres.averageMs, dynres.budgetMs);
+            scale = dynres.scale;
+        }
+    }
+    if (host.DynamicResolution(dynres)) {
+        printf("dynamic resolution: scale %.3f (min %.3f), gpu %.2f ms last %.2f ms average %.2f ms budget, %ld changes, %ld timed %ld skipped\n\n",
+            dynres.scale, dynres.minScale, dynres.lastMs, dynres.averageMs, dynres.budgetMs, dynres.changes, dynres.samples, dynres.skipped);
+    }
+
+    if (!dumpFile.empty()) {
+        vector<unsigned char> pixels;
+        host.ReadOutput(pixels);
+        FILE* f = fopen(dumpFile.c_str(), "wb");
+        if (f) {
+            fwrite(&pixels[0], 1, pixels.size(), f);
+            fclose(f);
+        }else {
+            printf("fxhost: could not write %s\n", dumpFile.c_str());
+        }
+    }
+
+    host.StopInstance();
+
+    printf("%-16s %8s %12s %12s %12s\n", "call", "count", "mean ms", "min ms", "max ms");
+    for (int c = 0; c < FXCALL_COUNT; c++) {
+        vector<double>& s = host.timings[c].wallNs;
+        if (s.empty()) continue;
+
+        double total = 0;
+        for (unsigned int i = 0; i < s.size(); i++) total += s[i];
+        printf("%-16s %8u %12.4f %12.4f %12.4f\n", host.timings[c].name.c_str(), (unsigned int)s.size(),
+            (total / s.size()) / 1E6, *min_element(s.begin(), s.end()) / 1E6, *max_element(s.begin(), s.end()) / 1E6);
+    }
+    return 0;
+}
@@ -65,6 +65,7 @@ extern "C"
 	// on unloading plugin
 	void Deinit(void* pointer) {
 		PluginPrivateObject* p = (PluginPrivateObject*)pointer;
+		p->Deinit();    // release any GL objects while the host context is still current
 		delete(p);
 	}
 
@@ -78,4 +79,18 @@ extern "C"
 		PluginPrivateObject* p = (PluginPrivateObject*)pointer;
 		return p->SetState((FXSTATE*)fxstate);
 	}
+
+#ifdef FX_PROFILE
+	// optional, benchmark hosts only (see fxprofile.h)
+	int ProfileStages(void* pointer, void* samples, int maxSamples) {
+		PluginPrivateObject* p = (PluginPrivateObject*)pointer;
+		return p->ProfileStages((FXPROFILESAMPLE*)samples, maxSamples);
+	}
+#endif
+
+	// optional, the dynamic resolution scale/timings for instrumentation (see fxdynres.h)
+	bool DynamicResolution(void* pointer, void* stats) {
+		PluginPrivateObject* p = (PluginPrivateObject*)pointer;
+		return p->DynamicResolution((FXDYNRESSTATS*)stats);
+	}
 }
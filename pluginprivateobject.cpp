@@ -21,6 +21,7 @@
 #include "pluginprivateobject.h"
 
 #include <sstream>
+#include <string.h>
 #include <cmath>
 
 /**
@@ -33,11 +34,30 @@ NOT included in this simple example plugin (https://github.com/g-truc/glm)
 #include <glm/gtx/quaternion.hpp>
 */
 
+constexpr FXPARAMDESC<PluginPrivateObject> PluginPrivateObject::paramDescs[];
+
 PluginPrivateObject::PluginPrivateObject() {
 	firstRun = true;
-    FPns = floor((double)1E9 / (double)25);  // defaulting speed to 25fps
+    quad = 0;
+    gl = 0;
+    workers = 0;
+    audio = 0;
+    audioHistoryParam = -1;
+    texCoordsParam = -1;
+    mixerParam = -1;
+    historyParam = -1;
+    graphScaled = examplePass = upscalePass = -1;
+    upscaleShader = -1;
+    blurSource = -1;
+    noise = 0;
+    noiseHandle = noiseParam = -1;
+    shaderFailures = 0;
+    imageFailures = 0;
+    frameNumber = 0;
+    clock.SetFrameRate(25);     // defaulting speed to 25fps
+    framesTraveled = 0;
+    gentimer = 0;
     resetTriggered = false;
-    srand (time(NULL));     // initialize random seed
 
 
     // some common values and lists I use
@@ -55,27 +75,9 @@ PluginPrivateObject::PluginPrivateObject() {
     sourceLabels[7] = "B Top Layer";
     sourceLabels[8] = "B Upper";
     sourceLabels[9] = "B Lower";
-    sourceLabels[10] = "B Bottom Layer";
-
-    beatLabels[0] = "1/16";
-    beatLabels[1] = "1/8";
-    beatLabels[2] = "1/4";
-    beatLabels[3] = "1/2";  // default
-    beatLabels[4] = "1";
-    beatLabels[5] = "2";
-    beatLabels[6] = "4";
-    beatLabels[7] = "8";
-    beatLabels[8] = "16";
-
-    hdsqDelays[0] = 16;     // 1/16
-    hdsqDelays[1] = 32;     // 1/8
-    hdsqDelays[2] = 64;     // 1/4
-    hdsqDelays[3] = 128;    // 1/2
-    hdsqDelays[4] = 256;    // 1 bar
-    hdsqDelays[5] = 512;    // 2 bar
-    hdsqDelays[6] = 1024;   // 4 bar
-    hdsqDelays[7] = 2048;   // 8 bar
-    hdsqDelays[8] = 4096;   // 16 bar*/
+    sourceLabels[10] = "B Bottom Layer";*/
+
+    // beat division labels/lengths are in FXBeatClock (Label/Length)
 
     /*channelLabels[0] = "RGB";
     channelLabels[1] = "R--";
@@ -154,11 +156,7 @@ void PluginPrivateObject::CreateShaders() {
 		"out vec4 color;\n"         // holds final fragment colour
 		" vec2 resolution = vec2(i[1],i[2]);\n"
 		" vec2 cord = gl_FragCoord.xy / resolution.xy;\n"
-		"  uv.x *= i[3];\n"									// scale to texture edges (not nessarly full 1.0!)
-		"  uv.x = mod((mod(uv.x,i[3])+i[3]),i[3]);\n" // roll around 0-tx
-		"  uv.y *= i[4];\n"
-		"  uv.y = mod((mod(uv.y,i[4])+i[4]),i[4]);\n" // roll around 0-ty
-		"  gl_fragColor = texture2D(tex0, uv);\n"
+		"  gl_fragColor = fxTexture(tex0, cord);\n"			// FXTEXCOORDS_GLSL, scaled to tx2/ty2 and wrapped (see CreateTexCoordParams)
 		*/
 
 
@@ -174,16 +172,46 @@ void PluginPrivateObject::CreateShaders() {
     id++;
 	fx->shaders[id].t = 2;
 	fx->shaders[id].text = "";
-	fx->shaders[id].vertShaderName = "000-1TextureVert"; //*** or  "000-1TextureVert330"; // for version 330
+	fx->shaders[id].vertShaderName = "000-1TextureVert"; //*** or FXQUAD_VERT330_NAME for version 330 (see below)
 	fx->shaders[id].fragShaderName = "000-VIDIFOLD-DEMO-TextureFrag";
 	fx->shaders[id].programShaderName = "000-VIDIFOLD-DEMO-Shader";
 	fx->shaders[id].paramCount = 0;
-	//CreateShaderParam(id,0,"MVP",0.0f);	// v330 the 2nd and 4th params dont mean anything here
+	// v330 using the attribute-less quad, add a t=0 entry before this program with
+	// vertShaderName = FXQUAD_VERT330_NAME and text = FXQUAD_VERT330, then
+	//CreateShaderParam(id,1,"fxQuadPos",0.0f);	// the 2nd and 4th params dont mean anything here
+	//CreateShaderParam(id,1,"fxQuadUV",0.0f);
+	//CreateShaderParam(id,1,"fxQuadSize",0.0f);
 	CreateShaderParam(id,0,"tex0",0.0f);
 	CreateShaderParam(id,1,"i",0.0f);
+	// FXPT_AUDIO plugins can sample the audio history (add FXAUDIOHISTORY_GLSL to the frag text)
+	//audioHistory.Init(256);     // rows, ~5s of updates
+	//CreateAudioHistoryParams(id);
+	// 0-1 texcoords with wrap/aspect done in the shader (add FXTEXCOORDS_GLSL, draw with 1.0 instead of tx2/ty2)
+	//CreateTexCoordParams(id);
+	//texCoords.SetWrap(FXWRAP_MIRROR);
+	// FXPT_MIXER plugins, shaders[0].text = FXLayerMixer::ShaderText() (no tex0/i then) and the layers in InitPlugin
+	//CreateMixerParams(id);
+	// echo/feedback, the last 32 frames at half size (add history.GLSL() to the frag text after #version)
+	//history.Init(32, 0.5f, FXHISTORY_RGB565);
+	//CreateFrameHistoryParams(id);
+	// dither/grain from a noise tile sampled per pixel (add FXNOISE_GLSL to the frag text, the tile is requested in InitPlugin)
+	//CreateNoiseParams(id);
+	// toggles/selectors as #defines instead of uniform branches, the frag text tests them with #if
+	// and this program (keys as uniforms or left at the defaults) is what draws if a variant fails
+	variants.Init(&fx->shaders[id], fx->shaders[0].text);
+	//mirrorKey = variants.AddKey("MIRROR", 2);
+	//variants.Prewarm();     // build the other combinations one per frame, so flipping it never waits
+	// a heavy shader can be built in the background instead, give the host a cheap program
+	// (eg a plain texture copy) and the real text to Init, Process draws with the host's until it links
+	//variants.Activate();
 	fx->shaders[id].error = false;	// set by host program
 	fx->shaders[id].id = 0;	// set by host program
 	fx->info.shaderCount++;
+
+	// the bicubic upscale for dynamic resolution, only if dynres.Init was called (see InitPlugin)
+	if (dynres.Enabled()) CreateUpscaleShader();
+	// blur/glow kernels, shared by name with any other plugin using them (see InitPlugin for the passes)
+	//CreateBlurShaders();
 }
 
 void PluginPrivateObject::InitPlugin() {
@@ -210,13 +238,43 @@ void PluginPrivateObject::InitPlugin() {
     //fx->requestedBuffers[0].height = 0;
     //fx->requestedBuffers[0].DepthID = 0;
 
-	CreateParam(FXP_RANGE,"Red",0,100,0,0);
-	// example of a multistate button
+	// a mixer (FXPT_MIXER) draws its layers bottom first, bus A with bus B screened over it
+	//mixer.AddLayer(1);
+	//mixer.AddLayer(6, 0.5f, FXBLEND_SCREEN);
+
+	// everything in paramDescs (see pluginprivateobject.h)
+	params.Create(fx);
+	// hand written params can still follow on, eg a multistate button
 	//CreateParam(FXP_MULTI_STATE,dirLabel[dir],0,3,dir,dir);  // forward/backward/bothward
 	//CreateParam(FXP_COLOURSELECTOR,"Tint",0,0,0,0xFFFFFFFF);
 
+	// drop the resolution of the example when it takes more than 8ms of GPU a frame (see fxdynres.h)
+	//dynres.Init(8.0);
+
 	CreateShaders();
 
+	// values are set as they change (see Update) and uploaded in Process
+	uniforms.Attach(&fx->shaders[1]);
+	uniforms.Set1i(0, 0);   // tex0 is always unit 0
+
+	// the example is a single pass straight into the output, multi pass effects declare theirs
+	// ahead of it and the graph hands out bufferA/B/C/requestedBuffers (see fxrendergraph.h)
+	graphOutput = graph.Output(&fx->outputBuffer);
+	examplePass = graph.AddPass("example", [this](FXRenderGraph&){ Process120Example(); });
+	graph.Write(examplePass, graphOutput, FXWRITE_FULL);     // every pixel drawn, so no clear
+	if (dynres.Enabled()) {
+		// while the scale is under 1 the example draws into graphScaled instead (ApplyDynamicResolution)
+		graphScaled = graph.Texture();
+		upscalePass = graph.AddPass("upscale", [this](FXRenderGraph& g){ ProcessUpscale(g); });
+		graph.Read(upscalePass, graphScaled);
+		graph.Write(upscalePass, graphOutput, FXWRITE_FULL);
+		graph.Enable(upscalePass, false);
+	}
+	// a blur of source[0] straight into the output (the example is then culled), see fxblur.h
+	//blurSource = graph.Source(fx->source[0].id, fx->outputBuffer.width, fx->outputBuffer.height);
+	//blur.Set(FXBLUR_GAUSSIAN, 40.0f);
+	//blur.Add(graph, blurSource, graphOutput);
+
 	fx->bypass = false;
 	fx->outputBuffer.FBOID = 0;
 	fx->outputBuffer.TextureID = 0;
@@ -235,22 +293,65 @@ void PluginPrivateObject::InitPlugin() {
 	fx->errorMessage = "";
 
 
-    localPrevTime = (fx->curTime.tv_sec *1E9) + fx->curTime.tv_nsec;
-    srand(time(0));
+    clock.Reset(fx);
+    // once per process, instances started in the same second reseeding rand() all drew the same sequence
+    static std::once_flag seeded;
+    std::call_once(seeded, []{ srand(time(0)); });
+
+    audio = FXAudioAnalyser::Acquire();    // before Reset, it runs Update
 
 	Reset();
 
-    // init vbo
-	//glGenBuffers(1,&sqvertsVBO);
-	//glGenBuffers(1,&squvsVBO);
+    // shared quad, the vbo is created on first draw
+    quad = FXQuad::Acquire();
+    gl = FXGLState::Acquire();
+    workers = FXWorkerPool::Acquire();
+    images.Init(workers);
+    blur.Attach(gl, quad);
+    noise = FXNoise::Acquire();
+    // blue noise for dithering, 8 frames of it, made on a worker the first time (from disk after that)
+    // and one texture for every instance asking for the same
+    //noiseHandle = noise->Request(FXNoise::Params(FXNOISE_BLUE, 64, 1, 8));
+
+    // shader development, edits to the file show up without reloading the plugin
+    const char* watch = getenv("FXSHADER_WATCH");
+    if (watch && *watch) shaderWatch.Open(watch, workers);
 };
 
 void PluginPrivateObject::Deinit() {
-    /**
-        //a more modern example
-        glDeleteBuffers(1,&squvsVBO);
-        glDeleteBuffers(1,&sqvertsVBO);
-    */
+    // finish writing any outstanding DumpFBO captures and recorded frames
+    ServiceReadback(true);
+    images.Wait();    // dumps still being written
+    ServiceReadback(false);     // nothing left to read, reports any that failed
+    readback.Deinit();
+    if (recorder.Recording()) {
+        recorder.Stop();
+        FXRECORDSTATS s = recorder.Stats();
+        Debug("recorded %ld of %ld frames (%ld dropped, %ld write errors, max queued %d)\n",
+            s.written, s.submitted, s.dropped, s.writeErrors, s.maxQueued);
+    }
+
+    profiler.Deinit();
+    uniforms.Detach();
+    shaderWatch.Close();
+    variants.Deinit();
+    audioHistory.Deinit();
+    history.Deinit();
+    dynres.Deinit();
+    blur.Deinit();
+    if (noise) noise->Drop(noiseHandle);
+    noiseHandle = -1;
+    FXNoise::Release(noise);
+    noise = 0;
+
+    FXQuad::Release(quad);
+    quad = 0;
+    FXGLState::Release(gl);
+    gl = 0;
+    FXWorkerPool::Release(workers);
+    workers = 0;
+    FXAudioAnalyser::Release(audio);
+    audio = 0;
 }
 
 /**
@@ -261,18 +362,45 @@ void PluginPrivateObject::Deinit() {
 */
 void PluginPrivateObject::GetState() {
     // NOTE: snap is is passed to host to deal with (DO NOT delete/free this in CLIENT)
-    PluginPrivateState* snapForHOST = new PluginPrivateState;
-	snapForHOST->r = fx->interfaceparams[0].curValue;
+    FXStateWriter snap = snapshots.Snapshot(PLUGIN_STATE_VERSION, ParamTable::schemaHash);
+    params.Save(fx, this, snap);
+    // anything else worth keeping goes in as its own field, eg
+    //snap.PutDouble(FXStateTag("timepos"), timepos);
 
-	fx->state.version = 1; // dont forget to update this with current state version
-	fx->state.size = sizeof(PluginPrivateState);
-	fx->state.data = (void*) snapForHOST;
+    snapshots.Publish(snap, fx->state);
 };
 
 void PluginPrivateObject::nonUpdateOnParams(){
     //fx->interfaceparams[5].update = false; // eg dont want to trigger a button
 }
 
+/**
+    state migrations, each one writes the fields of the version it upgrades to
+    (add a step here whenever PLUGIN_STATE_VERSION goes up)
+*/
+const FXStateStore<PluginPrivateObject>::Migration PluginPrivateObject::stateMigrations[] = {
+    { 1, 3, &PluginPrivateObject::MigrateState1 },
+    { 2, 3, &PluginPrivateObject::MigrateState2 },
+};
+
+// version 1 was the plain PluginPrivateState struct
+bool PluginPrivateObject::MigrateState1(const FXSTATE& in, FXStateWriter& out) {
+    if (in.size < (int)sizeof(PluginPrivateState)) return false;
+    PluginPrivateState old;
+    memcpy(&old, in.data, sizeof(old));
+    out.PutInt(FXStateTag("Red"), old.r);
+    return true;
+}
+
+// version 2 was the packed param table
+bool PluginPrivateObject::MigrateState2(const FXSTATE& in, FXStateWriter& out) {
+    if (in.size != (int)sizeof(PackedState)) return false;
+    PackedState old;
+    memcpy(&old, in.data, sizeof(old));
+    ParamTable::PackedToFields(old, out);
+    return true;
+}
+
 /**
     When recalling a setup (patch/snapshot/interlude..etc)
     VIDIFOLD will send over a state that was prev capture from the GetState function
@@ -281,82 +409,33 @@ void PluginPrivateObject::nonUpdateOnParams(){
     older states being supplied
 */
 bool PluginPrivateObject::SetState(FXSTATE* fxstate) {
-    /**
-        //possible example of how to handle an state migration
-        PluginPrivateState* localState = new PluginPrivateState;
-
-        if (fxstate->version == 1) {
-            _migrateState1(fxstate, localState);
-            _useState2(fxstate, localState);
-        }else if (fxstate->version == 2){
-            _useState2(fxstate,0);
-        }else {
-            return false;
-        }
-
-        return true;
-    */
-
-	if (fxstate->version == 1) {
-
-        PluginPrivateState* localState = new PluginPrivateState;
-
-		localState = (PluginPrivateState*)fxstate->data;
-
-		fx->interfaceparams[0].curValue = localState->r;
-
-		// now upate / convert values locally
-		for(unsigned int i=0; i<fx->info.paramCount; i++) fx->interfaceparams[i].update = true;
-        nonUpdateOnParams();
-        // NOTE: dont force resetTriggered here (causes problems)
-		Update();
-		// Host is responsible for panel update in this case
-		return true;
-	}
-
-	return false;
-};
-
-/**
-    possible example of how to handle an state migrations
-// copy old state value across and add new defaults
-// fxstate required to update version, this fills localstate
-void PluginPrivateObject::_migrateState1(FXSTATE* fxstate, PluginPrivateState* localState){
-    PluginPrivateState_v1* snap_v1 = (PluginPrivateState_v1*)fxstate->data;
-
-    localState->mode = snap_v1->mode;
-    localState->scale = snap_v1->scale;
-    localState->freq = snap_v1->freq;
-
-    // add new param default
-    localState->mirror = 0;
-
-    fxstate->version = 2;
-}
-//if local state passed, then it holds the newly migrated details
-void PluginPrivateObject::_useState2(FXSTATE* fxstate, PluginPrivateState* localState){
-    // didn't have to migrate so grab data
-    if (localState == 0){
-        localState = (PluginPrivateState*)fxstate->data;
+    // older versions are upgraded through stateMigrations first (nothing is allocated)
+    FXStateReader snap;
+    if (!snapshots.Upgrade(this, fxstate, PLUGIN_STATE_VERSION, stateMigrations, FXPARAMCOUNT(stateMigrations), snap)) {
+        return false;
+    }
+    if (snap.SchemaHash() != 0 && snap.SchemaHash() != ParamTable::schemaHash) {
+        // same version but the table changed, fields still load by name
+        Debug("%s: state from a different param table, loading what matches\n", fx->info.canonicalName.c_str());
     }
 
-    fx->interfaceparams[0].curValue = localState->mode;
-    fx->interfaceparams[1].curValue = localState->scale;
-    fx->interfaceparams[2].curValue = localState->freq;
+    // now upate / convert values locally (Load flags whatever it sets)
+    params.Load(snap, fx, this);
+    for(unsigned int i=params.End(); i<fx->info.paramCount; i++) fx->interfaceparams[i].update = true;
+    //snap.GetDouble(FXStateTag("timepos"), timepos);
 
-    // now upate / convert values locally
-    for(unsigned int i=0; i<fx->info.paramCount; i++) fx->interfaceparams[i].update = true;
     nonUpdateOnParams();
+    // NOTE: dont force resetTriggered here (causes problems)
     Update();
-
-    phaseOffset = localState->phaseOffset;
-    timepos = localState->timepos;
-}
-*/
+    // Host is responsible for panel update in this case
+    return true;
+};
 
 
 void PluginPrivateObject::Reset() {
-    for(unsigned int i=0; i<fx->info.paramCount; i++) {
+    params.Reset(fx);
+    // hand written params after the table
+    for(unsigned int i=params.End(); i<fx->info.paramCount; i++) {
         fx->interfaceparams[i].curValue = fx->interfaceparams[i].defaultValue;
         fx->interfaceparams[i].update = true;
 
@@ -379,12 +458,12 @@ void PluginPrivateObject::RandomizeState(){
 }
 
 void PluginPrivateObject::Random(){
-    int p = 0;
-	fx->interfaceparams[p].curValue = (rand() %101);
-	fx->interfaceparams[p].update = true;
+    // every FXRandom(...) entry in paramDescs
+    params.Random(fx);
 
 	/**
-        p++;
+        hand written example
+        p = params.End();
         float r = (rand() % 101) * 0.01;
         float g = (rand() % 101) * 0.01;
         float b = (rand() % 101) * 0.01;
@@ -407,20 +486,19 @@ void PluginPrivateObject::Random(){
     otherwise set update to false (handled)
 */
 void PluginPrivateObject::Update() {
-	unsigned int p; // local GUI parameter index
-
 	// sometimes a trigger might require all values to be refresh on host
 	// so I tend to use this
 	bool forceHostUpdate = false || resetTriggered;
 
-	// range type control
-	p = 0;
-	if (fx->interfaceparams[p].update) {
-		r = (fx->interfaceparams[p].curValue * 0.01);
-		fx->interfaceparams[p].update = forceHostUpdate;
-	}
+	// everything in paramDescs, only the flagged ones are converted
+	params.Update(fx, this, forceHostUpdate);
+
+	// newest audio block into the history textures (only once audioHistory.Init has been called)
+	if (audioHistory.Rows()) audioHistory.Update(AudioAnalysis(), fx->audioData, gl);
 
 	/**
+        hand written params (not in the table) follow this pattern, starting at params.End()
+
         // toggle type control example
         p = 1;
         if (fx->interfaceparams[p].update) {
@@ -432,6 +510,13 @@ void PluginPrivateObject::Update() {
             fx->interfaceparams[p].update = forceHostUpdate;
         }
 
+        // toggle as a shader variant, Process picks up the matching program
+        p = 1;
+        if (fx->interfaceparams[p].update) {
+            variants.Set(mirrorKey, fx->interfaceparams[p].curValue);
+            fx->interfaceparams[p].update = forceHostUpdate;
+        }
+
         // multiple option example
         p = 1;
         if (fx->interfaceparams[p].update) {
@@ -449,15 +534,10 @@ void PluginPrivateObject::Update() {
         if (fx->interfaceparams[p].update) {
             state.genSpeed = fx->interfaceparams[p].curValue;
 
-            if (state.genSpeed > 8) state.genSpeed = 8;
-            fx->interfaceparams[p].displayValue = "On "+beatLabels[state.genSpeed];
+            if (state.genSpeed >= FXBEAT_DIVISIONS) state.genSpeed = FXBEAT_DIVISIONS - 1;
+            fx->interfaceparams[p].displayValue = "On "+string(FXBeatClock::Label(state.genSpeed));
             fx->interfaceparams[p].displayValueUpdate = true;
-
-            if (state.genSpeed < 4){
-                prevHit = floor(fx->hemidemisemiQuaverCount / hdsqDelays[state.genSpeed]); //beat
-            }else{
-                prevHit = fx->bar;
-            }
+            // nothing to resync, beats tracks every division all the time
         }
 
         // colour selector example
@@ -483,6 +563,11 @@ void PluginPrivateObject::Update() {
 	*/
 };
 
+// Red (range type control)
+void PluginPrivateObject::RedChanged() {
+	uniforms.Set1fv(1, 0, r);   // i[0]
+}
+
 /**
     Call in each frame if plugin is in use and enabled
 */
@@ -493,9 +578,17 @@ void PluginPrivateObject::Process() {
 		return;
 	}
 
+	// beat hits for this frame, eg if (beats.Hit(beatmode)) ...
+	// once per frame here, Update also runs from Reset/RandomizeState/SetState
+	beats.Tick(fx);
+
 	// optional
 	ProgressTime();
 
+	// write out any DumpFBO captures the GPU has finished with
+	ServiceReadback(false);
+	frameNumber++;
+
 	// first run
 	if (firstRun){
         //fx->outputBuffer.width = actual texture size
@@ -503,43 +596,45 @@ void PluginPrivateObject::Process() {
         displayWRatio = ( (float)fx->outputBuffer.width / (float)fx->displayWidth );
         displayHRatio = ( (float)fx->outputBuffer.height / (float)fx->displayHeight);
 
-        /**
-		// if using glsl 330, a quad to render
-		/*sqverts[0] = glm::vec3(0.0,0.0,0.0);
-		sqverts[1] = glm::vec3(0.0,fx->outputBuffer.height,0.0);
-		sqverts[2] = glm::vec3(fx->outputBuffer.width,0.0,0.0);
-		sqverts[3] = glm::vec3(fx->outputBuffer.width,fx->outputBuffer.height,0.0);
-
-		// if rendering to sq first
-        squvs[0] = glm::vec2(0,0);
-        squvs[1] = glm::vec2(0,1.0);
-        squvs[2] = glm::vec2(1.0,0);
-        squvs[3] = glm::vec2(1.0,1.0);
-        */
-
 		firstRun = false;
 	}
 
-	// effect started
-	if (fx->source[0].effectStartTimestamp == GetRealTimestamp()){
-        gentimer = fx->source[0].effectStartTimestamp;
-        prevbpm = fx->bpm;
-        prevHit = 0;
-        curHit = 0;
-        newHit = false;
+	// effect started (once per trigger, the timestamp is a double so never compared exactly)
+	if (clock.EffectStarted(fx)){
+        gentimer = FXTime::ToNs(fx->source[0].effectStartTimestamp);
+        clock.Reset(fx);
+        beats.Reset();
 	}
 
-	/**
-        // if using glsl 330
-        // if not relying on sq
-        squvs[0] = glm::vec2(0,0);
-        squvs[1] = glm::vec2(0,fx->source[0].ty2);
-        squvs[2] = glm::vec2(fx->source[0].tx2,0);
-        squvs[3] = glm::vec2(fx->source[0].tx2,fx->source[0].ty2);
-    */
+	// edited shader text (FXSHADER_WATCH), linked in the background while the old one keeps drawing
+	string shaderText;
+	if (shaderWatch.Poll(shaderText)) variants.Reload(shaderText);
+
+	// everything set through gl is only set once per Process,
+	// gl->End() then puts back any defaults we changed
+	gl->Begin();
+
+	// the scale from the GPU times read back so far (only if dynres.Init was called)
+	ApplyDynamicResolution();
+	// this frame's source[0] and level sizes for the blur passes (only if blur.Add was called)
+	ApplyBlur();
+
+	// each pass gets its target bound/cleared as needed, then draws
+	dynres.Begin();
+	if (!graph.Execute(fx, gl)) {
+		Debug("%s: %s\n", fx->info.canonicalName.c_str(), graph.Error().c_str());
+		fx->error = true;
+		fx->errorMessage = graph.Error();
+	}
+	dynres.End();
+
+	// what was just drawn into the frame history (feedback), push source[0] before Execute
+	// instead for an echo of the input (only once history.Init has been called)
+	if (history.Depth()) history.Push(fx->outputBuffer.TextureID, fx->outputBuffer.width, fx->outputBuffer.height, gl);
 
-	// prepare output fbo
-	Process120Example();
+	RecordFrame();
+
+	gl->End();
 };
 
 /**
@@ -547,114 +642,108 @@ void PluginPrivateObject::Process() {
 
     NOTE: if you change any global states you MUST put them back to default before exiting
     or you can make a right mess of the GUI :)
+    (state set through gl is put back for you in Process, anything else is still up to you)
 */
 void PluginPrivateObject::Process120Example(){
-    // select the output buffer
-	glBindFramebuffer(GL_FRAMEBUFFER_EXT, fx->outputBuffer.FBOID);
-
-    // setup viewport
-	glViewport(0, 0, fx->outputBuffer.width, fx->outputBuffer.height);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0.0f, (GLfloat)fx->outputBuffer.width,0.0f,(GLfloat)fx->outputBuffer.height,-1.0f,1.0f);
+    FX_PROFILE_SCOPE("Process120Example");
 
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_SCISSOR_TEST);
-
-	glClearColor(0.0f,0.0f,0.0f,0.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // the graph has already selected the output buffer (or the smaller dynres one) and set up
+    // viewport/ortho/modelview to its size (no clear, the quad covers it all)
 
 	// use the default source texture comming in
-	glActiveTexture(GL_TEXTURE0);
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D,fx->source[0].id);
-
-    /*if (mirror){
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_MIRRORED_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_MIRRORED_REPEAT);
-    }*/
-
-	// use our shader
-    unsigned int id = 1;
-	glUseProgram(fx->shaders[id].id);
-
-	glUniform1i(fx->shaders[id].params[0].id, 0);		//tex
-
-	int pcount = 1;
-	float i[pcount];
-	i[0]=r;
+	gl->ActiveTexture(GL_TEXTURE0);
+	gl->Enable(GL_TEXTURE_2D);
+	gl->BindTexture2D(fx->source[0].id);
+
+    // GL_MIRRORED_REPEAT on the source would also mirror the unused part past tx2/ty2,
+    // use texCoords.SetWrap(FXWRAP_MIRROR) and fxTexture() in the shader instead (see CreateShaders)
+
+	// use our shader (or the variant for the current keys, see CreateShaders)
+    FXSHADER* shader = variants.Select();
+    if (variants.Stats().failed != shaderFailures) {
+        shaderFailures = variants.Stats().failed;
+        Debug("%s: shader variant failed %s\n", fx->info.canonicalName.c_str(), variants.Error().c_str());
+    }
+    if (!shader) shader = &fx->shaders[1];
+    if (!shader->id) {
+        // nothing linked to draw with yet, pass the source through rather than wait on a compile
+        gl->UseProgram(0);
+        glColor4f(1.0f,1.0f,1.0f,1.0f);
+        DrawQuad(0,0,0,0,graph.TargetWidth(),graph.TargetHeight(),fx->source[0].tx2,fx->source[0].ty2,1.0);
+        return;
+    }
+    uniforms.Attach(shader);
+	gl->UseProgram(shader->id);
 
     /**
-        example of using more parameters
-        i[0] = localtime.tm_sec;
-        i[1] = localtime.tm_nsec;
-        i[2]=fx->outputBuffer.width;
-        i[3]=fx->outputBuffer.height;
-        i[4]=fx->source[0].tx2;
-        i[5]=fx->source[0].ty2;
+        example of using more parameters, values that can change every frame
+        are just set here, only the ones that actually changed get uploaded
+        uniforms.Set1fv(1, 1, fx->outputBuffer.width);
+        uniforms.Set1fv(1, 2, fx->outputBuffer.height);
+        uniforms.Set1fv(1, 3, fx->source[0].tx2);
+        uniforms.Set1fv(1, 4, fx->source[0].ty2);
 	*/
 
-	glUniform1fv(fx->shaders[id].params[1].id, pcount, i);
+	// audio history textures/ring position, if CreateAudioHistoryParams was used
+	ApplyAudioHistory();
+	// fxUV for this source/output, if CreateTexCoordParams was used (the quad then wants 1.0,1.0 texcoords)
+	ApplyTexCoords();
+	// the mixer's layers on units 0-9 and fxMix, if CreateMixerParams was used (1.0,1.0 texcoords too)
+	ApplyMixer();
+	// frame history ring on its unit, if CreateFrameHistoryParams was used
+	ApplyFrameHistory();
+	// noise tile on its unit, if CreateNoiseParams was used
+	ApplyNoise();
 
-	DrawQuad(0,0,0,0,fx->outputBuffer.width,fx->outputBuffer.height,fx->source[0].tx2,fx->source[0].ty2,1.0);
+	// tex0 and i[] (only what changed since the last frame)
+	uniforms.Apply();
 
-	// put it back!
-    /*if (mirror){
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
-    }*/
+	if (texCoordsParam >= 0 || mixerParam >= 0) DrawQuad(0,0,0,0,graph.TargetWidth(),graph.TargetHeight(),1.0,1.0,1.0);
+	else DrawQuad(0,0,0,0,graph.TargetWidth(),graph.TargetHeight(),fx->source[0].tx2,fx->source[0].ty2,1.0);
 
-	// stop using our shader
-	glUseProgram(0);
+	// our shader is unbound by gl->End() once Process is done
+}
+
+/**
+    dynamic resolution, graphScaled (bottom left of whichever host buffer it got) stretched over
+    the output with the bicubic shader, linear until that has linked
+*/
+void PluginPrivateObject::ProcessUpscale(FXRenderGraph& g){
+    FX_PROFILE_SCOPE("ProcessUpscale");
+
+	gl->ActiveTexture(GL_TEXTURE0);
+	gl->Enable(GL_TEXTURE_2D);
+	gl->BindTexture2D(g.Input(graphScaled));
+	float tx = g.InputTX(graphScaled);
+	float ty = g.InputTY(graphScaled);
+
+	FXSHADER* shader = upscaleShader >= 0 ? &fx->shaders[upscaleShader] : 0;
+	if (shader && shader->id) {
+		gl->UseProgram(shader->id);
+		// the size of the buffer it's in, tx/ty of it is the image
+		float v[4] = {dynres.Width(fx->outputBuffer.width) / tx, dynres.Height(fx->outputBuffer.height) / ty, tx, ty};
+		glUniform1i(shader->params[0].id, 0);
+		glUniform1fv(shader->params[1].id, 4, v);
+	}else{
+		gl->UseProgram(0);
+		glColor4f(1.0f,1.0f,1.0f,1.0f);
+	}
+	DrawQuad(0,0,0,0,g.TargetWidth(),g.TargetHeight(),tx,ty,1.0);
 }
 
 /**
     Example of using a more modern approach
-    this also has an example of using one of the extra buffers for converting to a square texture
+    (the shader used to need a square texture, FXTEXCOORDS_GLSL maps 0-1 texcoords onto the source instead)
 
     requires glm headers, not supplied : https://github.com/g-truc/glm
 */
 /*
 void PluginPrivateObject::Process330Example(){
 
-    // example shader requires square texture
-	// if plugin is supplied with a non-square texture, then we need to first
-	// create a square one (could prob get around this but out of time for mo)
-	GLuint sourceTextureID = fx->source[0].id;
-
-	/*if (fx->source[0].tx2 != 1.0f
-			|| fx->source[0].ty2 != 1.0f) {
-
-		glBindFramebuffer(GL_FRAMEBUFFER_EXT, fx->bufferA.FBOID);
-
-		glViewport(0, 0, fx->bufferA.width, fx->bufferA.height);
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		glOrtho(0.0f, (GLfloat)fx->bufferA.width,0.0f,(GLfloat)fx->bufferA.height,-1.0f,1.0f);
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-
-		glDisable(GL_DEPTH_TEST);
-		glDisable(GL_SCISSOR_TEST);
-		glEnable(GL_TEXTURE_2D);
-
-		glClearColor(0.0f,0.0f,0.0f,0.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		glColor4f(1.0f,1.0f,1.0f,1.0f);
-
-		glEnable(GL_TEXTURE_2D);
-		glBindTexture(GL_TEXTURE_2D,sourceTextureID);
-
-		DrawQuad(0,0,0,0,fx->bufferA.width,fx->bufferA.height,fx->source[0].tx2,fx->source[0].ty2,1.0);
-
-		glBindFramebuffer(GL_FRAMEBUFFER_EXT,0);
-		sourceTextureID = fx->bufferA.TextureID;
-	}*//*
+    // the example shader wants 0-1 texcoords over the whole image (and its own wrap), this used to
+	// copy the source into bufferA to square it first, a full screen read and write every frame.
+	// FXTEXCOORDS_GLSL in the frag text (sampling with fxTexture) and CreateTexCoordParams(pid) does
+	// it as a uv remap instead, the source is sampled directly (fxbench -uvcheck compares the two)
 
     glBindFramebuffer(GL_FRAMEBUFFER_EXT, fx->outputBuffer.FBOID);
 	glViewport(0, 0, fx->outputBuffer.width, fx->outputBuffer.height);
@@ -666,7 +755,7 @@ void PluginPrivateObject::Process330Example(){
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D,fx->source[0].id);// or sourceTextureID if squaring
+	glBindTexture(GL_TEXTURE_2D,fx->source[0].id);
 
     unsigned int pid = 1;
     glUseProgram(fx->shaders[pid].id);
@@ -680,59 +769,28 @@ void PluginPrivateObject::Process330Example(){
 
 	glm::mat4 myModelMatrix = myTransform1 * myRotationMatrix;*//*
 
-    // init projection matrix (glm::mat4) (could be done first time only)
-    float ow = (GLfloat)fx->outputBuffer.width;
-    float oh = (GLfloat)fx->outputBuffer.height;
-    glm::mat4 projection = glm::ortho(0.0f, ow,0.0f,oh,0.0f,100.0f);
-
-	// no camara or model matrix in this case (else could be ! projection * view * model !)
-	glm::mat4 mvp = projection;// * myModelMatrix;
-
-
-	// Send our transformation to the currently bound shader, in the "MVP" uniform
-	// This is done in the main loop since each model will have a different MVP matrix (At least for the M part)
-	glUniformMatrix4fv(fx->shaders[pid].params[0].id, 1, GL_FALSE, &mvp[0][0]);
-    glUniform1i(fx->shaders[pid].params[1].id, 0);	// texture
+    // no projection matrix needed, the quad vert shader (FXQUAD_VERT330) maps pixels to clip space
+    // params 0-2 are fxQuadPos/fxQuadUV/fxQuadSize (see CreateShaders)
+    glUniform1i(fx->shaders[pid].params[3].id, 0);	// texture
 
 	// my frag params
     float coffset = 0.0;
-	float s = GetRealTimestamp() / 1e9;     // convert from ns to sec
+	float s = clock.MediaNs() / 1e9;     // convert from ns to sec (since the effect started, a float can't hold epoch time)
 	float t = roundf((s + coffset) * 100.0) / 100.0;    // round to 2 dp
 
 	unsigned int pcount = 1;
 	float i[pcount];
 	i[0]= cellwidth;
-	glUniform1fv(fx->shaders[pid].params[2].id, pcount   , i);
-
-
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, sqvertsVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(sqverts), sqverts, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(
-		0, 						// attribute (must match layout in shader)
-		3, 						// size
-		GL_FLOAT, 				// type
-		GL_FALSE, 				// normalized?
-		0, 						// stride
-		0						// array buffer offset
-	);
-
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, squvsVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(squvs), squvs, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(
-		1,                                // attribute. No particular reason for 1, but must match the layout in the shader.
-		2,                                // size
-		GL_FLOAT,                         // type
-		GL_FALSE,                         // normalized?
-		0,                                // stride
-		(void*)0                          // array buffer offset
-	);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);	// a quad
-
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(0);
+	glUniform1fv(fx->shaders[pid].params[4].id, pcount   , i);
+
+	// source size/tx2/ty2, wrap and aspect for fxTexture
+	texCoords.Update(fx->source[0], fx->outputBuffer.width, fx->outputBuffer.height);
+	glUniform1fv(fx->shaders[pid].params[texCoordsParam].id, FXTEXCOORDS_FLOATS, texCoords.Values());
+
+	// a quad, corners from gl_VertexID, 0-1 texcoords (fxTexture maps them onto the source)
+	quad->DrawGenerated(fx->shaders[pid].params[0].id, fx->shaders[pid].params[1].id, fx->shaders[pid].params[2].id,
+		fx->outputBuffer.width, fx->outputBuffer.height,
+		0, 0, 0, 0, fx->outputBuffer.width, fx->outputBuffer.height, 1.0f, 1.0f);
 
 	glUseProgram(0);
 	glBindFramebuffer(GL_FRAMEBUFFER_EXT, 0);
@@ -743,36 +801,22 @@ void PluginPrivateObject::Process330Example(){
     HELPER FUNCTIONS
 */
 
+// used by the benchmark host, this waits on the GPU so never call it during a show
+int PluginPrivateObject::ProfileStages(FXPROFILESAMPLE* samples, int maxSamples){
+    return profiler.Collect(samples, maxSamples);
+}
+
 //example of tracking time passed
 void PluginPrivateObject::ProgressTime(){
-	double curTime = GetRealTimestamp();
-
-	localElapsedTime = curTime - localPrevTime;
+	// host time through globalSpeed/globalReverse in integer ns, frames at the clip rate (25fps default)
+	// anything that has to land on an exact frame should use clock.Frame() rather than add these up
+	clock.Tick(fx);
+	framesTraveled = clock.FramesTravelledExact();
 
-	// default speed of clip is FPns Frames per nano secs
-	double thisFramesTravelled = (localElapsedTime / FPns);
-	framesTraveled = thisFramesTravelled * fx->globalSpeed;
-
-	localElapsedTime -= (FPns * thisFramesTravelled);
-
-    localPrevTime = curTime - localElapsedTime;
-
-    /*newHit = false;
-    //double eightbarmeter = floor((float)fx->bar / 8.0);
-    //hemidemisemiQuaverCount = 64th of a beat (4 beats to a bar = 64*4=256)
-    //barsTravelled = floor(beats.hemidemisemiQuaverCount / 256.0);
-    // hemidemisemiquaver = 64th of a note
-    //int semiquaver = floor(fx->hemidemisemiQuaverCount / 16.0); // quaver = 0 to 15 (every 16th note)
-    // crotchet = semiquaver % 4;
-    //curHit = (semiquaver >> 2);   //4/4
-
-    int hsqc = fx->hemidemisemiQuaverCount;
-    if (beatmode >= 4) hsqc += (fx->bar * 256);
-    int curHit = floor(hsqc / hdsqDelays[beatmode]); // on beat
-    if (curHit != prevHit){
-        prevHit = curHit;
-        newHit = true;
-    }
+    /*
+    // beats was ticked just before, Hit is only true on the frame the division started
+    // (Phase/TimeToNext for anything that eases into the next hit)
+    if (beats.Hit(beatmode)) cycleOffset = 0;
 
     if (r){
         cycleOffset -= framesTraveled * cycleSpeed;
@@ -785,12 +829,28 @@ void PluginPrivateObject::ProgressTime(){
 };
 
 
-double PluginPrivateObject::GetRealTimestamp(){
-    return (fx->curTime.tv_sec * 1E9)+fx->curTime.tv_nsec;
+int64_t PluginPrivateObject::GetRealTimestamp(){
+    return FXTime::ToNs(fx->curTime);
 }
 
 // GL_QUADS is deprecated
+// these draw out of the shared quad vbo (see fxquad.h), falling back to immediate mode
 void PluginPrivateObject::DrawQuad(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z){
+    if (quad && quad->Available()) quad->Draw(x1,y1,tx1,ty1,x2,y2,tx2,ty2,z);
+    else DrawQuadImmediate(x1,y1,tx1,ty1,x2,y2,tx2,ty2,z);
+}
+
+void PluginPrivateObject::DrawQuad(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2){
+    if (quad && quad->Available()) quad->Draw(x1,y1,tx1,ty1,x2,y2,tx2,ty2,0.0f);
+    else DrawQuadImmediate(x1,y1,tx1,ty1,x2,y2,tx2,ty2);
+}
+
+void PluginPrivateObject::DrawQuad2(float x1, float y1, float tx1, float ty1,float ttx1,float tty1, float x2, float y2, float tx2,float ty2,float ttx2,float tty2){
+    if (quad && quad->Available()) quad->Draw2(x1,y1,tx1,ty1,ttx1,tty1,x2,y2,tx2,ty2,ttx2,tty2);
+    else DrawQuad2Immediate(x1,y1,tx1,ty1,ttx1,tty1,x2,y2,tx2,ty2,ttx2,tty2);
+}
+
+void PluginPrivateObject::DrawQuadImmediate(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z){
 		glBegin(GL_TRIANGLES);
 		glTexCoord2f(tx1,ty1);
 		glVertex3f(x1, y1, z);
@@ -808,7 +868,7 @@ void PluginPrivateObject::DrawQuad(float x1, float y1, float tx1, float ty1, flo
 		glEnd();
 }
 
-void PluginPrivateObject::DrawQuad(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2){
+void PluginPrivateObject::DrawQuadImmediate(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2){
 		glBegin(GL_TRIANGLES);
 		glTexCoord2f(tx1,ty1);
 		glVertex2f(x1, y1);
@@ -826,7 +886,7 @@ void PluginPrivateObject::DrawQuad(float x1, float y1, float tx1, float ty1, flo
 		glEnd();
 }
 
-void PluginPrivateObject::DrawQuad2(float x1, float y1, float tx1, float ty1,float ttx1,float tty1, float x2, float y2, float tx2,float ty2,float ttx2,float tty2){
+void PluginPrivateObject::DrawQuad2Immediate(float x1, float y1, float tx1, float ty1,float ttx1,float tty1, float x2, float y2, float tx2,float ty2,float ttx2,float tty2){
 		glBegin(GL_TRIANGLES);
         glMultiTexCoord2f(GL_TEXTURE0,tx1,ty1);
         glMultiTexCoord2f(GL_TEXTURE1,ttx1,tty1);
@@ -872,18 +932,299 @@ void PluginPrivateObject::Debug(const char* format, ... ) {
 
 	fflush(stdout);
 }
-void PluginPrivateObject::DumpFBO(string filename,unsigned int w,unsigned int h,GLuint FBOID){
-	// debug (dump fbo texture)
-	unsigned int buffersize = w*h*4;
-	unsigned char *memblock=(unsigned char *)malloc(buffersize);
-	glBindFramebuffer(GL_FRAMEBUFFER, FBOID);
+/**
+    audio levels/spectrum/onsets for FXPT_AUDIO plugins, eg in Update
+        const FXAUDIOANALYSIS& a = AudioAnalysis();
+        if (a.onset) ...
+    call it as often as you like, it's only worked out once per audio update for all instances
+*/
+const FXAUDIOANALYSIS& PluginPrivateObject::AudioAnalysis() {
+    return audio->Analyse(fx->audioData);
+}
+/**
+    the 3 params FXAUDIOHISTORY_GLSL declares, must be the shader uniforms is attached to
+*/
+void PluginPrivateObject::CreateAudioHistoryParams(int shaderID) {
+    audioHistoryParam = fx->shaders[shaderID].paramCount;
+    CreateShaderParam(shaderID,0,"fxAudioSpectrum",0.0f);
+    CreateShaderParam(shaderID,0,"fxAudioWaveform",0.0f);
+    CreateShaderParam(shaderID,1,"fxAudioHistory",0.0f);
+}
+/**
+    binds the history textures and sets the ring position, call before uniforms.Apply()
+*/
+void PluginPrivateObject::ApplyAudioHistory() {
+    if (audioHistoryParam < 0 || !audioHistory.SpectrumTexture()) return;
+    gl->ActiveTexture(GL_TEXTURE0 + FXAUDIOHISTORY_SPECTRUM_UNIT);
+    gl->BindTexture2D(audioHistory.SpectrumTexture());
+    gl->ActiveTexture(GL_TEXTURE0 + FXAUDIOHISTORY_WAVEFORM_UNIT);
+    gl->BindTexture2D(audioHistory.WaveformTexture());
+    gl->ActiveTexture(GL_TEXTURE0);
+
+    float ring[2] = {audioHistory.Head(), audioHistory.Span()};
+    uniforms.Set1i(audioHistoryParam, FXAUDIOHISTORY_SPECTRUM_UNIT);
+    uniforms.Set1i(audioHistoryParam + 1, FXAUDIOHISTORY_WAVEFORM_UNIT);
+    uniforms.Set1fv(audioHistoryParam + 2, 2, ring);
+}
+/**
+    the fxUV param FXTEXCOORDS_GLSL declares, must be the shader uniforms is attached to
+*/
+void PluginPrivateObject::CreateTexCoordParams(int shaderID) {
+    texCoordsParam = fx->shaders[shaderID].paramCount;
+    CreateShaderParam(shaderID,1,"fxUV",0.0f);
+}
+/**
+    fxUV for source[0] drawn over the output, call before uniforms.Apply() (only uploaded when it changes)
+*/
+void PluginPrivateObject::ApplyTexCoords() {
+    if (texCoordsParam < 0) return;
+    texCoords.Update(fx->source[0], fx->outputBuffer.width, fx->outputBuffer.height);
+    uniforms.Set1fv(texCoordsParam, FXTEXCOORDS_FLOATS, texCoords.Values());
+}
+/**
+    the layer samplers, fxMix and fxMixCount FXLayerMixer::ShaderText declares
+*/
+void PluginPrivateObject::CreateMixerParams(int shaderID) {
+    mixerParam = fx->shaders[shaderID].paramCount;
+    for (int k = 0; k < FXMIXER_MAXLAYERS; k++) CreateShaderParam(shaderID,0,"fxLayer" + IntToString(k),0.0f);
+    CreateShaderParam(shaderID,1,"fxMix",0.0f);
+    CreateShaderParam(shaderID,1,"fxMixCount",0.0f);
+}
+/**
+    packs the layers the host supplied this frame and binds them, call before uniforms.Apply()
+*/
+void PluginPrivateObject::ApplyMixer() {
+    if (mixerParam < 0) return;
+    int n = mixer.Gather(fx->source);
+    mixer.Bind(gl);
+    for (int k = 0; k < FXMIXER_MAXLAYERS; k++) uniforms.Set1i(mixerParam + k, k);
+    uniforms.Set1fv(mixerParam + FXMIXER_MAXLAYERS, FXMIXER_FLOATS, mixer.Values());
+    uniforms.Set1f(mixerParam + FXMIXER_MAXLAYERS + 1, (float)n);
+}
+/**
+    the sampler and fxHistory param history.GLSL() declares
+*/
+void PluginPrivateObject::CreateFrameHistoryParams(int shaderID) {
+    historyParam = fx->shaders[shaderID].paramCount;
+    CreateShaderParam(shaderID,0,"fxHistoryTex",0.0f);
+    CreateShaderParam(shaderID,1,"fxHistory",0.0f);
+}
+/**
+    binds the history and sets the ring position, call before uniforms.Apply()
+*/
+void PluginPrivateObject::ApplyFrameHistory() {
+    if (historyParam < 0) return;
+    // set even before the first Push, a sampler2DArray left on unit 0 with the 2D samplers fails the draw
+    history.Bind(FXFRAMEHISTORY_UNIT, gl);
+    uniforms.Set1i(historyParam, FXFRAMEHISTORY_UNIT);
+    uniforms.Set1fv(historyParam + 1, FXFRAMEHISTORY_FLOATS, history.Values());
+}
+/**
+    the frag and program for ProcessUpscale, after the other shaders
+*/
+void PluginPrivateObject::CreateUpscaleShader() {
+    unsigned int id = fx->info.shaderCount;
+	fx->shaders[id].t = 1;
+	fx->shaders[id].text = FXDYNRES_UPSCALE_GLSL;
+	fx->shaders[id].vertShaderName = "";
+	fx->shaders[id].fragShaderName = "000-VIDIFOLD-DYNRES-UpscaleFrag";
+	fx->shaders[id].programShaderName = "";
+	fx->shaders[id].paramCount = 0;
+	fx->shaders[id].error = false;
+	fx->shaders[id].id = 0;
+	fx->info.shaderCount++;
+
+    id++;
+	fx->shaders[id].t = 2;
+	fx->shaders[id].text = "";
+	fx->shaders[id].vertShaderName = "000-1TextureVert";
+	fx->shaders[id].fragShaderName = "000-VIDIFOLD-DYNRES-UpscaleFrag";
+	fx->shaders[id].programShaderName = "000-VIDIFOLD-DYNRES-Upscale";
+	fx->shaders[id].paramCount = 0;
+	CreateShaderParam(id,0,"fxUpscaleTex",0.0f);
+	CreateShaderParam(id,1,"fxUpscale",0.0f);
+	fx->shaders[id].error = false;
+	fx->shaders[id].id = 0;
+	fx->info.shaderCount++;
+	upscaleShader = id;
+}
+/**
+    moves the example between the output and graphScaled as the scale changes,
+    graphScaled follows the output size (only recompiles the graph when something changed)
+*/
+void PluginPrivateObject::ApplyDynamicResolution() {
+    if (!dynres.Enabled() || graphScaled < 0) return;
+    if (dynres.Update()) {
+        bool scaled = dynres.Scale() < 1.0f;
+        graph.Write(examplePass, scaled ? graphScaled : graphOutput, FXWRITE_FULL);
+        graph.Enable(upscalePass, scaled);
+        FXDYNRESSTATS s = dynres.Stats();
+        Debug("%s: resolution scale %.3f (%.2fms average, %.2fms budget)\n", fx->info.canonicalName.c_str(), s.scale, s.averageMs, s.budgetMs);
+    }
+    graph.Resize(graphScaled, dynres.Width(fx->outputBuffer.width), dynres.Height(fx->outputBuffer.height));
+}
+
+/**
+    the frag and program of each blur kernel, after the other shaders
+*/
+void PluginPrivateObject::CreateBlurShaders() {
+    for (int k = 0; k < FXBLURKERNEL_COUNT; k++) {
+        unsigned int id = fx->info.shaderCount;
+        string name = FXBlur::KernelName((FXBLURKERNEL)k);
+		fx->shaders[id].t = 1;
+		fx->shaders[id].text = FXBlur::KernelText((FXBLURKERNEL)k);
+		fx->shaders[id].vertShaderName = "";
+		fx->shaders[id].fragShaderName = name + "Frag";
+		fx->shaders[id].programShaderName = "";
+		fx->shaders[id].paramCount = 0;
+		fx->shaders[id].error = false;
+		fx->shaders[id].id = 0;
+		fx->info.shaderCount++;
+
+        id++;
+		fx->shaders[id].t = 2;
+		fx->shaders[id].text = "";
+		fx->shaders[id].vertShaderName = "000-1TextureVert";
+		fx->shaders[id].fragShaderName = name + "Frag";
+		fx->shaders[id].programShaderName = name;
+		fx->shaders[id].paramCount = 0;
+		CreateShaderParam(id,0,"fxBlurTex",0.0f);
+		if (k == FXBLURKERNEL_SEPARABLE) {
+			CreateShaderParam(id,1,"fxBlurTap",0.0f);
+			CreateShaderParam(id,1,"fxBlur",0.0f);
+		}else{
+			CreateShaderParam(id,1,"fxKawase",0.0f);
+		}
+		fx->shaders[id].error = false;
+		fx->shaders[id].id = 0;
+		fx->info.shaderCount++;
+		blur.SetShader((FXBLURKERNEL)k, &fx->shaders[id]);
+    }
+}
+/**
+    the blur's input size (and texture, if it's source[0]) for this frame
+*/
+void PluginPrivateObject::ApplyBlur() {
+    if (!blur.Added()) return;
+    int w = fx->outputBuffer.width, h = fx->outputBuffer.height;
+    if (blurSource >= 0) {
+        // w/h are the whole texture, the image is tx2/ty2 of it (0 for a source plugin, output sized)
+        const FXSOURCE& s = fx->source[0];
+        if (s.w && s.h) {
+            w = (int)(s.w * s.tx2 + 0.5f);
+            h = (int)(s.h * s.ty2 + 0.5f);
+        }
+        graph.SetSource(blurSource, s.id, w, h, s.tx2 > 0 ? s.tx2 : 1.0f, s.ty2 > 0 ? s.ty2 : 1.0f);
+    }
+    blur.Update(graph, w, h, frameNumber);
+}
+
+/**
+    the sampler and fxNoise param FXNOISE_GLSL declares
+*/
+void PluginPrivateObject::CreateNoiseParams(int shaderID) {
+    noiseParam = fx->shaders[shaderID].paramCount;
+    CreateShaderParam(shaderID,0,"fxNoiseTex",0.0f);
+    CreateShaderParam(shaderID,1,"fxNoise",0.0f);
+}
+/**
+    binds the tile (nothing until the worker is done) and sets its size/frame, call before uniforms.Apply()
+*/
+void PluginPrivateObject::ApplyNoise() {
+    if (noiseParam < 0) return;
+    // uploads on the first call once it's ready
+    GLuint t = noise->Texture(noiseHandle, gl);
+    gl->ActiveTexture(GL_TEXTURE0 + FXNOISE_UNIT);
+    gl->BindTexture2D(t);
+    gl->ActiveTexture(GL_TEXTURE0);
+
+    FXNOISEPARAMS p = noise->Get(noiseHandle);
+    float n[3] = {(float)max(p.size, 1), (float)max(p.frames, 1), (float)(frameNumber % max(p.frames, 1))};
+    uniforms.Set1i(noiseParam, FXNOISE_UNIT);
+    uniforms.Set1fv(noiseParam + 1, 3, n);
+}
+
+bool PluginPrivateObject::DynamicResolution(FXDYNRESSTATS* stats) {
+    if (!dynres.Enabled()) return false;
+    *stats = dynres.Stats();
+    return true;
+}
+/**
+    debug (dump fbo texture)
+    this no longer stalls, the read is queued and once the GPU is done (usually 2 frames later)
+    ServiceReadback copies it to images, the file is written on the worker threads
+    FXIMAGE_FXQ files are ~4-10x smaller (see fxcodec.h)
+*/
+void PluginPrivateObject::DumpFBO(string filename,unsigned int w,unsigned int h,GLuint FBOID,FXIMAGEFORMAT format){
+	gl->Begin();
+	gl->BindFramebuffer(FBOID);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	int64_t ns = FXTime::ToNs(fx->curTime);
+	if (!readback.Request(w, h, filename, frameNumber, ns, format)) {
+		Debug("DumpFBO dropped %s (%ld dropped so far)\n", filename.c_str(), readback.Dropped());
+	}
+	gl->End();
+}
+void PluginPrivateObject::ServiceReadback(bool wait){
+	const FXREADBACKFRAME* frame;
+	while ((frame = readback.Acquire(wait))) {
+		if (frame->name.empty()) {
+			// recorded frame, copied to the recorder queue and written by its thread
+			recorder.Submit(frame->pixels, frame->width, frame->height, frame->frame, frame->timestampNs);
+		}else if (!images.Submit(frame->name, frame->pixels, frame->width, frame->height, (FXIMAGEFORMAT)frame->tag)) {
+			// still writing the last few, never done here instead
+			Debug("DumpFBO dropped %s (%ld dropped so far)\n", frame->name.c_str(), images.Stats().dropped);
+		}
+		readback.ReleaseFrame();
+	}
+	// the workers only count failed writes, they're reported from here
+	long failed = images.Stats().writeErrors;
+	if (failed != imageFailures) {
+		imageFailures = failed;
+		Debug("Failed to write image %s (%ld failed so far)\n", images.LastError().c_str(), failed);
+	}
+}
+/**
+    records the output when FXRECORD_DIR is set (FXRECORD_FRAMES sizes the file, default 3600)
+    one .vfr file per instance, see fxrecorder.h for the format
+    frames are compressed (FXIMAGE_FXQ) unless FXRECORD_CODEC=raw
+*/
+void PluginPrivateObject::RecordFrame(){
+	if (frameNumber == 1) {
+		const char* dir = getenv("FXRECORD_DIR");
+		if (dir) {
+			const char* frames = getenv("FXRECORD_FRAMES");
+			const char* codec = getenv("FXRECORD_CODEC");
+			FXIMAGEFORMAT format = (codec && !strcmp(codec, "raw")) ? FXIMAGE_RAW : FXIMAGE_FXQ;
+			char name[64];
+			sprintf(name, "-%ld-%p.vfr", (long)fx->curTime.tv_sec, (void*)this);
+			string filename = string(dir) + "/" + fx->info.canonicalName + name;
+			if (!recorder.Start(filename, fx->outputBuffer.width, fx->outputBuffer.height, frames ? atoi(frames) : 3600,
+			                    FXRECORD_DROP, format)) {
+				Debug("could not start recording to %s\n", filename.c_str());
+			}
+		}
+	}
+	if (!recorder.Recording()) return;
+
+	gl->BindFramebuffer(fx->outputBuffer.FBOID);
 	glReadBuffer(GL_COLOR_ATTACHMENT0);
-	glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)memblock);	// automaticaly drops alpha if not requested (seems to work)
-    SaveRawImage(filename,memblock,w,h,4);
-    free(memblock);
+	int64_t ns = FXTime::ToNs(fx->curTime);
+	if (!readback.Request(fx->outputBuffer.width, fx->outputBuffer.height, "", frameNumber, ns)) {
+		// ring full, shows up in the recorder's dropped count
+		recorder.Drop();
+	}
 }
-bool PluginPrivateObject::SaveRawImage(string filename,unsigned char *buffer, int width, int height,int bytes) {
+bool PluginPrivateObject::SaveRawImage(string filename,unsigned char *buffer, int width, int height,int bytes,FXIMAGEFORMAT format) {
     //jbdlog(DEBUGSYS_DEFAULT,"Saving RAW Buffer %s %dx%dx%d\n",filename.c_str(),width,height,bytes);
+    if (format == FXIMAGE_FXQ && bytes == 4) {
+        // stripes are compressed in parallel on the worker threads
+        if (!FXCodec::SaveImage(filename, buffer, width, height, workers)) {
+            Debug("Failed to write compressed image %s\n",filename.c_str());
+            return false;
+        }
+        return true;
+    }
     FILE *pFile;
     unsigned int buffersize = width * height * bytes;
     pFile=fopen(filename.c_str(), "wb");
@@ -895,25 +1236,16 @@ bool PluginPrivateObject::SaveRawImage(string filename,unsigned char *buffer, in
     fclose(pFile);
     return true;
 }
+// inside Process the fbo stays bound (and set up) for whatever draws next,
+// gl->End() unbinds it (straight away if called outside of Process)
 void PluginPrivateObject::ClearFBO(GLuint FBOID, int width, int height){
-	glBindFramebuffer(GL_FRAMEBUFFER_EXT, FBOID);
+	gl->Begin();
+	gl->SetupTarget(FBOID, width, height);
 
-    // setup viewport
-	glViewport(0, 0, width,height);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0.0f, (GLfloat)width,0.0f,(GLfloat)height,-1.0f,1.0f);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_SCISSOR_TEST);
-
-	glClearColor(0.0f,0.0f,0.0f,0.0f);
+	gl->ClearColor(0.0f,0.0f,0.0f,0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glBindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+	gl->End();
 }
 void PluginPrivateObject::Param2RGBA(int p, float &r, float &g, float &b, float &a){
     unsigned long rgba = fx->interfaceparams[p].curValue;
@@ -954,9 +1286,6 @@ unsigned long PluginPrivateObject::RGBA2Int(float r,float g, float b, float a){
 }
 
 float PluginPrivateObject::BenderCalc(int deltaValue){
-    float d = abs(deltaValue);
-    float dist = pow(d*0.1,3.) * 0.0001;
-    if (deltaValue < 0) dist = -dist;
-    //Debug("d%i = %f \n",d, dist);
-    return dist;
+    // shared with the param table benders (see fxparams.h)
+    return FXBenderCalc(deltaValue);
 }
@@ -27,9 +27,35 @@
 //#include <glm/glm.hpp>  //NOT included in this simple example plugin (https://github.com/g-truc/glm)
 
 #include "fxpluginstructures.h"
+#include "fxprofile.h"
+#include "fxquad.h"
+#include "fxglstate.h"
+#include "fxuniforms.h"
+#include "fxreadback.h"
+#include "fxrecorder.h"
+#include "fximagewriter.h"
+#include "fxcodec.h"
+#include "fxworkers.h"
+#include "fxparams.h"
+#include "fxstate.h"
+#include "fxaudio.h"
+#include "fxaudiohistory.h"
+#include "fxbeatclock.h"
+#include "fxtime.h"
+#include "fxshadervariants.h"
+#include "fxrendergraph.h"
+#include "fxtexcoords.h"
+#include "fxmixer.h"
+#include "fxframehistory.h"
+#include "fxdynres.h"
+#include "fxblur.h"
+#include "fxnoise.h"
+
+#define PLUGIN_STATE_VERSION 3  // tagged fields (fxstate.h), 1 and 2 are migrated
 
 
 // a basic state setup struct
+// (version 1, now only read to migrate old snapshots, see MigrateState1)
 struct PluginPrivateState{
     int r;
 };
@@ -57,62 +83,127 @@ class PluginPrivateObject
 		void GetState();
 		bool SetState(FXSTATE* fxstate);
         void RandomizeState();
+
+        // optional (only exported when built with -DFX_PROFILE)
+        int ProfileStages(FXPROFILESAMPLE* samples, int maxSamples);
+        // optional, false while dynamic resolution is off
+        bool DynamicResolution(FXDYNRESSTATS* stats);
 	protected:
 	private:
         bool resetTriggered;
         PluginPrivateState state;
-
-        // example structs for more modern shader setup
-        // not used in first example
-        /*glm::vec3 sqverts[4];
-        glm::vec2 squvs[4];
-        GLuint sqvertsVBO;
-        GLuint squvsVBO;*/
-
-        double FPns;
-        double localPrevTime;
-        double localElapsedTime;
-        double framesTraveled;
-        double gentimer;
+        FXProfiler profiler;
+        FXQuad* quad;           // shared cached quad (see fxquad.h)
+        FXGLState* gl;          // redundant state filter, use for binds/viewport/matrices/enables (see fxglstate.h)
+        FXRenderGraph graph;    // the passes Process runs and the host buffers they draw into (see fxrendergraph.h)
+        int graphOutput;
+        int graphScaled;        // the example drawn at the dynres scale, upscaled into graphOutput
+        int examplePass, upscalePass;
+        FXUniforms uniforms;    // cached params of shaders[1], only changed values are uploaded (see fxuniforms.h)
+        FXShaderVariants variants;  // #define specialised copies of shaders[1], off until a key is added (see fxshadervariants.h)
+        //int mirrorKey;
+        FXFileWatch shaderWatch;    // FXSHADER_WATCH frag text, rebuilt into variants in the background (see fxshadercompiler.h)
+        long shaderFailures;        // variant builds reported so far
+        FXAsyncReadback readback;   // DumpFBO captures, picked up a couple of frames later (see fxreadback.h)
+        FXImageWriter images;       // DumpFBO captures once read back, written on the workers (see fximagewriter.h)
+        long imageFailures;         // image write errors reported so far
+        long frameNumber;           // Process calls so far
+        FXFrameRecorder recorder;   // output recording, started when FXRECORD_DIR is set (see RecordFrame)
+        FXWorkerPool* workers;      // shared threads, writes DumpFBO captures off the render thread
+        FXAudioAnalyser* audio;     // shared analysis of fx->audioData, use AudioAnalysis() (see fxaudio.h)
+        FXAudioHistory audioHistory;    // spectrum/waveform history textures, off until Init(rows) (see fxaudiohistory.h)
+        int audioHistoryParam;          // first of the shader params added by CreateAudioHistoryParams
+        FXTexCoords texCoords;          // tx2/ty2, wrap and aspect as a uv remap in the shader, no squaring copy (see fxtexcoords.h)
+        int texCoordsParam;             // the fxUV param added by CreateTexCoordParams
+        FXLayerMixer mixer;             // FXPT_MIXER, source[1..10] blended in one pass (see fxmixer.h)
+        int mixerParam;                 // first of the shader params added by CreateMixerParams
+        FXFrameHistory history;         // last n frames for echo/feedback, off until Init (see fxframehistory.h)
+        int historyParam;               // first of the shader params added by CreateFrameHistoryParams
+        FXDynamicResolution dynres;     // GPU time per Process against a budget, off until Init (see fxdynres.h)
+        int upscaleShader;              // program added by CreateUpscaleShader, -1 if none
+        FXBlur blur;                    // gaussian/box/kawase passes in the graph, none until Add (see fxblur.h)
+        int blurSource;                 // graph Source() kept on source[0] by ApplyBlur, -1 if not used
+        FXNoise* noise;                 // shared noise tiles, made on the workers and kept on disk (see fxnoise.h)
+        int noiseHandle;                // the tile Requested in InitPlugin, -1 if none
+        int noiseParam;                 // first of the shader params added by CreateNoiseParams
+
+        // the more modern shader setup (Process330Example) draws with quad->DrawGenerated,
+        // so there are no per plugin vertex buffers to keep here
+
+        FXTime clock;               // int64 ns host time, speed/reverse media clock and frame jitter (see fxtime.h)
+        double framesTraveled;      // this frame at clock's frame rate, fraction kept
+        int64_t gentimer;
 
 		bool firstRun;
 		float displayWRatio,displayHRatio;
 
 
         string sourceLabels[11];
-        //string beatLabels[9];
-        //int beatmode;
-        //int hdsqDelays[9];
-        int prevbpm;
-        int prevHit, curHit;
-        bool newHit;
+        //int beatmode;             // FXBEATDIVISION the effect is synced to
+        FXBeatClock beats;          // beat hits/phase for every division, ticked once per frame in Update (see fxbeatclock.h)
 
         float r;
+        void RedChanged();
+
+        // the interface params, see fxparams.h (add new ones to the END, the state is packed in this order)
+        static constexpr FXPARAMDESC<PluginPrivateObject> paramDescs[] = {
+            FXRandom(FXRange("Red", 0, 100, 0, &PluginPrivateObject::r, 0.01f, &PluginPrivateObject::RedChanged)),
+            // FXMultiState("Direction", 3, 0, &PluginPrivateObject::dir, &PluginPrivateObject::DirChanged),
+            // FXColour("Tint", 0xFFFFFFFF, &PluginPrivateObject::tint),
+            // FXBender("FOV", &PluginPrivateObject::FOV, 45.0f, 3.0f, 5.0f, 175.0f),
+        };
+        typedef FXParamTable<PluginPrivateObject, FXPARAMCOUNT(paramDescs), paramDescs> ParamTable;
+        typedef ParamTable::State PackedState;
+        ParamTable params;
+
+        FXStateStore<PluginPrivateObject> snapshots;    // GetState/SetState buffers, reused
+        static const FXStateStore<PluginPrivateObject>::Migration stateMigrations[];
+        bool MigrateState1(const FXSTATE& in, FXStateWriter& out);
+        bool MigrateState2(const FXSTATE& in, FXStateWriter& out);
 
 		void Process120Example();
+		void ProcessUpscale(FXRenderGraph& g);
 		// requires glm headers (not supplied https://github.com/g-truc/glm)
 		//void Process330Example();
 
 		// helper functions
 		void nonUpdateOnParams();
 		void ProgressTime();
-        double GetRealTimestamp();
+        int64_t GetRealTimestamp();
         string IntToString(int value);
         string DoubleToString(double value);
         void Debug(const char* format, ... );
-        void DumpFBO(string filename,unsigned int w,unsigned int h,GLuint FBOID);
-        bool SaveRawImage(string filename,unsigned char *buffer, int width, int height,int bytes);
+        const FXAUDIOANALYSIS& AudioAnalysis();
+        void CreateAudioHistoryParams(int shaderID);
+        void ApplyAudioHistory();
+        void CreateTexCoordParams(int shaderID);
+        void ApplyTexCoords();
+        void CreateMixerParams(int shaderID);
+        void ApplyMixer();
+        void CreateFrameHistoryParams(int shaderID);
+        void ApplyFrameHistory();
+        void CreateUpscaleShader();
+        void ApplyDynamicResolution();
+        void CreateBlurShaders();
+        void ApplyBlur();
+        void CreateNoiseParams(int shaderID);
+        void ApplyNoise();
+        void DumpFBO(string filename,unsigned int w,unsigned int h,GLuint FBOID,FXIMAGEFORMAT format = FXIMAGE_RAW);
+        void ServiceReadback(bool wait);
+        void RecordFrame();
+        bool SaveRawImage(string filename,unsigned char *buffer, int width, int height,int bytes,FXIMAGEFORMAT format = FXIMAGE_RAW);
         void DrawQuad(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z);
         void DrawQuad(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2);
         void DrawQuad2(float x1, float y1, float tx1, float ty1,float ttx1,float tty1, float x2, float y2, float tx2,float ty2,float ttx2,float tty2);
+        // immediate mode fallbacks (pre GL 2.0 or -DFX_IMMEDIATE_QUADS)
+        void DrawQuadImmediate(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2, float z);
+        void DrawQuadImmediate(float x1, float y1, float tx1, float ty1, float x2, float y2, float tx2, float ty2);
+        void DrawQuad2Immediate(float x1, float y1, float tx1, float ty1,float ttx1,float tty1, float x2, float y2, float tx2,float ty2,float ttx2,float tty2);
         void ClearFBO(GLuint FBOID, int width, int height);
         void RGBA2Param(float r,float g, float b, float a, int p);
         void Param2RGBA(int p, float &r, float &g, float &b, float &a);
         unsigned long RGBA2Int(float r,float g, float b, float a);
         float BenderCalc(int deltaValue);
-
-        //void _migrateState1(FXSTATE* fxstate, PluginPrivateState* localState);
-        //void _useState2(FXSTATE* fxstate, PluginPrivateState* localState);
 };
 
 #endif // PLUGINPRIVATEOBJECT_H